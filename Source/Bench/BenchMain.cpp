@@ -0,0 +1,659 @@
+#include "../Core/EllerMazeGenerator.h"
+#include "../Core/Maze3DSerializer.h"
+#include "../Core/Maze3DSolver.h"
+#include "../Core/MazeCodec.h"
+#include "../Core/MazeRasterizer.h"
+#include "../Core/MazeSerializer.h"
+#include "../Core/MazeSolver.h"
+#include "../Core/MazeVisibility.h"
+#include "../Core/RandomMaze3DGenerator.h"
+#include "../Core/RandomMazeGenerator.h"
+#ifdef MAZE_BENCH_GL
+#include "../Render/Cube3D.h"
+#include "../Render/HeadlessContext.h"
+#include "../Render/MazeRenderer.h"
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef MAZE_REVISION
+#define MAZE_REVISION "unknown"
+#endif
+
+static void PrintUsage()
+{
+	printf(
+		"Usage: MazeBench [options]\n"
+		"  --sizes WxH,...    maze sizes (default 20x15,64x64,256x256,1024x1024,4096x4096,16384x16384)\n"
+		"  --sizes3d WxHxD,...  3D maze sizes (default 64x64x64,256x256x256,512x512x512)\n"
+		"  --max-cells N      skip sizes larger than N cells\n"
+		"  --min-time S       run each case at least S seconds (default 0.5)\n"
+		"  --out FILE         write the JSON report to FILE instead of stdout\n"
+		"  --no-render        skip the GL cases\n");
+}
+
+struct BenchSize
+{
+	int width;
+	int height;
+	int depth = 1;
+};
+
+struct BenchResult
+{
+	std::string name;
+	BenchSize size;
+	int iterations;
+	double seconds;          // Total over every iteration
+	const char* metric;      // Name of the headline number, e.g. "cells_per_second"
+	double value;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+// Visible sets take a few microseconds a cell; past this size building them takes minutes. The
+// range is MazeFirstPersonRenderer::VISIBILITY_RANGE, whose header needs GL.
+#define VISIBILITY_MAX_CELLS (1024 * 1024)
+#define VISIBLE_SET_RANGE 64
+
+// Generator steps drawn per frame by the render_update cases, around a millisecond of generation
+#define ANIMATION_STEPS_PER_FRAME 4096
+
+// Cell and wall size of the rasterize cases, and the rows drawn at a time, as MazeExport streams them
+#define RASTER_CELL_SIZE 4
+#define RASTER_WALL_WIDTH 1
+#define RASTER_BAND_HEIGHT 256
+
+static double Since(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static std::vector<BenchResult> s_results;
+
+static void Report(const char* name, BenchSize size, int iterations, double seconds, const char* metric, double value)
+{
+	s_results.push_back(BenchResult{ name, size, iterations, seconds, metric, value });
+	char text[48];
+	if (size.depth > 1)
+		snprintf(text, sizeof(text), "%dx%dx%d", size.width, size.height, size.depth);
+	else
+		snprintf(text, sizeof(text), "%dx%d", size.width, size.height);
+	fprintf(stderr, "%-25s %13s %8d iter %10.4f s  %s %.4g\n", name, text, iterations, seconds, metric, value);
+}
+
+// Leaves the last maze generated in place for the cases that need a finished one
+static void BenchGenerate(Maze& maze, double minTime)
+{
+	BenchSize size = { maze.GetWidth(), maze.GetHeight() };
+	int iterations = 0;
+	Clock::time_point start = Clock::now();
+	do
+	{
+		maze.Reset();
+		RandomMazeGenerator generator(maze, 1000 + iterations);
+		generator.Generate();
+		iterations++;
+	} while (Since(start) < minTime);
+	double seconds = Since(start);
+	Report("generate", size, iterations, seconds, "cells_per_second", (double)maze.GetCellCount() * iterations / seconds);
+}
+
+// Eller's algorithm a row at a time, as MazeExport --eller streams it, with no maze to write into
+static void BenchGenerateEller(BenchSize size, double minTime)
+{
+	std::vector<byte> row(size.width);
+	int iterations = 0;
+	Clock::time_point start = Clock::now();
+	do
+	{
+		EllerMazeGenerator generator(size.width, size.height, 1000 + iterations);
+		while (generator.NextRow(row.data()))
+		{
+		}
+		iterations++;
+	} while (Since(start) < minTime);
+	double seconds = Since(start);
+	Report("generate_eller", size, iterations, seconds, "cells_per_second", (double)size.width * size.height * iterations / seconds);
+}
+
+static void BenchSolve(const Maze& maze, double minTime)
+{
+	BenchSize size = { maze.GetWidth(), maze.GetHeight() };
+
+	// Corner to corner, so the search covers most of the maze whatever the seed
+	int64_t start = 0;
+	int64_t goal = maze.GetCellCount() - 1;
+
+	MazeSolver solver;
+	int iterations = 0;
+	double visited = 0.0;
+	Clock::time_point begin = Clock::now();
+	do
+	{
+		solver.Solve(maze, start, goal);
+		visited += solver.GetVisitedCount();
+		iterations++;
+	} while (Since(begin) < minTime);
+	double seconds = Since(begin);
+	Report("solve", size, iterations, seconds, "cells_per_second", visited / seconds);
+}
+
+static void BenchSerialize(const Maze& maze, double minTime)
+{
+	BenchSize size = { maze.GetWidth(), maze.GetHeight() };
+	std::vector<byte> buffer;
+	int iterations = 0;
+	Clock::time_point start = Clock::now();
+	do
+	{
+		buffer.clear();
+		MazeSerializer::Write(maze, buffer);
+		iterations++;
+	} while (Since(start) < minTime);
+	double seconds = Since(start);
+	Report("serialize_write", size, iterations, seconds, "bytes_per_second", (double)buffer.size() * iterations / seconds);
+
+	Maze copy(size.width, size.height);
+	iterations = 0;
+	start = Clock::now();
+	do
+	{
+		MazeSerializer::Read(buffer.data(), buffer.size(), copy);
+		iterations++;
+	} while (Since(start) < minTime);
+	seconds = Since(start);
+	Report("serialize_read", size, iterations, seconds, "bytes_per_second", (double)buffer.size() * iterations / seconds);
+}
+
+// The entropy-coded form, decoding both a block at a time on one thread and row by row
+static void BenchCodec(const Maze& maze, double minTime)
+{
+	BenchSize size = { maze.GetWidth(), maze.GetHeight() };
+	std::vector<byte> buffer;
+	int iterations = 0;
+	Clock::time_point start = Clock::now();
+	do
+	{
+		buffer.clear();
+		MazeCodec::Encode(maze, buffer);
+		iterations++;
+	} while (Since(start) < minTime);
+	double seconds = Since(start);
+	Report("codec_encode", size, iterations, seconds, "cells_per_second", (double)maze.GetCellCount() * iterations / seconds);
+	Report("codec_size", size, 1, 0.0, "bits_per_cell", buffer.size() * 8.0 / maze.GetCellCount());
+
+	Maze copy(size.width, size.height);
+	iterations = 0;
+	start = Clock::now();
+	do
+	{
+		MazeCodec::Decode(buffer.data(), buffer.size(), copy);
+		iterations++;
+	} while (Since(start) < minTime);
+	seconds = Since(start);
+	Report("codec_decode", size, iterations, seconds, "cells_per_second", (double)maze.GetCellCount() * iterations / seconds);
+
+	std::vector<byte> row(size.width);
+	iterations = 0;
+	start = Clock::now();
+	do
+	{
+		MazeCodecReader reader;
+		reader.Open(buffer.data(), buffer.size());
+		while (reader.NextRow(row.data()))
+		{
+		}
+		iterations++;
+	} while (Since(start) < minTime);
+	seconds = Since(start);
+	Report("codec_read_rows", size, iterations, seconds, "cells_per_second", (double)maze.GetCellCount() * iterations / seconds);
+}
+
+// Drawing the whole maze as an image on the CPU, one band of rows at a time
+static void BenchRasterize(const Maze& maze, double minTime)
+{
+	BenchSize size = { maze.GetWidth(), maze.GetHeight() };
+	const char* names[2] = { "rasterize_gray", "rasterize_rgba" };
+	const int channels[2] = { 1, 4 };
+	for (int i = 0; i < 2; i++)
+	{
+		MazeRasterizer rasterizer(maze, RASTER_CELL_SIZE, RASTER_WALL_WIDTH, channels[i]);
+		int imageWidth = rasterizer.GetImageWidth();
+		int imageHeight = rasterizer.GetImageHeight();
+		size_t stride = (size_t)imageWidth * channels[i];
+		std::vector<byte> band(stride * RASTER_BAND_HEIGHT);
+		int iterations = 0;
+		Clock::time_point start = Clock::now();
+		do
+		{
+			for (int row = 0; row < imageHeight; row += RASTER_BAND_HEIGHT)
+			{
+				rasterizer.DrawRows(row, std::min(RASTER_BAND_HEIGHT, imageHeight - row), band.data(), stride);
+			}
+			iterations++;
+		} while (Since(start) < minTime);
+		double seconds = Since(start);
+		Report(names[i], size, iterations, seconds, "pixels_per_second", (double)imageWidth * imageHeight * iterations / seconds);
+	}
+}
+
+// Every cell's visible set, as the first-person renderer builds it
+static void BenchVisibility(const Maze& maze, double minTime)
+{
+	BenchSize size = { maze.GetWidth(), maze.GetHeight() };
+	MazeVisibility visibility;
+	int iterations = 0;
+	Clock::time_point start = Clock::now();
+	do
+	{
+		visibility.Build(maze, VISIBLE_SET_RANGE);
+		iterations++;
+	} while (Since(start) < minTime);
+	double seconds = Since(start);
+	Report("visibility_build", size, iterations, seconds, "cells_per_second", (double)maze.GetCellCount() * iterations / seconds);
+	Report("visibility_size", size, 1, 0.0, "bytes_per_cell", (double)visibility.GetByteCount() / maze.GetCellCount());
+}
+
+static void BenchGenerate3D(Maze3D& maze, double minTime)
+{
+	BenchSize size = { maze.GetWidth(), maze.GetHeight(), maze.GetDepth() };
+	int iterations = 0;
+	Clock::time_point start = Clock::now();
+	do
+	{
+		maze.Reset();
+		RandomMaze3DGenerator generator(maze, 1000 + iterations);
+		generator.Generate();
+		iterations++;
+	} while (Since(start) < minTime);
+	double seconds = Since(start);
+	Report("generate3d", size, iterations, seconds, "cells_per_second", (double)maze.GetCellCount() * iterations / seconds);
+}
+
+static void BenchSolve3D(const Maze3D& maze, double minTime)
+{
+	BenchSize size = { maze.GetWidth(), maze.GetHeight(), maze.GetDepth() };
+	int64_t start = maze.GetIndex(0, 0, 0);
+	int64_t goal = maze.GetIndex(size.width - 1, size.height - 1, size.depth - 1);
+
+	Maze3DSolver solver;
+	int iterations = 0;
+	double visited = 0.0;
+	Clock::time_point begin = Clock::now();
+	do
+	{
+		solver.Solve(maze, start, goal);
+		visited += solver.GetVisitedCount();
+		iterations++;
+	} while (Since(begin) < minTime);
+	double seconds = Since(begin);
+	Report("solve3d", size, iterations, seconds, "cells_per_second", visited / seconds);
+}
+
+static void BenchSerialize3D(const Maze3D& maze, double minTime)
+{
+	BenchSize size = { maze.GetWidth(), maze.GetHeight(), maze.GetDepth() };
+	std::vector<byte> buffer;
+	int iterations = 0;
+	Clock::time_point start = Clock::now();
+	do
+	{
+		buffer.clear();
+		Maze3DSerializer::Write(maze, buffer);
+		iterations++;
+	} while (Since(start) < minTime);
+	double seconds = Since(start);
+	Report("serialize3d_write", size, iterations, seconds, "bytes_per_second", (double)buffer.size() * iterations / seconds);
+
+	Maze3D copy(size.width, size.height, size.depth);
+	iterations = 0;
+	start = Clock::now();
+	do
+	{
+		Maze3DSerializer::Read(buffer.data(), buffer.size(), copy);
+		iterations++;
+	} while (Since(start) < minTime);
+	seconds = Since(start);
+	Report("serialize3d_read", size, iterations, seconds, "bytes_per_second", (double)buffer.size() * iterations / seconds);
+}
+
+#ifdef MAZE_BENCH_GL
+// CPU time spent issuing one frame's GL calls. glFinish runs outside the timed part, so
+// the driver's rendering doesn't count but its queue never backs up either. With frameName set,
+// the whole frame including glFinish is reported under that name as well.
+template <typename F>
+static void BenchFrames(const char* name, BenchSize size, double minTime, F frame, const char* frameName = nullptr)
+{
+	// The driver compiles shaders and allocates on the first draw
+	frame();
+	glFinish();
+
+	int iterations = 0;
+	double submit = 0.0;
+	Clock::time_point start = Clock::now();
+	do
+	{
+		Clock::time_point frameStart = Clock::now();
+		frame();
+		submit += Since(frameStart);
+		glFinish();
+		iterations++;
+	} while (Since(start) < minTime);
+	double seconds = Since(start);
+	Report(name, size, iterations, submit, "submit_ms_per_frame", submit * 1000.0 / iterations);
+	if (frameName != nullptr)
+		Report(frameName, size, iterations, seconds, "ms_per_frame", seconds * 1000.0 / iterations);
+}
+
+static void BenchRender(const std::vector<BenchSize>& sizes, double minTime)
+{
+	HeadlessContext context;
+	if (!context.Create())
+	{
+		fprintf(stderr, "No GL context, skipping the render cases\n");
+		return;
+	}
+	fprintf(stderr, "GL %s, %s\n", (const char*)glGetString(GL_VERSION), (const char*)glGetString(GL_RENDERER));
+
+	GLuint framebuffer, renderbuffers[2];
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glGenRenderbuffers(2, renderbuffers);
+	glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, 800, 600);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+	glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 800, 600);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+	glViewport(0, 0, 800, 600);
+	glEnable(GL_DEPTH_TEST);
+
+	GLint maxTextureSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+	for (BenchSize size : sizes)
+	{
+		// Past these sizes a frame takes seconds and says nothing new
+		bool texture = size.width <= maxTextureSize and size.height <= maxTextureSize and (int64_t)size.width * size.height <= 4096 * 4096;
+		bool geometry = (int64_t)size.width * size.height <= 256 * 256;
+		bool visibility = (int64_t)size.width * size.height <= VISIBILITY_MAX_CELLS;
+		bool overview = size.width <= maxTextureSize and size.height <= maxTextureSize;
+		if (!texture and !geometry and !overview)
+			continue;
+
+		Maze maze(size.width, size.height);
+		RandomMazeGenerator generator(maze, 1000);
+		generator.Generate();
+
+		if (texture)
+		{
+			MazeTextureRenderer::Init(size.width, size.height);
+			BenchFrames("render_upload", size, minTime, [&]() { MazeTextureRenderer::Upload(maze); });
+
+			// The cells one frame of a fast generation animation touches, a cell at a time and batched
+			Maze animated(size.width, size.height);
+			std::vector<int64_t> changedCells;
+			RandomMazeGenerator animation(animated, 1000, &changedCells);
+			for (int i = 0; i < ANIMATION_STEPS_PER_FRAME; i++)
+			{
+				animation.Step();
+			}
+			BenchFrames("render_update_cells", size, minTime, [&]()
+			{
+				for (int64_t index : changedCells)
+				{
+					MazeTextureRenderer::UpdateCell(animated, index);
+				}
+			});
+			BenchFrames("render_update_batch", size, minTime, [&]() { MazeTextureRenderer::UpdateCells(animated, changedCells); });
+			BenchFrames("render_texture", size, minTime, [&]()
+			{
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				MazeTextureRenderer::Render();
+			});
+			MazeTextureRenderer::Cleanup();
+		}
+		if (overview)
+		{
+			// Close in, about a cell a pixel, and the whole maze; a frame should cost the same at each
+			MazeOverviewRenderer::Init(size.width, size.height);
+			BenchFrames("render_overview_upload", size, minTime, [&]()
+			{
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				MazeOverviewRenderer::Upload(maze);
+				MazeOverviewRenderer::Render(size.width / 2.0f, size.height / 2.0f, 1.0f, 0, 0);
+			}, "overview_upload_frame");
+			const char* names[3][2] = {
+				{ "render_overview_in", "overview_in_frame" },
+				{ "render_overview_1x", "overview_1x_frame" },
+				{ "render_overview_out", "overview_out_frame" }
+			};
+			const float scales[3] = { 1.0f / 16.0f, 1.0f, std::max(size.width / 800.0f, size.height / 600.0f) };
+			for (int i = 0; i < 3; i++)
+			{
+				BenchFrames(names[i][0], size, minTime, [&]()
+				{
+					glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+					MazeOverviewRenderer::Render(size.width / 2.0f, size.height / 2.0f, scales[i], size.width / 2, size.height / 2);
+				}, names[i][1]);
+			}
+			MazeOverviewRenderer::Cleanup();
+		}
+		if (geometry)
+		{
+			Shader::Init(size.width, size.height);
+			BenchFrames("render_geometry", size, minTime, [&]()
+			{
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				Shader::Use();
+				MazeGeometryRenderer::Render(maze);
+			});
+			Shader::Cleanup();
+		}
+		if (texture)
+		{
+			// Standing in the middle of the maze and turning on the spot, so every direction is seen
+			Cube3D::Init();
+			MazeFirstPersonRenderer::Init(size.width, size.height);
+			// A new round: every chunk marked, then the first frame builds the ones in view
+			BenchFrames("render_fp_upload", size, minTime, [&]()
+			{
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				MazeFirstPersonRenderer::Upload(maze);
+				MazeFirstPersonRenderer::Render(maze, size.width / 2 + 0.5f, size.height / 2 + 0.5f, 0.0f, 800.0f / 600.0f);
+			});
+			glEnable(GL_CULL_FACE);
+			int frame = 0;
+			BenchFrames("render_first_person", size, minTime, [&]()
+			{
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				MazeFirstPersonRenderer::Render(maze, size.width / 2 + 0.5f, size.height / 2 + 0.5f, frame++ * 0.05f, 800.0f / 600.0f);
+			}, "render_first_person_frame");
+			if (visibility)
+			{
+				MazeVisibility visibleSets;
+				visibleSets.Build(maze, MazeFirstPersonRenderer::VISIBILITY_RANGE);
+				MazeFirstPersonRenderer::SetVisibility(&visibleSets);
+				BenchFrames("render_fp_pvs", size, minTime, [&]()
+				{
+					glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+					MazeFirstPersonRenderer::Render(maze, size.width / 2 + 0.5f, size.height / 2 + 0.5f, frame++ * 0.05f, 800.0f / 600.0f);
+				}, "render_fp_pvs_frame");
+				MazeFirstPersonRenderer::SetVisibility(nullptr);
+			}
+			glDisable(GL_CULL_FACE);
+			MazeFirstPersonRenderer::Cleanup();
+			Cube3D::Cleanup();
+		}
+	}
+
+	glDeleteRenderbuffers(2, renderbuffers);
+	glDeleteFramebuffers(1, &framebuffer);
+}
+#endif
+
+static bool ParseSizes(const char* text, std::vector<BenchSize>& sizes)
+{
+	sizes.clear();
+	while (*text != '\0')
+	{
+		BenchSize size;
+		int length = 0;
+		if (sscanf(text, "%dx%d%n", &size.width, &size.height, &length) != 2 or size.width < 1 or size.height < 1)
+			return false;
+		sizes.push_back(size);
+		text += length;
+		if (*text == ',')
+			text++;
+	}
+	return !sizes.empty();
+}
+
+static bool ParseSizes3D(const char* text, std::vector<BenchSize>& sizes)
+{
+	sizes.clear();
+	while (*text != '\0')
+	{
+		BenchSize size;
+		int length = 0;
+		if (sscanf(text, "%dx%dx%d%n", &size.width, &size.height, &size.depth, &length) != 3 or size.width < 1 or size.height < 1 or size.depth < 1)
+			return false;
+		sizes.push_back(size);
+		text += length;
+		if (*text == ',')
+			text++;
+	}
+	return !sizes.empty();
+}
+
+static void WriteJson(FILE* file)
+{
+	char date[32];
+	time_t now = time(nullptr);
+	strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+	fprintf(file, "{\n");
+	fprintf(file, "  \"revision\": \"%s\",\n", MAZE_REVISION);
+	fprintf(file, "  \"date\": \"%s\",\n", date);
+	fprintf(file, "  \"hardware_threads\": %u,\n", std::thread::hardware_concurrency());
+	fprintf(file, "  \"results\": [\n");
+	for (size_t i = 0; i < s_results.size(); i++)
+	{
+		const BenchResult& result = s_results[i];
+		fprintf(file, "    { \"name\": \"%s\", \"width\": %d, \"height\": %d, \"depth\": %d, \"cells\": %lld, \"iterations\": %d, \"seconds\": %.6f, \"%s\": %.6g }%s\n",
+			result.name.c_str(), result.size.width, result.size.height, result.size.depth, (long long)result.size.width * result.size.height * result.size.depth,
+			result.iterations, result.seconds, result.metric, result.value, i + 1 < s_results.size() ? "," : "");
+	}
+	fprintf(file, "  ]\n");
+	fprintf(file, "}\n");
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<BenchSize> sizes;
+	ParseSizes("20x15,64x64,256x256,1024x1024,4096x4096,16384x16384", sizes);
+	std::vector<BenchSize> sizes3D;
+	ParseSizes3D("64x64x64,256x256x256,512x512x512", sizes3D);
+	long long maxCells = 0;
+	double minTime = 0.5;
+	const char* outPath = nullptr;
+	bool render = true;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		if (strcmp(arg, "--no-render") == 0)
+		{
+			render = false;
+			continue;
+		}
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (value == nullptr or strcmp(arg, "--help") == 0)
+		{
+			PrintUsage();
+			return value == nullptr and strcmp(arg, "--help") != 0 ? 1 : 0;
+		}
+		i++;
+		if (strcmp(arg, "--sizes") == 0)
+		{
+			if (!ParseSizes(value, sizes))
+			{
+				fprintf(stderr, "Bad sizes '%s'\n", value);
+				return 1;
+			}
+		}
+		else if (strcmp(arg, "--sizes3d") == 0)
+		{
+			if (!ParseSizes3D(value, sizes3D))
+			{
+				fprintf(stderr, "Bad sizes '%s'\n", value);
+				return 1;
+			}
+		}
+		else if (strcmp(arg, "--max-cells") == 0)
+			maxCells = atoll(value);
+		else if (strcmp(arg, "--min-time") == 0)
+			minTime = atof(value);
+		else if (strcmp(arg, "--out") == 0)
+			outPath = value;
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	std::vector<BenchSize> selected;
+	for (BenchSize size : sizes)
+	{
+		if (maxCells <= 0 or (long long)size.width * size.height <= maxCells)
+			selected.push_back(size);
+	}
+
+	for (BenchSize size : selected)
+	{
+		Maze maze(size.width, size.height);
+		BenchGenerate(maze, minTime);
+		BenchGenerateEller(size, minTime);
+		BenchSolve(maze, minTime);
+		BenchSerialize(maze, minTime);
+		BenchCodec(maze, minTime);
+		BenchRasterize(maze, minTime);
+		if ((int64_t)size.width * size.height <= VISIBILITY_MAX_CELLS)
+			BenchVisibility(maze, minTime);
+	}
+	for (BenchSize size : sizes3D)
+	{
+		if (maxCells > 0 and (long long)size.width * size.height * size.depth > maxCells)
+			continue;
+		Maze3D maze(size.width, size.height, size.depth);
+		BenchGenerate3D(maze, minTime);
+		BenchSolve3D(maze, minTime);
+		BenchSerialize3D(maze, minTime);
+	}
+#ifdef MAZE_BENCH_GL
+	if (render)
+		BenchRender(selected, minTime);
+#else
+	(void)render;
+#endif
+
+	FILE* file = outPath != nullptr ? fopen(outPath, "w") : stdout;
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Cannot write %s\n", outPath);
+		return 1;
+	}
+	WriteJson(file);
+	if (file != stdout)
+		fclose(file);
+	return 0;
+}
@@ -0,0 +1,68 @@
+#include "Arena.h"
+
+Arena::Arena()
+	:m_blocks(), m_block(0), m_offset(0), m_used(0), m_peak(0), m_blockAllocations(0)
+{
+}
+
+void Arena::AddBlock(size_t minSize)
+{
+	size_t size = m_blocks.empty() ? MIN_BLOCK_SIZE : m_blocks.back().size * 2;
+	if (size < minSize)
+		size = minSize;
+	m_blocks.push_back(Block{ std::unique_ptr<unsigned char[]>(new unsigned char[size]), size });
+	m_blockAllocations++;
+}
+
+void* Arena::Allocate(size_t size, size_t alignment)
+{
+	while (true)
+	{
+		if (m_block < m_blocks.size())
+		{
+			Block& block = m_blocks[m_block];
+			uintptr_t base = (uintptr_t)block.data.get();
+			size_t aligned = (size_t)(((base + m_offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base);
+			if (aligned + size <= block.size)
+			{
+				m_used += aligned + size - m_offset;
+				m_offset = aligned + size;
+				if (m_used > m_peak)
+					m_peak = m_used;
+				return block.data.get() + aligned;
+			}
+			if (m_block + 1 < m_blocks.size())
+			{
+				m_block++;
+				m_offset = 0;
+				continue;
+			}
+		}
+		AddBlock(size + alignment);
+		m_block = m_blocks.size() - 1;
+		m_offset = 0;
+	}
+}
+
+void Arena::Reset()
+{
+	if (m_blocks.size() > 1)
+	{
+		// Room for the alignment padding to land differently in the merged block
+		m_blocks.clear();
+		AddBlock(m_peak + MIN_BLOCK_SIZE);
+	}
+	m_block = 0;
+	m_offset = 0;
+	m_used = 0;
+}
+
+size_t Arena::GetCapacity() const
+{
+	size_t capacity = 0;
+	for (const Block& block : m_blocks)
+	{
+		capacity += block.size;
+	}
+	return capacity;
+}
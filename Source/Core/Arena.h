@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator for memory that lives exactly as long as one maze: the grid, the generator's
+// stack and the like. Reset() hands everything back at once without freeing it, so rounds of the
+// same size allocate nothing after the first one.
+//
+// Blocks are left uninitialized, so the OS only commits the pages that are actually touched.
+// Nothing allocated here has its destructor run.
+class Arena
+{
+private:
+	static const size_t MIN_BLOCK_SIZE = 64 * 1024;
+
+	struct Block
+	{
+		std::unique_ptr<unsigned char[]> data;
+		size_t size;
+	};
+
+	std::vector<Block> m_blocks;
+	size_t m_block;        // Block being bumped
+	size_t m_offset;       // Bytes used in m_blocks[m_block]
+	size_t m_used;         // Bytes handed out since the last Reset(), padding included
+	size_t m_peak;         // Largest m_used seen, so Reset() can size one block for a whole round
+	uint64_t m_blockAllocations;
+
+	void AddBlock(size_t minSize);
+public:
+	Arena();
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	template <typename T>
+	T* Allocate(size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "Arena never runs destructors");
+		return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+	}
+
+	// Invalidates everything allocated so far. If the last round spilled into several blocks they
+	// are merged into one big enough for it, so the next round of the same size needs no new block.
+	void Reset();
+
+	size_t GetCapacity() const;
+
+	size_t GetUsed() const
+	{
+		return m_used;
+	}
+
+	// Blocks taken from the heap over the arena's lifetime; stops growing once it is warmed up
+	uint64_t GetBlockAllocations() const
+	{
+		return m_blockAllocations;
+	}
+};
@@ -0,0 +1,41 @@
+#include "BatchGenerator.h"
+#include "Arena.h"
+#include "RandomMazeGenerator.h"
+#include <vector>
+
+BatchGenerator::BatchGenerator(int width, int height, int threadCount)
+	:m_width(width), m_height(height), m_pDedup(nullptr), m_canonical(false), m_pool(threadCount)
+{
+}
+
+void BatchGenerator::Run(uint64_t firstSeed, uint64_t count, size_t batchSize, const Sink& sink)
+{
+	m_pool.ParallelFor((size_t)count, batchSize, [this, firstSeed, &sink](size_t begin, size_t end)
+		{
+			Arena arena;
+			MazeAnalyzer analyzer;
+			MazeHasher hasher;
+			std::vector<BatchItem> items(end - begin);
+			for (size_t i = begin; i < end; i++)
+			{
+				// The maze and the generator's stack are the only allocations, and they fit the
+				// arena's block after the first maze
+				arena.Reset();
+				Maze maze(m_width, m_height, arena);
+				BatchItem& item = items[i - begin];
+				item.seed = firstSeed + i;
+				RandomMazeGenerator generator(maze, item.seed, nullptr, &arena);
+				generator.Generate();
+				item.start = generator.GetFirstCell();
+				item.goal = generator.GetLastCell();
+				item.hash = m_canonical ? hasher.HashCanonical(maze) : MazeHasher::Hash(maze);
+				if (m_pDedup != nullptr and !m_pDedup->Insert(item.hash))
+				{
+					item.duplicate = true;
+					continue;
+				}
+				analyzer.Measure(maze, item.start, item.goal, item.metrics);
+			}
+			sink(items.data(), items.size());
+		});
+}
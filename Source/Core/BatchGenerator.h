@@ -0,0 +1,55 @@
+#pragma once
+#include "MazeAnalyzer.h"
+#include "MazeHash.h"
+#include "MazeHashSet.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <functional>
+
+// One maze of a batch: the game's start and goal for that seed, its hash and its metrics
+struct BatchItem
+{
+	uint64_t seed = 0;
+	int64_t start = -1;
+	int64_t goal = -1;
+	MazeHash128 hash;        // Canonical when the generator deduplicates by canonical hash
+	bool duplicate = false;  // Another maze of the run had the same hash; metrics are left at 0
+	MazeMetrics metrics;
+};
+
+// Generates and measures many mazes of one size on a thread pool. Maze i of a run uses seed
+// firstSeed + i, so any maze of a batch can be regenerated on its own. Each task keeps its own
+// arena, maze and analyzer, reused for every maze it makes.
+class BatchGenerator
+{
+private:
+	int m_width;
+	int m_height;
+	MazeHashSet* m_pDedup;
+	bool m_canonical;
+	ThreadPool m_pool;
+public:
+	typedef std::function<void(const BatchItem* pItems, size_t count)> Sink;
+
+	// threadCount <= 0 uses one thread per hardware core
+	BatchGenerator(int width, int height, int threadCount = 0);
+
+	// Before Run(): every maze's hash goes into pSet, and mazes whose hash is already there are
+	// flagged as duplicates and not measured. Which of two equal mazes counts as the duplicate
+	// depends on thread timing. With canonical, mazes that are rotations or mirror images of each
+	// other count as equal. The set may be shared with other runs and must outlive them.
+	void SetDedup(MazeHashSet* pSet, bool canonical)
+	{
+		m_pDedup = pSet;
+		m_canonical = canonical;
+	}
+
+	// Calls sink from the worker threads, once per task with its items in seed order; tasks may
+	// finish in any order. Returns when every maze is done.
+	void Run(uint64_t firstSeed, uint64_t count, size_t batchSize, const Sink& sink);
+
+	int GetThreadCount() const
+	{
+		return m_pool.GetThreadCount();
+	}
+};
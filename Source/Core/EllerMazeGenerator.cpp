@@ -0,0 +1,76 @@
+#include "EllerMazeGenerator.h"
+
+EllerMazeGenerator::EllerMazeGenerator(int width, int height, uint64_t seed)
+	:m_width(width), m_height(height), m_row(0), m_random(seed), m_bits(0), m_bitCount(0), m_left(width), m_right(width),
+	m_down(width, 0)
+{
+	// Every cell of the first row starts in a set of its own
+	for (int x = 0; x < width; x++)
+	{
+		m_left[x] = x;
+		m_right[x] = x;
+	}
+}
+
+bool EllerMazeGenerator::NextRow(byte* pCells)
+{
+	if (IsFinished())
+		return false;
+	bool last = m_row == m_height - 1;
+
+	// Cells entered from above are still in the sets of the row before; the others were taken out
+	// into sets of their own
+	for (int x = 0; x < m_width; x++)
+	{
+		pCells[x] = m_down[x] ? WALL_ALL & ~WALL_UP : WALL_ALL;
+	}
+
+	for (int x = 0; x + 1 < m_width; x++)
+	{
+		if (m_right[x] == x + 1 or (!last and !Flip()))
+			continue;
+		pCells[x] &= ~WALL_RIGHT;
+		pCells[x + 1] &= ~WALL_LEFT;
+		// Splice x + 1's list in after x
+		int next = m_right[x];
+		int end = m_left[x + 1];
+		m_right[end] = next;
+		m_left[next] = end;
+		m_right[x] = x + 1;
+		m_left[x + 1] = x;
+	}
+	m_row++;
+	if (last)
+		return true;
+
+	// Going left to right, a cell that stays closed below leaves its set. One that is alone in its
+	// set by then is the last that could open it downwards, so it has to.
+	for (int x = 0; x < m_width; x++)
+	{
+		bool down = m_left[x] == x or Flip();
+		m_down[x] = down;
+		if (down)
+		{
+			pCells[x] &= ~WALL_DOWN;
+			continue;
+		}
+		m_right[m_left[x]] = m_right[x];
+		m_left[m_right[x]] = m_left[x];
+		m_left[x] = x;
+		m_right[x] = x;
+	}
+	return true;
+}
+
+void EllerMazeGenerator::Generate(Maze& maze)
+{
+	std::vector<byte> row(m_width);
+	for (int y = m_height - 1; y >= 0; y--)
+	{
+		NextRow(row.data());
+		for (int x = 0; x < m_width; x++)
+		{
+			maze.SetCell(maze.GetIndex(x, y), row[x]);
+		}
+	}
+}
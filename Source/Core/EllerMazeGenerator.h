@@ -0,0 +1,67 @@
+#pragma once
+#include "Maze.h"
+#include "Random.h"
+#include <vector>
+
+// Eller's algorithm: a perfect maze one row at a time, keeping only which set each cell of the
+// current row belongs to, so memory is O(width) however tall the maze is. Each row joins
+// neighbours from different sets at random, then every set opens downwards at least once so no
+// part of the maze is cut off; the last row joins whatever sets are left.
+//
+// Sets are circular lists of the columns in them, in column order, linked both ways. Sets can't
+// interleave (their paths would cross), so x and x + 1 share a set exactly when x + 1 follows x in
+// its list, and joining or leaving a set is a splice: every step is O(1).
+//
+// Rows come out from the top (y = height - 1) down, so they can be drawn straight into an image
+// (MazeRasterizer::DrawCellRow) or written to a file without the maze ever being held whole.
+// Cells are left unvisited: no state bits are set.
+class EllerMazeGenerator
+{
+private:
+	int m_width;
+	int m_height;
+	int m_row;                 // Rows handed out so far
+	Random m_random;
+	uint64_t m_bits;           // Coin flips left over from the last number drawn
+	int m_bitCount;
+	std::vector<int> m_left;   // Previous and next column in the same set
+	std::vector<int> m_right;
+	std::vector<byte> m_down;  // Which cells of the last row open downwards
+
+	bool Flip()
+	{
+		if (m_bitCount == 0)
+		{
+			m_bits = m_random.Next64();
+			m_bitCount = 64;
+		}
+		m_bitCount--;
+		bool bit = (m_bits & 1) != 0;
+		m_bits >>= 1;
+		return bit;
+	}
+public:
+	EllerMazeGenerator(int width, int height, uint64_t seed);
+
+	int GetWidth() const
+	{
+		return m_width;
+	}
+
+	int GetHeight() const
+	{
+		return m_height;
+	}
+
+	bool IsFinished() const
+	{
+		return m_row == m_height;
+	}
+
+	// Writes the walls of the next row of cells, width bytes, to pCells. Returns false once every
+	// row has been handed out.
+	bool NextRow(byte* pCells);
+
+	// Fills a whole maze of the generator's size
+	void Generate(Maze& maze);
+};
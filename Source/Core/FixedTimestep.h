@@ -0,0 +1,42 @@
+#pragma once
+
+// Accumulator for running the simulation at a fixed rate regardless of how often frames are drawn.
+// Feed it the real time since the last frame and run the returned number of ticks; what is left
+// over (GetAlpha) is how far the renderer should interpolate between the last two ticks.
+class FixedTimestep
+{
+private:
+	double m_step;
+	double m_accumulator;
+	double m_maxFrameTime;
+public:
+	// maxFrameTime caps how much time a single frame may add, so a long stall (window drag,
+	// breakpoint) skips simulation time instead of running hundreds of catch-up ticks
+	FixedTimestep(double step, double maxFrameTime = 0.25)
+		:m_step(step), m_accumulator(0.0), m_maxFrameTime(maxFrameTime) {}
+
+	int Advance(double frameTime)
+	{
+		if (frameTime > m_maxFrameTime)
+			frameTime = m_maxFrameTime;
+		if (frameTime > 0.0)
+			m_accumulator += frameTime;
+		int ticks = 0;
+		while (m_accumulator >= m_step)
+		{
+			m_accumulator -= m_step;
+			ticks++;
+		}
+		return ticks;
+	}
+
+	double GetAlpha() const
+	{
+		return m_accumulator / m_step;
+	}
+
+	double GetStep() const
+	{
+		return m_step;
+	}
+};
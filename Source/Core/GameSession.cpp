@@ -0,0 +1,133 @@
+#include "GameSession.h"
+
+GameSession::GameSession(int width, int height, uint64_t seed, bool trackChanges)
+	:m_arena(), m_maze(width, height, m_arena), m_changedCells(), m_generator(m_maze, seed, trackChanges ? &m_changedCells : nullptr, &m_arena),
+	m_player(-1), m_goal(-1), m_generated(false), m_trackChanges(trackChanges), m_generationSteps(1), m_roundSeeds(seed), m_round(0), m_pPool(nullptr),
+	m_tickCount(0), m_stepCount(0), m_backtrackCount(0), m_maxDepth(0), m_winCount(0), m_generatedTick(0), m_lastWinTicks(0), m_wonRound(false)
+{
+}
+
+void GameSession::NewRound(uint64_t seed)
+{
+	int width = m_maze.GetWidth();
+	int height = m_maze.GetHeight();
+	m_arena.Reset();
+	m_maze = Maze(width, height, m_arena);
+	m_changedCells.clear();
+	m_generator = RandomMazeGenerator(m_maze, seed, m_trackChanges ? &m_changedCells : nullptr, &m_arena);
+	m_player = -1;
+	m_goal = -1;
+	m_generated = false;
+	m_wonRound = false;
+	m_round++;
+}
+
+void GameSession::NewRound(const PooledMaze& maze)
+{
+	m_arena.Reset();
+	m_maze = Maze(maze.width, maze.height, m_arena);
+	m_changedCells.clear();
+	for (int64_t i = 0; i < m_maze.GetCellCount(); i++)
+	{
+		m_maze.SetCell(i, maze.cells[(size_t)i]);
+	}
+	if (m_trackChanges)
+	{
+		for (int64_t i = 0; i < m_maze.GetCellCount(); i++)
+		{
+			m_changedCells.push_back(i);
+		}
+	}
+	// Kept so the generator always refers to the current maze; a finished one takes no arena space
+	m_generator = RandomMazeGenerator(m_maze);
+	m_player = maze.start;
+	m_goal = maze.goal;
+	m_generated = true;
+	m_generatedTick = m_tickCount;
+	m_wonRound = false;
+	m_round++;
+}
+
+void GameSession::Tick(byte moves)
+{
+	if (moves & INPUT_NEW_MAZE)
+	{
+		// The pool draws the same seeds; drawing here too keeps both in step
+		uint64_t seed = m_roundSeeds.Next64();
+		if (m_pPool != nullptr)
+			NewRound(*m_pPool->Take(m_round + 1));
+		else
+			NewRound(seed);
+	}
+	StepGeneration(m_generationSteps);
+	if (m_generated)
+	{
+		Move(moves);
+	}
+	m_tickCount++;
+	if (!m_wonRound and IsWon())
+	{
+		m_wonRound = true;
+		m_winCount++;
+		m_lastWinTicks = m_tickCount - m_generatedTick;
+	}
+}
+
+void GameSession::StepGeneration(int steps)
+{
+	int64_t visited = m_generator.GetVisitedCount();
+	int taken = 0;
+	for (int i = 0; i < steps and !m_generated; i++)
+	{
+		m_generated = m_generator.Step();
+		taken++;
+		m_maxDepth = std::max(m_maxDepth, m_generator.GetDepth());
+		if (m_player == -1)
+		{
+			m_player = m_generator.GetFirstCell();
+		}
+		if (m_generated)
+		{
+			m_goal = m_generator.GetLastCell();
+			m_maze.SetState(m_goal, CELL_GOAL);
+			m_changedCells.push_back(m_goal);
+			m_generatedTick = m_tickCount;
+		}
+	}
+	// Every step visits a new cell or backtracks once
+	m_stepCount += (uint64_t)taken;
+	m_backtrackCount += (uint64_t)(taken - (m_generator.GetVisitedCount() - visited));
+}
+
+void GameSession::Generate()
+{
+	while (!m_generated)
+	{
+		Tick(0U);
+	}
+	m_changedCells.clear();
+}
+
+void GameSession::Move(byte moves)
+{
+	byte walls = m_maze.GetWalls(m_player);
+	if ((moves & WALL_UP) and (walls & WALL_UP) == 0x00)
+	{
+		m_player += m_maze.GetWidth();
+		walls = m_maze.GetWalls(m_player);
+	}
+	if ((moves & WALL_DOWN) and (walls & WALL_DOWN) == 0x00)
+	{
+		m_player -= m_maze.GetWidth();
+		walls = m_maze.GetWalls(m_player);
+	}
+	if ((moves & WALL_LEFT) and (walls & WALL_LEFT) == 0x00)
+	{
+		m_player -= 1;
+		walls = m_maze.GetWalls(m_player);
+	}
+	if ((moves & WALL_RIGHT) and (walls & WALL_RIGHT) == 0x00)
+	{
+		m_player += 1;
+	}
+}
@@ -0,0 +1,171 @@
+#pragma once
+#include "Maze.h"
+#include "MazePool.h"
+#include "RandomMazeGenerator.h"
+
+// Input bit next to the WALL_* moves: throw the maze away and start a new round
+#define INPUT_NEW_MAZE 0x10
+
+// Windowless game logic: one maze, its generator, the player and the goal.
+// Input is given as WALL_* direction bits, one bit per key pressed this tick.
+//
+// A session plays any number of rounds. Everything a round needs lives in the session's arena,
+// which is reset rather than freed between rounds, so back-to-back rounds of the same size
+// allocate nothing once the first one has run.
+class GameSession
+{
+private:
+	Arena m_arena;
+	Maze m_maze;
+	std::vector<int64_t> m_changedCells;
+	RandomMazeGenerator m_generator;
+	int64_t m_player;
+	int64_t m_goal;
+	bool m_generated;
+	bool m_trackChanges;
+	int m_generationSteps;
+	Random m_roundSeeds;  // Seeds of the rounds after the first, so replays see the same mazes
+	int m_round;
+	MazePool* m_pPool;
+
+	// Running totals over every round, for telemetry
+	uint64_t m_tickCount;
+	uint64_t m_stepCount;
+	uint64_t m_backtrackCount;
+	int64_t m_maxDepth;
+	uint64_t m_winCount;
+	uint64_t m_generatedTick;  // Tick the current round's maze was finished on
+	uint64_t m_lastWinTicks;   // Ticks from the maze being finished to the goal, last round won
+	bool m_wonRound;
+public:
+	// With trackChanges, every cell touched by generation is listed in GetChangedCells() for the renderer
+	GameSession(int width, int height, uint64_t seed, bool trackChanges = false);
+
+	// GetGenerationSteps() generator steps while the maze is being carved, then player movement.
+	// INPUT_NEW_MAZE starts a new round first.
+	void Tick(byte moves);
+
+	// Up to steps more generator steps outside of Tick(), for callers that fill a time budget. The
+	// game then depends on how many ran, so replays only hold with the fixed count of Tick().
+	void StepGeneration(int steps);
+
+	// Generator steps per Tick(), 1 by default; a step carves one cell or backtracks once
+	void SetGenerationSteps(int steps)
+	{
+		m_generationSteps = steps;
+	}
+
+	int GetGenerationSteps() const
+	{
+		return m_generationSteps;
+	}
+
+	// Rounds after the first come ready-made from the pool, which must be seeded like the session,
+	// instead of being carved step by step. The pool must outlive the session.
+	void SetPool(MazePool* pPool)
+	{
+		m_pPool = pPool;
+	}
+
+	MazePool* GetPool() const
+	{
+		return m_pPool;
+	}
+
+	// Starts over on an empty maze of the same size, generated from seed
+	void NewRound(uint64_t seed);
+
+	// Starts over on a finished maze, which may be of another size; every cell counts as changed
+	void NewRound(const PooledMaze& maze);
+
+	// Runs the generator to completion without animating it. The change list is cleared since every cell changed.
+	void Generate();
+
+	void Move(byte moves);
+
+	const Maze& GetMaze() const
+	{
+		return m_maze;
+	}
+
+	// 0 for the first maze, counting up with every NewRound()
+	int GetRound() const
+	{
+		return m_round;
+	}
+
+	const Arena& GetArena() const
+	{
+		return m_arena;
+	}
+
+	bool IsGenerated() const
+	{
+		return m_generated;
+	}
+
+	bool IsWon() const
+	{
+		return m_generated and m_player == m_goal;
+	}
+
+	// Player cell index, or -1 before the first generator step
+	int64_t GetPlayer() const
+	{
+		return m_player;
+	}
+
+	// Goal cell index, or -1 until generation is finished
+	int64_t GetGoal() const
+	{
+		return m_goal;
+	}
+
+	uint64_t GetTickCount() const
+	{
+		return m_tickCount;
+	}
+
+	// Generator steps taken, carving or backtracking, in every round so far
+	uint64_t GetStepCount() const
+	{
+		return m_stepCount;
+	}
+
+	uint64_t GetBacktrackCount() const
+	{
+		return m_backtrackCount;
+	}
+
+	// Deepest the generator's stack has been in any round
+	int64_t GetMaxDepth() const
+	{
+		return m_maxDepth;
+	}
+
+	// Current depth of the generator's stack
+	int64_t GetDepth() const
+	{
+		return m_generator.GetDepth();
+	}
+
+	uint64_t GetWinCount() const
+	{
+		return m_winCount;
+	}
+
+	uint64_t GetLastWinTicks() const
+	{
+		return m_lastWinTicks;
+	}
+
+	const std::vector<int64_t>& GetChangedCells() const
+	{
+		return m_changedCells;
+	}
+
+	void ClearChangedCells()
+	{
+		m_changedCells.clear();
+	}
+};
@@ -0,0 +1,120 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile()
+	:m_data(nullptr), m_size(0), m_open(false), m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr)
+{
+}
+
+bool MappedFile::Open(const char* path)
+{
+	Close();
+	m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size))
+	{
+		Close();
+		return false;
+	}
+	m_size = (size_t)size.QuadPart;
+	m_open = true;
+	if (m_size == 0)
+		return true;
+
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping == nullptr)
+	{
+		Close();
+		return false;
+	}
+	m_data = (const unsigned char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (m_data == nullptr)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+		UnmapViewOfFile(m_data);
+	if (m_mapping != nullptr)
+		CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+	m_data = nullptr;
+	m_size = 0;
+	m_open = false;
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = nullptr;
+}
+#else
+MappedFile::MappedFile()
+	:m_data(nullptr), m_size(0), m_open(false)
+{
+}
+
+bool MappedFile::Open(const char* path)
+{
+	Close();
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+	{
+		close(fd);
+		return false;
+	}
+	m_size = (size_t)info.st_size;
+	if (m_size == 0)
+	{
+		close(fd);
+		m_open = true;
+		return true;
+	}
+
+	void* pMapping = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (pMapping == MAP_FAILED)
+	{
+		m_size = 0;
+		return false;
+	}
+	m_data = (const unsigned char*)pMapping;
+	m_open = true;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+		munmap((void*)m_data, m_size);
+	m_data = nullptr;
+	m_size = 0;
+	m_open = false;
+}
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
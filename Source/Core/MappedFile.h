@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+
+// Read-only memory map of a whole file, for data too big to read in and searched at random.
+// Pages are only loaded when touched, and the OS shares them between every process mapping the
+// same file.
+class MappedFile
+{
+private:
+	const unsigned char* m_data;
+	size_t m_size;
+	bool m_open;
+#ifdef _WIN32
+	void* m_file;
+	void* m_mapping;
+#endif
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// False if the file can't be opened; an empty file opens with no data
+	bool Open(const char* path);
+	void Close();
+
+	bool IsOpen() const
+	{
+		return m_open;
+	}
+
+	const unsigned char* GetData() const
+	{
+		return m_data;
+	}
+
+	size_t GetSize() const
+	{
+		return m_size;
+	}
+};
@@ -0,0 +1,122 @@
+#pragma once
+#include "Arena.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define WALL_UP    0x01
+#define WALL_DOWN  0x02
+#define WALL_LEFT  0x04
+#define WALL_RIGHT 0x08
+#define WALL_ALL   0x0f
+
+#define CELL_UNVISITED   0x00
+#define CELL_VISITED     0x10
+#define CELL_BACKTRACKED 0x20
+#define CELL_GOAL        0x30
+#define CELL_STATE_MASK  0x30
+
+typedef unsigned char byte;
+
+// Packed maze grid: one byte per cell, walls in the low nibble and the generation state in bits 4-5.
+// Cells are stored row-major with y pointing up, which is also the layout of the render texture.
+// Cell indices are 64-bit, so a maze can go past 2^31 cells; each side still fits an int.
+class Maze
+{
+private:
+	int m_width;
+	int m_height;
+	byte* m_cells;
+	std::vector<byte> m_storage; // Empty when the cells live in an Arena
+public:
+	Maze(int width, int height)
+		:m_width(width), m_height(height), m_cells(nullptr), m_storage((size_t)width * height, WALL_ALL)
+	{
+		m_cells = m_storage.data();
+	}
+
+	// Cells come from the arena and are only valid until it is reset
+	Maze(int width, int height, Arena& arena)
+		:m_width(width), m_height(height), m_cells(arena.Allocate<byte>((size_t)width * height)), m_storage()
+	{
+		Reset();
+	}
+
+	Maze(const Maze&) = delete;
+	Maze& operator=(const Maze&) = delete;
+	Maze(Maze&&) = default;
+	Maze& operator=(Maze&&) = default;
+
+	void Reset()
+	{
+		std::fill(m_cells, m_cells + GetCellCount(), (byte)WALL_ALL);
+	}
+
+	int GetWidth() const
+	{
+		return m_width;
+	}
+
+	int GetHeight() const
+	{
+		return m_height;
+	}
+
+	int64_t GetCellCount() const
+	{
+		return (int64_t)m_width * m_height;
+	}
+
+	int64_t GetIndex(int x, int y) const
+	{
+		return (int64_t)y * m_width + x;
+	}
+
+	void GetPosition(int64_t index, int& x, int& y) const
+	{
+		x = (int)(index % m_width);
+		y = (int)(index / m_width);
+	}
+
+	byte GetWalls(int64_t index) const
+	{
+		return m_cells[index] & WALL_ALL;
+	}
+
+	byte GetWalls(int x, int y) const
+	{
+		return GetWalls(GetIndex(x, y));
+	}
+
+	void RemoveWalls(int64_t index, byte walls)
+	{
+		m_cells[index] ^= walls;
+	}
+
+	byte GetState(int64_t index) const
+	{
+		return m_cells[index] & CELL_STATE_MASK;
+	}
+
+	void SetState(int64_t index, byte state)
+	{
+		m_cells[index] = (m_cells[index] & ~CELL_STATE_MASK) | state;
+	}
+
+	// Walls and state together, exactly as uploaded to the render texture
+	byte GetCell(int64_t index) const
+	{
+		return m_cells[index];
+	}
+
+	void SetCell(int64_t index, byte cell)
+	{
+		m_cells[index] = cell;
+	}
+
+	const byte* GetData() const
+	{
+		return m_cells;
+	}
+};
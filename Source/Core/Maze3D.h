@@ -0,0 +1,163 @@
+#pragma once
+#include "Maze.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// WALL_UP/DOWN/LEFT/RIGHT keep their meaning (y + 1, y - 1, x - 1, x + 1); the stairs join levels
+#define WALL_ABOVE 0x10  // z + 1
+#define WALL_BELOW 0x20  // z - 1
+#define WALL3D_ALL 0x3f
+
+#define CELL3D_VISITED 0x40
+
+// Packed W x H x D maze: one byte per cell, the six walls in bits 0-5 and the generator's visited
+// flag in bit 6.
+//
+// Cells are stored in 8x8x8 bricks of 512 bytes, x fastest inside a brick, then y, then z, and the
+// bricks themselves are ordered the same way. A row-major layout puts the cells above and below
+// a whole level apart (256 KB at 512x512), so a depth-first walk that keeps climbing stairs misses
+// the cache on nearly every step; inside a brick they are 64 bytes away, and the brick next door is
+// usually still cached from the way in. Sides are padded to a multiple of 8; padding cells keep
+// every wall and are never reached.
+//
+// Indices are storage indices, not row-major ones: go through GetIndex()/GetPosition() or step
+// with GetNeighbor().
+class Maze3D
+{
+private:
+	int m_width;
+	int m_height;
+	int m_depth;
+	int m_bricksX;
+	int m_bricksY;
+	int m_bricksZ;
+	std::vector<byte> m_cells;
+public:
+	static const int BRICK_SIDE = 8;
+	static const int BRICK_CELLS = 512;
+
+	Maze3D(int width, int height, int depth)
+		:m_width(width), m_height(height), m_depth(depth), m_bricksX((width + 7) / 8), m_bricksY((height + 7) / 8),
+		m_bricksZ((depth + 7) / 8), m_cells((size_t)m_bricksX * m_bricksY * m_bricksZ * BRICK_CELLS, WALL3D_ALL)
+	{
+	}
+
+	Maze3D(const Maze3D&) = delete;
+	Maze3D& operator=(const Maze3D&) = delete;
+	Maze3D(Maze3D&&) = default;
+	Maze3D& operator=(Maze3D&&) = default;
+
+	void Reset()
+	{
+		std::fill(m_cells.begin(), m_cells.end(), (byte)WALL3D_ALL);
+	}
+
+	int GetWidth() const
+	{
+		return m_width;
+	}
+
+	int GetHeight() const
+	{
+		return m_height;
+	}
+
+	int GetDepth() const
+	{
+		return m_depth;
+	}
+
+	int64_t GetCellCount() const
+	{
+		return (int64_t)m_width * m_height * m_depth;
+	}
+
+	// Padding included; storage indices are below this
+	int64_t GetStorageSize() const
+	{
+		return (int64_t)m_cells.size();
+	}
+
+	int64_t GetIndex(int x, int y, int z) const
+	{
+		int64_t brick = ((int64_t)(z >> 3) * m_bricksY + (y >> 3)) * m_bricksX + (x >> 3);
+		return (brick << 9) | ((z & 7) << 6) | ((y & 7) << 3) | (x & 7);
+	}
+
+	void GetPosition(int64_t index, int& x, int& y, int& z) const
+	{
+		int64_t brick = index >> 9;
+		x = (int)(brick % m_bricksX) * 8 + (int)(index & 7);
+		y = (int)(brick / m_bricksX % m_bricksY) * 8 + (int)((index >> 3) & 7);
+		z = (int)(brick / ((int64_t)m_bricksX * m_bricksY)) * 8 + (int)((index >> 6) & 7);
+	}
+
+	// Storage index of the cell one step towards a single WALL_* direction, without going through
+	// coordinates. The step must stay inside the maze, which any open wall guarantees.
+	int64_t GetNeighbor(int64_t index, byte direction) const
+	{
+		switch (direction)
+		{
+		case WALL_RIGHT:
+			return (index & 7) != 7 ? index + 1 : index + BRICK_CELLS - 7;
+		case WALL_LEFT:
+			return (index & 7) != 0 ? index - 1 : index - BRICK_CELLS + 7;
+		case WALL_UP:
+			return (index & (7 << 3)) != (7 << 3) ? index + 8 : index + (int64_t)m_bricksX * BRICK_CELLS - (7 << 3);
+		case WALL_DOWN:
+			return (index & (7 << 3)) != 0 ? index - 8 : index - (int64_t)m_bricksX * BRICK_CELLS + (7 << 3);
+		case WALL_ABOVE:
+			return (index & (7 << 6)) != (7 << 6) ? index + 64 : index + (int64_t)m_bricksX * m_bricksY * BRICK_CELLS - (7 << 6);
+		case WALL_BELOW:
+			return (index & (7 << 6)) != 0 ? index - 64 : index - (int64_t)m_bricksX * m_bricksY * BRICK_CELLS + (7 << 6);
+		}
+		return index;
+	}
+
+	// WALL_UP <-> WALL_DOWN, WALL_LEFT <-> WALL_RIGHT, WALL_ABOVE <-> WALL_BELOW
+	static byte GetOpposite(byte direction)
+	{
+		return (byte)(((direction & 0x15) << 1) | ((direction & 0x2a) >> 1));
+	}
+
+	byte GetWalls(int64_t index) const
+	{
+		return m_cells[index] & WALL3D_ALL;
+	}
+
+	byte GetWalls(int x, int y, int z) const
+	{
+		return GetWalls(GetIndex(x, y, z));
+	}
+
+	void RemoveWalls(int64_t index, byte walls)
+	{
+		m_cells[index] ^= walls;
+	}
+
+	bool IsVisited(int64_t index) const
+	{
+		return (m_cells[index] & CELL3D_VISITED) != 0;
+	}
+
+	void SetVisited(int64_t index)
+	{
+		m_cells[index] |= CELL3D_VISITED;
+	}
+
+	byte GetCell(int64_t index) const
+	{
+		return m_cells[index];
+	}
+
+	void SetCell(int64_t index, byte cell)
+	{
+		m_cells[index] = cell;
+	}
+
+	const byte* GetData() const
+	{
+		return m_cells.data();
+	}
+};
@@ -0,0 +1,135 @@
+#include "Maze3DSerializer.h"
+
+static const byte MAZE3D_MAGIC[4] = { 'R', 'B', 'T', '3' };
+static const byte MAZE3D_VERSION = 1;
+
+static void PutU32(byte* p, uint32_t value)
+{
+	p[0] = (byte)value;
+	p[1] = (byte)(value >> 8);
+	p[2] = (byte)(value >> 16);
+	p[3] = (byte)(value >> 24);
+}
+
+static uint32_t GetU32(const byte* p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void Maze3DSerializer::Write(const Maze3D& maze, std::vector<byte>& out)
+{
+	const int width = maze.GetWidth();
+	const int height = maze.GetHeight();
+	const int depth = maze.GetDepth();
+	size_t begin = out.size();
+	out.resize(begin + GetSerializedSize(width, height, depth));
+
+	byte* p = &out[begin];
+	for (int i = 0; i < 4; i++)
+	{
+		p[i] = MAZE3D_MAGIC[i];
+	}
+	p[4] = MAZE3D_VERSION;
+	PutU32(p + 5, width);
+	PutU32(p + 9, height);
+	PutU32(p + 13, depth);
+	p += HEADER_SIZE;
+
+	// Bits gather in an accumulator and leave it a byte at a time
+	uint32_t bits = 0U;
+	int bitCount = 0;
+	for (int z = 0; z < depth; z++)
+	{
+		for (int y = 0; y < height; y++)
+		{
+			int64_t index = maze.GetIndex(0, y, z);
+			for (int x = 0; x < width; x++)
+			{
+				byte walls = maze.GetWalls(index);
+				// WALL_UP stays bit 0, WALL_RIGHT moves from bit 3 to 1 and WALL_ABOVE from bit 4 to 2
+				bits |= (uint32_t)((walls & WALL_UP) | ((walls & WALL_RIGHT) >> 2) | ((walls & WALL_ABOVE) >> 2)) << bitCount;
+				bitCount += 3;
+				if (bitCount >= 8)
+				{
+					*p++ = (byte)bits;
+					bits >>= 8;
+					bitCount -= 8;
+				}
+				if (x + 1 < width)
+					index = maze.GetNeighbor(index, WALL_RIGHT);
+			}
+		}
+	}
+	if (bitCount > 0)
+		*p++ = (byte)bits;
+}
+
+bool Maze3DSerializer::ReadSize(const byte* data, size_t size, int& width, int& height, int& depth)
+{
+	if (size < HEADER_SIZE)
+		return false;
+	for (int i = 0; i < 4; i++)
+	{
+		if (data[i] != MAZE3D_MAGIC[i])
+			return false;
+	}
+	if (data[4] != MAZE3D_VERSION)
+		return false;
+	uint32_t w = GetU32(data + 5);
+	uint32_t h = GetU32(data + 9);
+	uint32_t d = GetU32(data + 13);
+	if (w == 0 or h == 0 or d == 0 or w > 0x7ffffff8 or h > 0x7ffffff8 or d > 0x7ffffff8)
+		return false;
+	width = (int)w;
+	height = (int)h;
+	depth = (int)d;
+	return size >= GetSerializedSize(width, height, depth);
+}
+
+bool Maze3DSerializer::Read(const byte* data, size_t size, Maze3D& maze)
+{
+	int width, height, depth;
+	if (!ReadSize(data, size, width, height, depth) or width != maze.GetWidth() or height != maze.GetHeight() or depth != maze.GetDepth())
+		return false;
+
+	const byte* p = data + HEADER_SIZE;
+	int64_t bitIndex = 0;
+	for (int z = 0; z < depth; z++)
+	{
+		for (int y = 0; y < height; y++)
+		{
+			int64_t index = maze.GetIndex(0, y, z);
+			for (int x = 0; x < width; x++)
+			{
+				// Three bits never straddle more than two bytes; the second one is only read if needed
+				int shift = (int)(bitIndex & 7);
+				uint32_t word = p[bitIndex >> 3];
+				if (shift > 5)
+					word |= (uint32_t)p[(bitIndex >> 3) + 1] << 8;
+				byte stored = (word >> shift) & 0x07;
+				bitIndex += 3;
+				byte cell = (stored & 0x01) | ((stored & 0x02) << 2) | ((stored & 0x04) << 2);
+
+				// The border is closed whatever the data says, so an open wall always has a cell behind it
+				if (y + 1 == height)
+					cell |= WALL_UP;
+				if (x + 1 == width)
+					cell |= WALL_RIGHT;
+				if (z + 1 == depth)
+					cell |= WALL_ABOVE;
+
+				// Down, left and below come from the neighbours, which were read already
+				if (y == 0 or (maze.GetWalls(maze.GetNeighbor(index, WALL_DOWN)) & WALL_UP))
+					cell |= WALL_DOWN;
+				if (x == 0 or (maze.GetWalls(maze.GetNeighbor(index, WALL_LEFT)) & WALL_RIGHT))
+					cell |= WALL_LEFT;
+				if (z == 0 or (maze.GetWalls(maze.GetNeighbor(index, WALL_BELOW)) & WALL_ABOVE))
+					cell |= WALL_BELOW;
+				maze.SetCell(index, cell);
+				if (x + 1 < width)
+					index = maze.GetNeighbor(index, WALL_RIGHT);
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "Maze3D.h"
+#include <cstdint>
+#include <vector>
+
+// Compact on-disk/on-wire form of a finished Maze3D, the 3D counterpart of MazeSerializer. Three
+// walls are kept per cell (up, right and above); the other three are the neighbours' and the
+// border is always closed. Cells are written row-major whatever the in-memory brick layout, so
+// the format doesn't change if the layout does. The visited flag is not stored.
+//
+// Layout (little-endian): "RBT3" u8 version, u32 width, u32 height, u32 depth, then a bit stream
+// of three bits per cell, x fastest, then y, then z: bit 3i = up, 3i + 1 = right, 3i + 2 = above.
+class Maze3DSerializer
+{
+public:
+	static const size_t HEADER_SIZE = 17;
+
+	static size_t GetSerializedSize(int width, int height, int depth)
+	{
+		return HEADER_SIZE + ((size_t)width * height * depth * 3 + 7) / 8;
+	}
+
+	static void Write(const Maze3D& maze, std::vector<byte>& out);
+
+	// Reads just the header; false if it isn't a serialized 3D maze
+	static bool ReadSize(const byte* data, size_t size, int& width, int& height, int& depth);
+
+	// maze must already have the serialized size
+	static bool Read(const byte* data, size_t size, Maze3D& maze);
+};
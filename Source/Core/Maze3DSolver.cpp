@@ -0,0 +1,58 @@
+#include "Maze3DSolver.h"
+#include <algorithm>
+
+// Marks the start cell, which has no direction to come from
+static const byte CAME_FROM_START = 0x40;
+
+Maze3DSolver::Maze3DSolver()
+	:m_cameFrom(), m_frontier(), m_nextFrontier(), m_path(), m_visitedCount(0)
+{
+}
+
+bool Maze3DSolver::Solve(const Maze3D& maze, int64_t start, int64_t goal)
+{
+	m_cameFrom.assign((size_t)maze.GetStorageSize(), 0U);
+	m_frontier.clear();
+	m_nextFrontier.clear();
+	m_path.clear();
+
+	m_cameFrom[start] = CAME_FROM_START;
+	m_frontier.push_back(start);
+	m_visitedCount = 1;
+
+	bool found = start == goal;
+	while (!found and !m_frontier.empty())
+	{
+		for (int64_t current : m_frontier)
+		{
+			byte open = ~maze.GetWalls(current) & WALL3D_ALL;
+			while (open != 0U)
+			{
+				byte direction = open & -open;
+				open ^= direction;
+				int64_t next = maze.GetNeighbor(current, direction);
+				if (m_cameFrom[next] == 0U)
+				{
+					m_cameFrom[next] = Maze3D::GetOpposite(direction);
+					m_nextFrontier.push_back(next);
+				}
+			}
+		}
+		m_visitedCount += (int64_t)m_nextFrontier.size();
+		m_frontier.swap(m_nextFrontier);
+		m_nextFrontier.clear();
+		found = m_cameFrom[goal] != 0U;
+	}
+	if (!found)
+		return false;
+
+	// Walk back from the goal, then flip the path around
+	for (int64_t current = goal; ; current = maze.GetNeighbor(current, m_cameFrom[current]))
+	{
+		m_path.push_back(current);
+		if (m_cameFrom[current] == CAME_FROM_START)
+			break;
+	}
+	std::reverse(m_path.begin(), m_path.end());
+	return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "Maze3D.h"
+#include <vector>
+
+// Breadth-first shortest path between two cells of a Maze3D, level by level like MazeSolver.
+// Cells are storage indices and neighbours are found with Maze3D::GetNeighbor(), so the search
+// reads the bricks in storage order as much as the maze allows. Buffers are kept between calls.
+class Maze3DSolver
+{
+private:
+	std::vector<byte> m_cameFrom; // WALL_* direction each reached cell was entered from, 0 if unreached
+	std::vector<int64_t> m_frontier;
+	std::vector<int64_t> m_nextFrontier;
+	std::vector<int64_t> m_path;
+	int64_t m_visitedCount;
+public:
+	Maze3DSolver();
+
+	// Returns false if goal can't be reached from start
+	bool Solve(const Maze3D& maze, int64_t start, int64_t goal);
+
+	// Cells from start to goal, both included
+	const std::vector<int64_t>& GetPath() const
+	{
+		return m_path;
+	}
+
+	// Cells the last search reached before finding the goal
+	int64_t GetVisitedCount() const
+	{
+		return m_visitedCount;
+	}
+};
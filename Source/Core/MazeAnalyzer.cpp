@@ -0,0 +1,170 @@
+#include "MazeAnalyzer.h"
+
+// Openings per wall nibble, i.e. 4 - popcount(walls)
+static const byte OPENINGS[16] = { 4, 3, 3, 2, 3, 2, 2, 1, 3, 2, 2, 1, 2, 1, 1, 0 };
+
+MazeAnalyzer::MazeAnalyzer()
+	:m_previousRow(), m_currentRow(), m_previousRuns(), m_currentRuns(), m_runLengths(), m_downLinks(), m_parent(), m_length(), m_componentLengths(), m_newIndex(), m_solver()
+{
+}
+
+int32_t MazeAnalyzer::Find(int32_t label)
+{
+	int32_t root = label;
+	while (m_parent[root] != root)
+	{
+		root = m_parent[root];
+	}
+	while (m_parent[label] != root)
+	{
+		int32_t next = m_parent[label];
+		m_parent[label] = root;
+		label = next;
+	}
+	return root;
+}
+
+void MazeAnalyzer::EndCorridor(MazeMetrics& metrics, int64_t length)
+{
+	int bucket = 0;
+	while (bucket + 1 < MazeMetrics::CORRIDOR_BUCKETS and (length >> (bucket + 1)) != 0)
+	{
+		bucket++;
+	}
+	metrics.corridors++;
+	metrics.corridorHistogram[bucket]++;
+	if (length > metrics.longestCorridor)
+		metrics.longestCorridor = length;
+}
+
+void MazeAnalyzer::MeasureGrid(const Maze& maze, MazeMetrics& metrics)
+{
+	const int width = maze.GetWidth();
+	const int height = maze.GetHeight();
+	const byte* cells = maze.GetData();
+
+	metrics = MazeMetrics();
+	metrics.cells = maze.GetCellCount();
+	int64_t openingCounts[5] = {};
+
+	m_previousRow.assign(width, -1);
+	m_currentRow.assign(width, -1);
+	m_previousRuns.assign(width, 0);
+	m_currentRuns.assign(width, 0);
+	m_runLengths.assign((size_t)width + 1, 0);
+	m_downLinks.assign(width, 0);
+	m_parent.assign((size_t)width * 2, 0);
+	m_length.assign((size_t)width * 2, 0);
+	m_componentLengths.assign(width, 0);
+	m_newIndex.assign((size_t)width * 2, 0);
+	int32_t components = 0;
+
+	for (int y = 0; y < height; y++)
+	{
+		const byte* row = cells + (int64_t)y * width;
+		int32_t* current = m_currentRow.data();
+		const int32_t* previous = m_previousRow.data();
+		int64_t* runLengths = m_runLengths.data();
+		int32_t* downLinks = m_downLinks.data();
+		int32_t runs = 0;
+		int32_t links = 0;
+		int32_t leftCorridor = 0;
+
+		// Branch-free: corridor cells joined to the left share a run, and runs are numbered from 1 so
+		// that cells outside any run only ever touch runLengths[0]. Runs joined to a corridor below
+		// are listed for the union-find.
+		for (int x = 0; x < width; x++)
+		{
+			byte walls = row[x] & WALL_ALL;
+			byte openings = OPENINGS[walls];
+			openingCounts[openings]++;
+			int32_t corridor = openings == 2;
+			int32_t joinLeft = corridor & leftCorridor & ((walls & WALL_LEFT) == 0);
+			runs += corridor & (joinLeft ^ 1);
+			current[x] = (runs & -corridor) - 1;
+			runLengths[runs & -corridor] += corridor;
+			downLinks[links] = x;
+			links += corridor & (previous[x] >= 0) & ((walls & WALL_DOWN) == 0);
+			leftCorridor = corridor;
+		}
+
+		// Union-find nodes for this row: the corridors still open below come first, then the runs
+		int32_t nodes = components + runs;
+		for (int32_t i = 0; i < nodes; i++)
+		{
+			m_parent[i] = i;
+			m_newIndex[i] = -1;
+		}
+		for (int32_t i = 0; i < components; i++)
+		{
+			m_length[i] = m_componentLengths[i];
+		}
+		for (int32_t run = 0; run < runs; run++)
+		{
+			m_length[components + run] = runLengths[run + 1];
+			runLengths[run + 1] = 0;
+		}
+		runLengths[0] = 0;
+
+		for (int32_t i = 0; i < links; i++)
+		{
+			int32_t x = downLinks[i];
+			int32_t below = Find(m_previousRuns[previous[x]]);
+			int32_t label = Find(components + current[x]);
+			if (below != label)
+			{
+				m_parent[below] = label;
+				m_length[label] += m_length[below];
+			}
+		}
+
+		// Corridors that reach this row are renumbered densely for the next one; the others can't
+		// grow any more
+		int32_t open = 0;
+		for (int32_t run = 0; run < runs; run++)
+		{
+			int32_t root = Find(components + run);
+			if (m_newIndex[root] < 0)
+			{
+				m_newIndex[root] = open;
+				m_componentLengths[open] = m_length[root];
+				open++;
+			}
+			m_currentRuns[run] = m_newIndex[root];
+		}
+		for (int32_t i = 0; i < components; i++)
+		{
+			if (m_parent[i] == i and m_newIndex[i] < 0)
+				EndCorridor(metrics, m_length[i]);
+		}
+		components = open;
+		m_previousRow.swap(m_currentRow);
+		m_previousRuns.swap(m_currentRuns);
+	}
+	for (int32_t i = 0; i < components; i++)
+	{
+		EndCorridor(metrics, m_componentLengths[i]);
+	}
+
+	metrics.deadEnds = openingCounts[1];
+	metrics.corridorCells = openingCounts[2];
+	metrics.junctions3 = openingCounts[3];
+	metrics.junctions4 = openingCounts[4];
+	metrics.riverFactor = metrics.cells > 0 ? (double)metrics.corridorCells / metrics.cells : 0.0;
+}
+
+void MazeAnalyzer::Measure(const Maze& maze, int64_t start, int64_t goal, MazeMetrics& metrics)
+{
+	MeasureGrid(maze, metrics);
+	if (!m_solver.Solve(maze, start, goal))
+		return;
+
+	const std::vector<int64_t>& path = m_solver.GetPath();
+	metrics.solutionLength = (int64_t)path.size();
+	for (size_t i = 0; i + 1 < path.size(); i++)
+	{
+		byte openings = OPENINGS[maze.GetWalls(path[i])];
+		if (openings >= (i == 0 ? 2 : 3))
+			metrics.solutionDecisions++;
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "Maze.h"
+#include "MazeSolver.h"
+#include <cstdint>
+#include <vector>
+
+// Difficulty numbers for one finished maze. "Openings" are the missing walls of a cell.
+struct MazeMetrics
+{
+	static const int CORRIDOR_BUCKETS = 40;
+
+	int64_t cells = 0;
+	int64_t deadEnds = 0;        // One opening
+	int64_t corridorCells = 0;   // Two openings
+	int64_t junctions3 = 0;      // Three openings
+	int64_t junctions4 = 0;      // Four openings
+
+	// A corridor is a maximal chain of two-opening cells; its length counts those cells only.
+	// corridorHistogram[k] is the number of corridors with length in [2^k, 2^(k+1)).
+	int64_t corridors = 0;
+	int64_t longestCorridor = 0;
+	int64_t corridorHistogram[CORRIDOR_BUCKETS] = {};
+
+	// Share of cells that are corridor: close to 1 for long winding passages with few choices,
+	// lower for mazes full of short dead-end branches.
+	double riverFactor = 0.0;
+
+	// Cells on the path from start to goal, both included, and how many of them offer a choice:
+	// the start if it has two or more openings, any later cell but the goal with three or more.
+	int64_t solutionLength = 0;
+	int64_t solutionDecisions = 0;
+};
+
+// Computes MazeMetrics. The grid-local numbers come from one pass over the packed cells, row by
+// row, classifying each cell's wall nibble with a lookup table. The per-cell loop has no branches;
+// corridor cells are grouped into horizontal runs there, and only runs go through a union-find
+// that is rebuilt for every row, so memory stays O(width) however tall the maze is. The solution numbers need a search and come from MazeSolver.
+//
+// Buffers are kept between calls; one analyzer per thread.
+class MazeAnalyzer
+{
+private:
+	std::vector<int32_t> m_previousRow;  // Corridor run of each cell in the row below, -1 if none
+	std::vector<int32_t> m_currentRow;
+	std::vector<int32_t> m_previousRuns;     // Open corridor each run in the row below belongs to
+	std::vector<int32_t> m_currentRuns;
+	std::vector<int64_t> m_runLengths;
+	std::vector<int32_t> m_downLinks;        // Columns where a run continues into the row below
+	std::vector<int32_t> m_parent;           // Union-find over open corridors and this row's runs
+	std::vector<int64_t> m_length;
+	std::vector<int64_t> m_componentLengths; // Cells so far in each corridor still open
+	std::vector<int32_t> m_newIndex;
+	MazeSolver m_solver;
+
+	int32_t Find(int32_t label);
+	void EndCorridor(MazeMetrics& metrics, int64_t length);
+public:
+	MazeAnalyzer();
+
+	// Only the grid-local metrics; the solution fields are left at 0
+	void MeasureGrid(const Maze& maze, MazeMetrics& metrics);
+
+	void Measure(const Maze& maze, int64_t start, int64_t goal, MazeMetrics& metrics);
+};
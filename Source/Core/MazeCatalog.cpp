@@ -0,0 +1,326 @@
+#include "MazeCatalog.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+static const unsigned char CATALOG_MAGIC[4] = { 'R', 'B', 'T', 'C' };
+static const unsigned char INDEX_MAGIC[4] = { 'R', 'B', 'T', 'I' };
+static const unsigned char CATALOG_VERSION = 1;
+static const size_t CATALOG_HEADER_SIZE = 16;
+static const size_t INDEX_HEADER_SIZE = 16;
+
+static const char* const KEY_NAMES[CATALOG_KEY_COUNT] = { "seed", "solution", "decisions", "dead-ends", "longest-corridor", "river" };
+
+// 64-bit offsets even where long is 32 bits
+static bool SeekFile(FILE* pFile, uint64_t offset, int origin)
+{
+#ifdef _WIN32
+	return _fseeki64(pFile, (long long)offset, origin) == 0;
+#else
+	return fseeko(pFile, (off_t)offset, origin) == 0;
+#endif
+}
+
+static uint64_t TellFile(FILE* pFile)
+{
+#ifdef _WIN32
+	return (uint64_t)_ftelli64(pFile);
+#else
+	return (uint64_t)ftello(pFile);
+#endif
+}
+
+static uint32_t Clamp32(int64_t value)
+{
+	if (value < 0)
+		return 0;
+	return value > UINT32_MAX ? UINT32_MAX : (uint32_t)value;
+}
+
+CatalogRecord MakeCatalogRecord(int algorithm, int width, int height, uint64_t seed, const MazeMetrics& metrics)
+{
+	CatalogRecord record = {};
+	record.seed = seed;
+	record.width = (uint32_t)width;
+	record.height = (uint32_t)height;
+	record.solutionLength = Clamp32(metrics.solutionLength);
+	record.solutionDecisions = Clamp32(metrics.solutionDecisions);
+	record.deadEnds = Clamp32(metrics.deadEnds);
+	record.junctions = Clamp32(metrics.junctions3 + metrics.junctions4);
+	record.corridors = Clamp32(metrics.corridors);
+	record.longestCorridor = Clamp32(metrics.longestCorridor);
+	record.riverFactor = (uint16_t)(metrics.riverFactor * 65535.0 + 0.5);
+	record.algorithm = (uint8_t)algorithm;
+	return record;
+}
+
+CatalogWriter::CatalogWriter()
+	:m_pFile(nullptr), m_count(0)
+{
+}
+
+CatalogWriter::~CatalogWriter()
+{
+	Close();
+}
+
+bool CatalogWriter::Open(const char* path)
+{
+	Close();
+	m_pFile = fopen(path, "r+b");
+	if (m_pFile == nullptr)
+		m_pFile = fopen(path, "w+b");
+	if (m_pFile == nullptr)
+		return false;
+
+	unsigned char header[CATALOG_HEADER_SIZE] = {};
+	if (fread(header, 1, CATALOG_HEADER_SIZE, m_pFile) == CATALOG_HEADER_SIZE)
+	{
+		uint32_t recordSize;
+		memcpy(&recordSize, header + 8, 4);
+		if (memcmp(header, CATALOG_MAGIC, 4) != 0 or header[4] != CATALOG_VERSION or recordSize != sizeof(CatalogRecord))
+		{
+			fclose(m_pFile);
+			m_pFile = nullptr;
+			return false;
+		}
+	}
+	else
+	{
+		// New or empty file
+		memcpy(header, CATALOG_MAGIC, 4);
+		header[4] = CATALOG_VERSION;
+		uint32_t recordSize = sizeof(CatalogRecord);
+		memcpy(header + 8, &recordSize, 4);
+		SeekFile(m_pFile, 0, SEEK_SET);
+		fwrite(header, 1, CATALOG_HEADER_SIZE, m_pFile);
+	}
+
+	// Start after the last whole record
+	SeekFile(m_pFile, 0, SEEK_END);
+	uint64_t size = TellFile(m_pFile);
+	m_count = size > CATALOG_HEADER_SIZE ? (size - CATALOG_HEADER_SIZE) / sizeof(CatalogRecord) : 0;
+	SeekFile(m_pFile, CATALOG_HEADER_SIZE + m_count * sizeof(CatalogRecord), SEEK_SET);
+	setvbuf(m_pFile, nullptr, _IOFBF, 1 << 20);
+	return true;
+}
+
+void CatalogWriter::Append(const CatalogRecord& record)
+{
+	if (m_pFile == nullptr)
+		return;
+	fwrite(&record, sizeof(CatalogRecord), 1, m_pFile);
+	m_count++;
+}
+
+bool CatalogWriter::Close()
+{
+	if (m_pFile == nullptr)
+		return true;
+	bool good = fflush(m_pFile) == 0 and ferror(m_pFile) == 0;
+	good = fclose(m_pFile) == 0 and good;
+	m_pFile = nullptr;
+	return good;
+}
+
+MazeCatalog::MazeCatalog()
+	:m_file(), m_pRecords(nullptr), m_count(0), m_indexFiles(), m_pIndexes(), m_indexed()
+{
+}
+
+uint64_t MazeCatalog::MakeGroup(int algorithm, int width, int height)
+{
+	return ((uint64_t)(algorithm & 0xff) << 56) | ((uint64_t)(width & 0xfffffff) << 28) | (uint64_t)(height & 0xfffffff);
+}
+
+std::string MazeCatalog::GetIndexPath(const char* path, int key)
+{
+	return std::string(path) + "." + KEY_NAMES[key] + ".idx";
+}
+
+bool MazeCatalog::Open(const char* path)
+{
+	m_pRecords = nullptr;
+	m_count = 0;
+	if (!m_file.Open(path) or m_file.GetSize() < CATALOG_HEADER_SIZE)
+		return false;
+
+	const unsigned char* header = m_file.GetData();
+	uint32_t recordSize;
+	memcpy(&recordSize, header + 8, 4);
+	if (memcmp(header, CATALOG_MAGIC, 4) != 0 or header[4] != CATALOG_VERSION or recordSize != sizeof(CatalogRecord))
+		return false;
+	m_pRecords = (const CatalogRecord*)(header + CATALOG_HEADER_SIZE);
+	m_count = (m_file.GetSize() - CATALOG_HEADER_SIZE) / sizeof(CatalogRecord);
+
+	for (int key = 0; key < CATALOG_KEY_COUNT; key++)
+	{
+		m_pIndexes[key] = nullptr;
+		m_indexed[key] = 0;
+		MappedFile& index = m_indexFiles[key];
+		if (!index.Open(GetIndexPath(path, key).c_str()))
+			continue;
+
+		// An index that doesn't match this file is ignored, and queries fall back to scanning
+		const unsigned char* indexHeader = index.GetData();
+		uint64_t covered = 0;
+		if (index.GetSize() >= INDEX_HEADER_SIZE)
+			memcpy(&covered, indexHeader + 8, 8);
+		if (index.GetSize() < INDEX_HEADER_SIZE or memcmp(indexHeader, INDEX_MAGIC, 4) != 0 or indexHeader[4] != CATALOG_VERSION
+			or indexHeader[5] != key or covered > m_count or index.GetSize() != INDEX_HEADER_SIZE + covered * sizeof(IndexEntry))
+		{
+			index.Close();
+			continue;
+		}
+		m_pIndexes[key] = (const IndexEntry*)(indexHeader + INDEX_HEADER_SIZE);
+		m_indexed[key] = covered;
+	}
+	return true;
+}
+
+size_t MazeCatalog::Query(const CatalogQuery& query, std::vector<uint64_t>& records) const
+{
+	if (query.key < 0 or query.key >= CATALOG_KEY_COUNT)
+		return 0;
+	const uint64_t group = MakeGroup(query.algorithm, query.width, query.height);
+	size_t found = 0;
+
+	const IndexEntry* pEntries = m_pIndexes[query.key];
+	uint64_t scanFrom = 0;
+	if (pEntries != nullptr)
+	{
+		const IndexEntry* pEnd = pEntries + m_indexed[query.key];
+		const IndexEntry* it = std::lower_bound(pEntries, pEnd, query, [group](const IndexEntry& entry, const CatalogQuery& q)
+			{
+				return entry.group != group ? entry.group < group : entry.value < q.min;
+			});
+		for (; it != pEnd and found < query.limit and it->group == group and it->value <= query.max; ++it)
+		{
+			records.push_back(it->record);
+			found++;
+		}
+		scanFrom = m_indexed[query.key];
+	}
+
+	for (uint64_t record = scanFrom; record < m_count and found < query.limit; record++)
+	{
+		const CatalogRecord& r = m_pRecords[record];
+		if (r.algorithm != query.algorithm or r.width != (uint32_t)query.width or r.height != (uint32_t)query.height)
+			continue;
+		uint64_t value = GetKey(r, query.key);
+		if (value >= query.min and value <= query.max)
+		{
+			records.push_back(record);
+			found++;
+		}
+	}
+	return found;
+}
+
+bool MazeCatalog::Find(int algorithm, int width, int height, uint64_t seed, uint64_t& record) const
+{
+	CatalogQuery query;
+	query.algorithm = algorithm;
+	query.width = width;
+	query.height = height;
+	query.key = CATALOG_KEY_SEED;
+	query.min = seed;
+	query.max = seed;
+	query.limit = 1;
+	std::vector<uint64_t> records;
+	if (Query(query, records) == 0)
+		return false;
+	record = records[0];
+	return true;
+}
+
+bool MazeCatalog::BuildIndex(const char* path, int key)
+{
+	MazeCatalog catalog;
+	if (key < 0 or key >= CATALOG_KEY_COUNT or !catalog.Open(path))
+		return false;
+
+	std::vector<IndexEntry> entries((size_t)catalog.m_count);
+	for (uint64_t record = 0; record < catalog.m_count; record++)
+	{
+		const CatalogRecord& r = catalog.m_pRecords[record];
+		IndexEntry& entry = entries[(size_t)record];
+		entry.group = MakeGroup(r.algorithm, r.width, r.height);
+		entry.value = GetKey(r, key);
+		entry.record = record;
+	}
+	std::sort(entries.begin(), entries.end(), [](const IndexEntry& a, const IndexEntry& b)
+		{
+			if (a.group != b.group)
+				return a.group < b.group;
+			return a.value != b.value ? a.value < b.value : a.record < b.record;
+		});
+
+	// Written aside and renamed over the old index, so a reader never maps half an index
+	std::string indexPath = GetIndexPath(path, key);
+	std::string tempPath = indexPath + ".tmp";
+	FILE* pFile = fopen(tempPath.c_str(), "wb");
+	if (pFile == nullptr)
+		return false;
+	unsigned char header[INDEX_HEADER_SIZE] = {};
+	memcpy(header, INDEX_MAGIC, 4);
+	header[4] = CATALOG_VERSION;
+	header[5] = (unsigned char)key;
+	memcpy(header + 8, &catalog.m_count, 8);
+	bool good = fwrite(header, 1, INDEX_HEADER_SIZE, pFile) == INDEX_HEADER_SIZE;
+	good = good and fwrite(entries.data(), sizeof(IndexEntry), entries.size(), pFile) == entries.size();
+	good = fclose(pFile) == 0 and good;
+	if (!good)
+	{
+		remove(tempPath.c_str());
+		return false;
+	}
+#ifdef _WIN32
+	// rename() won't replace an existing file here
+	remove(indexPath.c_str());
+#endif
+	return rename(tempPath.c_str(), indexPath.c_str()) == 0;
+}
+
+uint64_t MazeCatalog::GetKey(const CatalogRecord& record, int key)
+{
+	switch (key)
+	{
+	case CATALOG_KEY_SEED:
+		return record.seed;
+	case CATALOG_KEY_SOLUTION_LENGTH:
+		return record.solutionLength;
+	case CATALOG_KEY_DECISIONS:
+		return record.solutionDecisions;
+	case CATALOG_KEY_DEAD_ENDS:
+		return record.deadEnds;
+	case CATALOG_KEY_LONGEST_CORRIDOR:
+		return record.longestCorridor;
+	case CATALOG_KEY_RIVER_FACTOR:
+		return record.riverFactor;
+	}
+	return 0;
+}
+
+const char* MazeCatalog::GetKeyName(int key)
+{
+	return key >= 0 and key < CATALOG_KEY_COUNT ? KEY_NAMES[key] : "";
+}
+
+int MazeCatalog::FindKey(const char* name)
+{
+	for (int key = 0; key < CATALOG_KEY_COUNT; key++)
+	{
+		if (strcmp(name, KEY_NAMES[key]) == 0)
+			return key;
+	}
+	return -1;
+}
+
+uint64_t MazeCatalog::ParseKeyValue(int key, const char* text)
+{
+	// River factor is stored in 1/65535ths
+	if (key == CATALOG_KEY_RIVER_FACTOR)
+		return (uint64_t)(atof(text) * 65535.0 + 0.5);
+	return strtoull(text, nullptr, 10);
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include "MappedFile.h"
+#include "MazeAnalyzer.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Generators a catalog record can name
+#define MAZE_ALGORITHM_BACKTRACKER 0
+#define MAZE_ALGORITHM_ELLER       1
+
+// What a sorted index orders records by
+#define CATALOG_KEY_SEED             0
+#define CATALOG_KEY_SOLUTION_LENGTH  1
+#define CATALOG_KEY_DECISIONS        2
+#define CATALOG_KEY_DEAD_ENDS        3
+#define CATALOG_KEY_LONGEST_CORRIDOR 4
+#define CATALOG_KEY_RIVER_FACTOR     5
+#define CATALOG_KEY_COUNT            6
+
+// One maze of the catalog. The maze itself isn't stored: RandomMazeGenerator rebuilds it from the
+// seed and size. Records are stored as is, in host byte order (little-endian on every target).
+struct CatalogRecord
+{
+	uint64_t seed;
+	uint32_t width;
+	uint32_t height;
+	uint32_t solutionLength;
+	uint32_t solutionDecisions;
+	uint32_t deadEnds;
+	uint32_t junctions;        // Three or four openings
+	uint32_t corridors;
+	uint32_t longestCorridor;
+	uint16_t riverFactor;      // In 1/65535ths
+	uint8_t algorithm;
+	uint8_t reserved[5];
+};
+static_assert(sizeof(CatalogRecord) == 48, "CatalogRecord is a file format");
+
+// Counts above 2^32 - 1 are clamped
+CatalogRecord MakeCatalogRecord(int algorithm, int width, int height, uint64_t seed, const MazeMetrics& metrics);
+
+// Records of one algorithm and size whose key lies in [min, max]
+struct CatalogQuery
+{
+	int algorithm = MAZE_ALGORITHM_BACKTRACKER;
+	int width = 0;
+	int height = 0;
+	int key = CATALOG_KEY_SOLUTION_LENGTH;
+	uint64_t min = 0;
+	uint64_t max = UINT64_MAX;
+	size_t limit = 50;
+};
+
+// Appends records to a catalog file, creating it if needed. Records are only ever added at the
+// end, so readers that mapped the file earlier keep a valid prefix; a record cut short by a crash
+// is ignored by readers and overwritten by the next writer.
+class CatalogWriter
+{
+private:
+	FILE* m_pFile;
+	uint64_t m_count;
+public:
+	CatalogWriter();
+	~CatalogWriter();
+
+	CatalogWriter(const CatalogWriter&) = delete;
+	CatalogWriter& operator=(const CatalogWriter&) = delete;
+
+	bool Open(const char* path);
+	void Append(const CatalogRecord& record);
+
+	// Flushes and closes; false if anything failed to write
+	bool Close();
+
+	// Records in the file, including the ones appended
+	uint64_t GetCount() const
+	{
+		return m_count;
+	}
+};
+
+// Read side of a catalog: the record file and its indexes, memory-mapped.
+//
+// Catalog files (host byte order):
+//   FILE              "RBTC" u8 version, 3 reserved, u32 record size, u32 reserved; CatalogRecords
+//   FILE.<key>.idx    "RBTI" u8 version, u8 key, 2 reserved, u64 records covered; then entries
+//                     sorted by (algorithm and size, key value, record number)
+//
+// An index covers the records that existed when it was built. Queries search the index, then
+// scan the records appended since, so results stay complete until the index is rebuilt.
+class MazeCatalog
+{
+private:
+	struct IndexEntry
+	{
+		uint64_t group; // Algorithm and size, see MakeGroup()
+		uint64_t value;
+		uint64_t record;
+	};
+
+	MappedFile m_file;
+	const CatalogRecord* m_pRecords;
+	uint64_t m_count;
+	MappedFile m_indexFiles[CATALOG_KEY_COUNT];
+	const IndexEntry* m_pIndexes[CATALOG_KEY_COUNT];
+	uint64_t m_indexed[CATALOG_KEY_COUNT];
+
+	static uint64_t MakeGroup(int algorithm, int width, int height);
+	static std::string GetIndexPath(const char* path, int key);
+public:
+	MazeCatalog();
+
+	// Maps the record file and whichever indexes exist
+	bool Open(const char* path);
+
+	uint64_t GetCount() const
+	{
+		return m_count;
+	}
+
+	const CatalogRecord& GetRecord(uint64_t record) const
+	{
+		return m_pRecords[record];
+	}
+
+	// Records covered by the key's index, 0 without one
+	uint64_t GetIndexedCount(int key) const
+	{
+		return key >= 0 and key < CATALOG_KEY_COUNT ? m_indexed[key] : 0;
+	}
+
+	// Appends the numbers of up to query.limit matching records to records and returns how many.
+	// Indexed matches come first, in key order; then unindexed ones, in file order. A key out of
+	// range matches nothing.
+	size_t Query(const CatalogQuery& query, std::vector<uint64_t>& records) const;
+
+	// Record number of a maze, through the seed index
+	bool Find(int algorithm, int width, int height, uint64_t seed, uint64_t& record) const;
+
+	// Sorts every record by key into a new index file, replacing the old one. Needs 24 bytes of
+	// memory per record.
+	static bool BuildIndex(const char* path, int key);
+
+	static uint64_t GetKey(const CatalogRecord& record, int key);
+
+	// "seed", "solution", "decisions", "dead-ends", "longest-corridor" or "river"
+	static const char* GetKeyName(int key);
+
+	// -1 if there's no key of that name
+	static int FindKey(const char* name);
+
+	// A key's value as typed on a command line: a whole number, or a fraction for "river"
+	static uint64_t ParseKeyValue(int key, const char* text);
+};
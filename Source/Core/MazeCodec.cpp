@@ -0,0 +1,379 @@
+#include "MazeCodec.h"
+#include <atomic>
+
+static const byte CODEC_MAGIC[4] = { 'R', 'B', 'T', 'Z' };
+static const byte CODEC_VERSION = 1;
+
+// LZMA's binary range coder: 11-bit probabilities that move 1/32 of the way towards each bit coded
+#define CODEC_PROBABILITY_BITS 11
+#define CODEC_MOVE_BITS 5
+#define CODEC_TOP (1U << 24)
+
+static void PutU32(byte* p, uint32_t value)
+{
+	p[0] = (byte)value;
+	p[1] = (byte)(value >> 8);
+	p[2] = (byte)(value >> 16);
+	p[3] = (byte)(value >> 24);
+}
+
+static uint32_t GetU32(const byte* p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void CodecModel::Reset()
+{
+	for (CodecProbability& probability : up)
+	{
+		probability = 1 << (CODEC_PROBABILITY_BITS - 1);
+	}
+	for (CodecProbability& probability : right)
+	{
+		probability = 1 << (CODEC_PROBABILITY_BITS - 1);
+	}
+}
+
+class RangeEncoder
+{
+private:
+	std::vector<byte>& m_out;
+	uint64_t m_low;
+	uint32_t m_range;
+	byte m_cache;       // Last byte not yet written, held back in case a carry reaches it
+	uint64_t m_cacheSize;
+
+	void ShiftLow()
+	{
+		if ((uint32_t)m_low < 0xff000000U or (m_low >> 32) != 0)
+		{
+			byte carry = (byte)(m_low >> 32);
+			byte pending = m_cache;
+			do
+			{
+				m_out.push_back((byte)(pending + carry));
+				pending = 0xff;
+			} while (--m_cacheSize != 0);
+			m_cache = (byte)(m_low >> 24);
+		}
+		m_cacheSize++;
+		m_low = (m_low & 0x00ffffff) << 8;
+	}
+public:
+	RangeEncoder(std::vector<byte>& out)
+		:m_out(out), m_low(0), m_range(0xffffffff), m_cache(0), m_cacheSize(1)
+	{
+	}
+
+	bool Code(CodecProbability& probability, bool bit)
+	{
+		uint32_t bound = (m_range >> CODEC_PROBABILITY_BITS) * probability;
+		if (!bit)
+		{
+			m_range = bound;
+			probability += ((1 << CODEC_PROBABILITY_BITS) - probability) >> CODEC_MOVE_BITS;
+		}
+		else
+		{
+			m_low += bound;
+			m_range -= bound;
+			probability -= probability >> CODEC_MOVE_BITS;
+		}
+		while (m_range < CODEC_TOP)
+		{
+			m_range <<= 8;
+			ShiftLow();
+		}
+		return bit;
+	}
+
+	void Finish()
+	{
+		for (int i = 0; i < 5; i++)
+		{
+			ShiftLow();
+		}
+	}
+};
+
+static byte ReadByte(CodecDecoder& decoder)
+{
+	return decoder.pNext < decoder.pEnd ? *decoder.pNext++ : (decoder.pNext++, 0);
+}
+
+static void StartDecoder(CodecDecoder& decoder, const byte* pData, size_t size)
+{
+	decoder.pNext = pData;
+	decoder.pEnd = pData + size;
+	decoder.range = 0xffffffff;
+	decoder.code = 0;
+	for (int i = 0; i < 5; i++)
+	{
+		decoder.code = (decoder.code << 8) | ReadByte(decoder);
+	}
+}
+
+// Same interface as RangeEncoder, so one function codes a row both ways
+class RangeDecoder
+{
+private:
+	CodecDecoder& m_decoder;
+public:
+	RangeDecoder(CodecDecoder& decoder)
+		:m_decoder(decoder)
+	{
+	}
+
+	bool Code(CodecProbability& probability, bool)
+	{
+		CodecDecoder& decoder = m_decoder;
+		uint32_t bound = (decoder.range >> CODEC_PROBABILITY_BITS) * probability;
+		bool bit;
+		if (decoder.code < bound)
+		{
+			decoder.range = bound;
+			probability += ((1 << CODEC_PROBABILITY_BITS) - probability) >> CODEC_MOVE_BITS;
+			bit = false;
+		}
+		else
+		{
+			decoder.code -= bound;
+			decoder.range -= bound;
+			probability -= probability >> CODEC_MOVE_BITS;
+			bit = true;
+		}
+		while (decoder.range < CODEC_TOP)
+		{
+			decoder.range <<= 8;
+			decoder.code = (decoder.code << 8) | ReadByte(decoder);
+		}
+		return bit;
+	}
+};
+
+// Codes the up and right walls of one row, and writes the whole row of cells to pCells. pSource is
+// the row being encoded, nullptr when decoding. pBelow is the row below in the same block, nullptr
+// for the first row of a block, whose down walls are then left closed. The top row has no up walls
+// to code and the last column no right wall.
+template <typename Coder>
+static void CodeRow(Coder& coder, CodecModel& model, const byte* pSource, byte* pCells, const byte* pBelow, int width, bool top)
+{
+	bool leftOpen = false;
+	bool leftUpOpen = false;
+	for (int x = 0; x < width; x++)
+	{
+		bool downOpen = pBelow != nullptr and (pBelow[x] & WALL_UP) == 0;
+		bool belowRightOpen = pBelow != nullptr and (pBelow[x] & WALL_RIGHT) == 0;
+		int context = (int)downOpen | ((int)leftOpen << 1) | ((int)leftUpOpen << 2) | ((int)belowRightOpen << 3);
+		bool upOpen = false;
+		if (!top)
+			upOpen = coder.Code(model.up[context], pSource != nullptr and (pSource[x] & WALL_UP) == 0);
+		bool rightOpen = false;
+		if (x + 1 < width)
+			rightOpen = coder.Code(model.right[context | ((int)upOpen << 4)], pSource != nullptr and (pSource[x] & WALL_RIGHT) == 0);
+
+		byte cell = WALL_ALL;
+		if (upOpen)
+			cell &= ~WALL_UP;
+		if (downOpen)
+			cell &= ~WALL_DOWN;
+		if (leftOpen)
+			cell &= ~WALL_LEFT;
+		if (rightOpen)
+			cell &= ~WALL_RIGHT;
+		pCells[x] = cell;
+		leftOpen = rightOpen;
+		leftUpOpen = upOpen;
+	}
+}
+
+static int GetRowsPerBlock(int width)
+{
+	return (int)std::max<int64_t>(1, (CODEC_BLOCK_CELLS + width - 1) / width);
+}
+
+void MazeCodec::Encode(const Maze& maze, std::vector<byte>& out)
+{
+	int width = maze.GetWidth();
+	int height = maze.GetHeight();
+	int rowsPerBlock = GetRowsPerBlock(width);
+	int blockCount = (height + rowsPerBlock - 1) / rowsPerBlock;
+	size_t begin = out.size();
+	out.resize(begin + HEADER_SIZE + (size_t)blockCount * 4);
+	byte* p = &out[begin];
+	for (int i = 0; i < 4; i++)
+	{
+		p[i] = CODEC_MAGIC[i];
+	}
+	p[4] = CODEC_VERSION;
+	PutU32(p + 5, width);
+	PutU32(p + 9, height);
+	PutU32(p + 13, rowsPerBlock);
+
+	std::vector<byte> rows[2] = { std::vector<byte>(width), std::vector<byte>(width) };
+	CodecModel model;
+	for (int block = 0; block < blockCount; block++)
+	{
+		size_t blockStart = out.size();
+		RangeEncoder encoder(out);
+		model.Reset();
+		int firstRow = block * rowsPerBlock;
+		int lastRow = std::min(firstRow + rowsPerBlock, height);
+		for (int y = firstRow; y < lastRow; y++)
+		{
+			const byte* pBelow = y > firstRow ? rows[(y - 1) % 2].data() : nullptr;
+			CodeRow(encoder, model, maze.GetData() + maze.GetIndex(0, y), rows[y % 2].data(), pBelow, width, y == height - 1);
+		}
+		encoder.Finish();
+		PutU32(&out[begin + HEADER_SIZE + (size_t)block * 4], (uint32_t)(out.size() - blockStart));
+	}
+}
+
+bool MazeCodec::ReadSize(const byte* data, size_t size, int& width, int& height)
+{
+	int rowsPerBlock;
+	size_t blockCount;
+	return ReadHeader(data, size, width, height, rowsPerBlock, blockCount);
+}
+
+bool MazeCodec::ReadHeader(const byte* data, size_t size, int& width, int& height, int& rowsPerBlock, size_t& blockCount)
+{
+	if (size < HEADER_SIZE)
+		return false;
+	for (int i = 0; i < 4; i++)
+	{
+		if (data[i] != CODEC_MAGIC[i])
+			return false;
+	}
+	if (data[4] != CODEC_VERSION)
+		return false;
+	uint32_t w = GetU32(data + 5);
+	uint32_t h = GetU32(data + 9);
+	uint32_t rows = GetU32(data + 13);
+	if (w == 0 or h == 0 or w > 0x7fffffff or h > 0x7fffffff)
+		return false;
+	// Only the block height Encode picks; anything else would let the block loops run off the maze
+	if (rows != (uint32_t)GetRowsPerBlock((int)w))
+		return false;
+	width = (int)w;
+	height = (int)h;
+	rowsPerBlock = (int)rows;
+	blockCount = (size_t)(((uint64_t)h + rows - 1) / rows);
+	return size >= HEADER_SIZE + blockCount * 4;
+}
+
+bool MazeCodec::Decode(const byte* data, size_t size, Maze& maze, ThreadPool* pPool)
+{
+	int width, height, rowsPerBlock;
+	size_t blockCount;
+	if (!ReadHeader(data, size, width, height, rowsPerBlock, blockCount) or width != maze.GetWidth() or height != maze.GetHeight())
+		return false;
+
+	// Where every block starts
+	std::vector<size_t> offsets(blockCount + 1);
+	offsets[0] = HEADER_SIZE + (size_t)blockCount * 4;
+	for (size_t block = 0; block < blockCount; block++)
+	{
+		offsets[block + 1] = offsets[block] + GetU32(data + HEADER_SIZE + (size_t)block * 4);
+		if (offsets[block + 1] > size)
+			return false;
+	}
+
+	std::atomic<bool> damaged(false);
+	auto decodeBlocks = [&](size_t begin, size_t end)
+		{
+			std::vector<byte> rows[2] = { std::vector<byte>(width), std::vector<byte>(width) };
+			CodecModel model;
+			CodecDecoder state;
+			for (size_t block = begin; block < end; block++)
+			{
+				model.Reset();
+				StartDecoder(state, data + offsets[block], offsets[block + 1] - offsets[block]);
+				RangeDecoder decoder(state);
+				int firstRow = (int)block * rowsPerBlock;
+				int lastRow = std::min(firstRow + rowsPerBlock, height);
+				for (int y = firstRow; y < lastRow; y++)
+				{
+					byte* pRow = rows[y % 2].data();
+					CodeRow(decoder, model, nullptr, pRow, y > firstRow ? rows[(y - 1) % 2].data() : nullptr, width, y == height - 1);
+					int64_t index = maze.GetIndex(0, y);
+					for (int x = 0; x < width; x++)
+					{
+						maze.SetCell(index + x, pRow[x]);
+					}
+				}
+				if (state.pNext > state.pEnd)
+					damaged = true;
+			}
+		};
+	if (pPool != nullptr)
+		pPool->ParallelFor(blockCount, 1, decodeBlocks);
+	else
+		decodeBlocks(0, blockCount);
+
+	// The first row of each block was decoded without the row below, so its down walls are all
+	// still closed
+	for (int y = rowsPerBlock; y < height; y += rowsPerBlock)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			if ((maze.GetWalls(x, y - 1) & WALL_UP) == 0)
+				maze.RemoveWalls(maze.GetIndex(x, y), WALL_DOWN);
+		}
+	}
+	return !damaged;
+}
+
+MazeCodecReader::MazeCodecReader()
+	:m_pData(nullptr), m_size(0), m_width(0), m_height(0), m_rowsPerBlock(0), m_row(0), m_blockOffset(0), m_decoder(), m_model(),
+	m_below()
+{
+}
+
+bool MazeCodecReader::Open(const byte* data, size_t size)
+{
+	size_t blockCount;
+	if (!MazeCodec::ReadHeader(data, size, m_width, m_height, m_rowsPerBlock, blockCount))
+		return false;
+	m_pData = data;
+	m_size = size;
+	m_row = 0;
+	m_blockOffset = MazeCodec::HEADER_SIZE + blockCount * 4;
+	m_below.assign(m_width, WALL_ALL);
+	return true;
+}
+
+bool MazeCodecReader::StartBlock()
+{
+	size_t blockSize = GetU32(m_pData + MazeCodec::HEADER_SIZE + (size_t)(m_row / m_rowsPerBlock) * 4);
+	if (m_blockOffset + blockSize > m_size)
+		return false;
+	StartDecoder(m_decoder, m_pData + m_blockOffset, blockSize);
+	m_blockOffset += blockSize;
+	m_model.Reset();
+	return true;
+}
+
+bool MazeCodecReader::NextRow(byte* pCells)
+{
+	if (m_pData == nullptr or m_row == m_height)
+		return false;
+	bool blockStart = m_row % m_rowsPerBlock == 0;
+	if (blockStart and !StartBlock())
+		return false;
+
+	RangeDecoder decoder(m_decoder);
+	CodeRow(decoder, m_model, nullptr, pCells, blockStart ? nullptr : m_below.data(), m_width, m_row == m_height - 1);
+	if (blockStart)
+	{
+		for (int x = 0; x < m_width; x++)
+		{
+			if ((m_below[x] & WALL_UP) == 0)
+				pCells[x] &= ~WALL_DOWN;
+		}
+	}
+	m_below.assign(pCells, pCells + m_width);
+	m_row++;
+	// Only damaged data reads past the end of a block
+	return m_decoder.pNext <= m_decoder.pEnd;
+}
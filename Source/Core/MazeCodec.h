@@ -0,0 +1,97 @@
+#pragma once
+#include "Maze.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <vector>
+
+// Entropy-coded form of a finished maze, for archives and the network: about 1.5 bits per cell
+// of a back-tracker maze against MazeSerializer's two. It stores the same up and right walls of
+// each cell, row-major, but codes each with an adaptive binary range coder whose probability
+// depends on the walls around it that are already known (the cell's own down and left walls, which are the up and
+// right walls of the cells below and to its left, and those cells' other walls). A back-tracker
+// maze's long corridors make most walls easy to guess that way.
+//
+// Rows are coded in blocks of at least CODEC_BLOCK_CELLS cells, each with fresh probabilities and
+// no context from the block below, so blocks decode independently and in parallel. MazeCodecReader
+// decodes one row at a time instead, in constant memory.
+//
+// Layout (little-endian): "RBTZ" u8 version, u32 width, u32 height, u32 rows per block, a u32
+// size for every block, then the blocks. Generation states are not stored.
+#define CODEC_BLOCK_CELLS (1 << 16)
+
+// Adaptive probability of a 0 bit, out of 1 << CODEC_PROBABILITY_BITS
+typedef uint16_t CodecProbability;
+
+// Probabilities for one block: the up wall by the four neighbouring walls already known, the right
+// wall by those and the up wall just coded
+struct CodecModel
+{
+	CodecProbability up[16];
+	CodecProbability right[32];
+
+	void Reset();
+};
+
+// Range decoder state; reads past the end of the block see zeros
+struct CodecDecoder
+{
+	const byte* pNext;
+	const byte* pEnd;
+	uint32_t range;
+	uint32_t code;
+};
+
+class MazeCodec
+{
+public:
+	static const size_t HEADER_SIZE = 17;
+
+	static void Encode(const Maze& maze, std::vector<byte>& out);
+
+	// Reads just the header; false if it isn't an encoded maze
+	static bool ReadSize(const byte* data, size_t size, int& width, int& height);
+
+	// ReadSize plus the block layout, checked against what Encode writes for that width
+	static bool ReadHeader(const byte* data, size_t size, int& width, int& height, int& rowsPerBlock, size_t& blockCount);
+
+	// maze must already have the encoded width and height. The blocks are shared out over pPool if
+	// one is given.
+	static bool Decode(const byte* data, size_t size, Maze& maze, ThreadPool* pPool = nullptr);
+};
+
+// Decodes an encoded maze one row at a time from the bottom (y = 0) up. The data must stay valid
+// while it is read.
+class MazeCodecReader
+{
+private:
+	const byte* m_pData;
+	size_t m_size;
+	int m_width;
+	int m_height;
+	int m_rowsPerBlock;
+	int m_row;                 // Rows handed out so far
+	size_t m_blockOffset;      // Start of the next block's data
+	CodecDecoder m_decoder;
+	CodecModel m_model;
+	std::vector<byte> m_below; // Last row handed out
+
+	bool StartBlock();
+public:
+	MazeCodecReader();
+
+	bool Open(const byte* data, size_t size);
+
+	int GetWidth() const
+	{
+		return m_width;
+	}
+
+	int GetHeight() const
+	{
+		return m_height;
+	}
+
+	// Writes the next row of cells, width bytes, to pCells. Returns false once every row has been
+	// read or if the data is damaged.
+	bool NextRow(byte* pCells);
+};
@@ -0,0 +1,172 @@
+#include "MazeHash.h"
+#include <cstring>
+
+static const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+static const uint64_t NIBBLES = 0x0F0F0F0F0F0F0F0FULL; // WALL_ALL in every byte
+static const int CANONICAL_TILE = 64;
+
+static inline uint64_t Rotl(uint64_t value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t Load64(const byte* p)
+{
+	uint64_t value;
+	memcpy(&value, p, 8);
+	return value;
+}
+
+static inline uint64_t Round(uint64_t lane, uint64_t input)
+{
+	lane += input * PRIME2;
+	lane = Rotl(lane, 31);
+	return lane * PRIME1;
+}
+
+static inline uint64_t Avalanche(uint64_t value)
+{
+	value ^= value >> 33;
+	value *= PRIME2;
+	value ^= value >> 29;
+	value *= PRIME3;
+	value ^= value >> 32;
+	return value;
+}
+
+// Hash of width x height cells laid out row-major; only the low nibble of each byte counts
+static MazeHash128 HashCells(const byte* cells, int width, int height)
+{
+	const int64_t count = (int64_t)width * height;
+	const uint64_t seed = ((uint64_t)(uint32_t)width << 32) | (uint32_t)height;
+	uint64_t lanes[4] = { seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1 };
+
+	const byte* p = cells;
+	const byte* stripeEnd = cells + (count & ~(int64_t)31);
+	for (; p < stripeEnd; p += 32)
+	{
+		lanes[0] = Round(lanes[0], Load64(p) & NIBBLES);
+		lanes[1] = Round(lanes[1], Load64(p + 8) & NIBBLES);
+		lanes[2] = Round(lanes[2], Load64(p + 16) & NIBBLES);
+		lanes[3] = Round(lanes[3], Load64(p + 24) & NIBBLES);
+	}
+	if ((count & 31) != 0)
+	{
+		// The size is in the seed, so padding the last stripe with zeros is unambiguous
+		byte tail[32] = {};
+		memcpy(tail, p, (size_t)(count & 31));
+		for (int i = 0; i < 4; i++)
+		{
+			lanes[i] = Round(lanes[i], Load64(tail + i * 8) & NIBBLES);
+		}
+	}
+
+	MazeHash128 hash;
+	hash.low = Avalanche(Rotl(lanes[0], 1) + Rotl(lanes[1], 7) + Rotl(lanes[2], 12) + Rotl(lanes[3], 18) + (uint64_t)count);
+	hash.high = Avalanche((lanes[0] ^ Rotl(lanes[2], 29)) * PRIME3 + (lanes[1] ^ Rotl(lanes[3], 43)) * PRIME1 + hash.low);
+	return hash;
+}
+
+// Symmetry bits: 1 mirrors x, 2 mirrors y, 4 then swaps x and y
+static void TransformDirection(int symmetry, int& dx, int& dy)
+{
+	if (symmetry & 1)
+		dx = -dx;
+	if (symmetry & 2)
+		dy = -dy;
+	if (symmetry & 4)
+	{
+		int t = dx;
+		dx = dy;
+		dy = t;
+	}
+}
+
+MazeHasher::MazeHasher()
+	:m_wallMaps(), m_scratch()
+{
+	const byte walls[4] = { WALL_UP, WALL_DOWN, WALL_LEFT, WALL_RIGHT };
+	const int directions[4][2] = { { 0, 1 }, { 0, -1 }, { -1, 0 }, { 1, 0 } };
+	for (int symmetry = 0; symmetry < 8; symmetry++)
+	{
+		byte mapped[4];
+		for (int i = 0; i < 4; i++)
+		{
+			int dx = directions[i][0];
+			int dy = directions[i][1];
+			TransformDirection(symmetry, dx, dy);
+			for (int j = 0; j < 4; j++)
+			{
+				if (directions[j][0] == dx and directions[j][1] == dy)
+					mapped[i] = walls[j];
+			}
+		}
+		for (int nibble = 0; nibble < 16; nibble++)
+		{
+			byte result = 0U;
+			for (int i = 0; i < 4; i++)
+			{
+				if (nibble & walls[i])
+					result |= mapped[i];
+			}
+			m_wallMaps[symmetry][nibble] = result;
+		}
+	}
+}
+
+MazeHash128 MazeHasher::Hash(const Maze& maze)
+{
+	return HashCells(maze.GetData(), maze.GetWidth(), maze.GetHeight());
+}
+
+MazeHash128 MazeHasher::HashCanonical(const Maze& maze)
+{
+	const int width = maze.GetWidth();
+	const int height = maze.GetHeight();
+	const byte* cells = maze.GetData();
+	m_scratch.resize((size_t)maze.GetCellCount());
+
+	MazeHash128 best = Hash(maze);
+	for (int symmetry = 1; symmetry < 8; symmetry++)
+	{
+		const bool transpose = (symmetry & 4) != 0;
+		const int newWidth = transpose ? height : width;
+		const int newHeight = transpose ? width : height;
+		const byte* wallMap = m_wallMaps[symmetry];
+
+		// Source index of transformed cell (newX, newY) is first + newX * stepX + newY * stepY
+		const int64_t first = ((symmetry & 2) ? (int64_t)(height - 1) * width : 0) + ((symmetry & 1) ? width - 1 : 0);
+		const int64_t across = (symmetry & 1) ? -1 : 1;
+		const int64_t up = (symmetry & 2) ? -(int64_t)width : width;
+		const int64_t stepX = transpose ? up : across;
+		const int64_t stepY = transpose ? across : up;
+
+		// Copied in tiles so that transposing reads whole cache lines
+		byte* out = m_scratch.data();
+		for (int tileY = 0; tileY < newHeight; tileY += CANONICAL_TILE)
+		{
+			int tileEndY = tileY + CANONICAL_TILE < newHeight ? tileY + CANONICAL_TILE : newHeight;
+			for (int tileX = 0; tileX < newWidth; tileX += CANONICAL_TILE)
+			{
+				int tileEndX = tileX + CANONICAL_TILE < newWidth ? tileX + CANONICAL_TILE : newWidth;
+				for (int newY = tileY; newY < tileEndY; newY++)
+				{
+					const byte* in = cells + first + tileX * stepX + newY * stepY;
+					byte* row = out + (int64_t)newY * newWidth;
+					for (int newX = tileX; newX < tileEndX; newX++)
+					{
+						row[newX] = wallMap[*in & WALL_ALL];
+						in += stepX;
+					}
+				}
+			}
+		}
+
+		MazeHash128 hash = HashCells(m_scratch.data(), newWidth, newHeight);
+		if (hash < best)
+			best = hash;
+	}
+	return best;
+}
@@ -0,0 +1,94 @@
+#include "MazeHashSet.h"
+
+static bool IsZero(const MazeHash128& hash)
+{
+	return hash.low == 0 and hash.high == 0;
+}
+
+MazeHashSet::MazeHashSet()
+	:m_shards()
+{
+}
+
+// Linear probing on the low bits; the shard was picked with the high ones
+bool MazeHashSet::InsertSlot(std::vector<MazeHash128>& slots, const MazeHash128& hash)
+{
+	size_t mask = slots.size() - 1;
+	for (size_t i = (size_t)hash.low & mask;; i = (i + 1) & mask)
+	{
+		if (slots[i] == hash)
+			return false;
+		if (IsZero(slots[i]))
+		{
+			slots[i] = hash;
+			return true;
+		}
+	}
+}
+
+bool MazeHashSet::Insert(const MazeHash128& hash)
+{
+	Shard& shard = m_shards[hash.high >> (64 - SHARD_BITS)];
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	if (IsZero(hash))
+	{
+		bool added = !shard.hasZero;
+		shard.hasZero = true;
+		return added;
+	}
+
+	// Kept at most half full
+	if ((shard.size + 1) * 2 > shard.slots.size())
+	{
+		std::vector<MazeHash128> grown(shard.slots.size() < MIN_SLOTS ? MIN_SLOTS : shard.slots.size() * 2);
+		for (const MazeHash128& old : shard.slots)
+		{
+			if (!IsZero(old))
+				InsertSlot(grown, old);
+		}
+		shard.slots.swap(grown);
+	}
+	if (!InsertSlot(shard.slots, hash))
+		return false;
+	shard.size++;
+	return true;
+}
+
+bool MazeHashSet::Contains(const MazeHash128& hash)
+{
+	Shard& shard = m_shards[hash.high >> (64 - SHARD_BITS)];
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	if (IsZero(hash))
+		return shard.hasZero;
+	if (shard.slots.empty())
+		return false;
+
+	size_t mask = shard.slots.size() - 1;
+	for (size_t i = (size_t)hash.low & mask; !IsZero(shard.slots[i]); i = (i + 1) & mask)
+	{
+		if (shard.slots[i] == hash)
+			return true;
+	}
+	return false;
+}
+
+size_t MazeHashSet::GetSize() const
+{
+	size_t size = 0;
+	for (const Shard& shard : m_shards)
+	{
+		size += shard.size + (shard.hasZero ? 1 : 0);
+	}
+	return size;
+}
+
+void MazeHashSet::Clear()
+{
+	for (Shard& shard : m_shards)
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		shard.slots.clear();
+		shard.size = 0;
+		shard.hasZero = false;
+	}
+}
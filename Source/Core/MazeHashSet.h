@@ -0,0 +1,43 @@
+#pragma once
+#include "MazeHash.h"
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Set of maze hashes shared by many threads. The hashes are split over shards by their top bits,
+// each shard an open-addressing table behind its own mutex, so threads inserting at the same time
+// rarely wait on each other.
+class MazeHashSet
+{
+private:
+	static const int SHARD_BITS = 6;
+	static const int SHARD_COUNT = 1 << SHARD_BITS;
+	static const size_t MIN_SLOTS = 64;
+
+	struct alignas(64) Shard
+	{
+		std::mutex mutex;
+		std::vector<MazeHash128> slots; // An all-zero hash marks a free slot
+		size_t size = 0;
+		bool hasZero = false;           // The all-zero hash itself, which can't be stored in a slot
+	};
+
+	Shard m_shards[SHARD_COUNT];
+
+	static bool InsertSlot(std::vector<MazeHash128>& slots, const MazeHash128& hash);
+public:
+	MazeHashSet();
+
+	MazeHashSet(const MazeHashSet&) = delete;
+	MazeHashSet& operator=(const MazeHashSet&) = delete;
+
+	// Returns false if the hash was already in the set
+	bool Insert(const MazeHash128& hash);
+
+	bool Contains(const MazeHash128& hash);
+
+	// Not synchronized with concurrent inserts
+	size_t GetSize() const;
+
+	void Clear();
+};
@@ -0,0 +1,215 @@
+#include "MazePool.h"
+#include "RandomMazeGenerator.h"
+#include <cstdlib>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Nice value of the background threads; each Linux thread has its own
+#define POOL_NICE 19
+
+static void LowerThreadPriority()
+{
+#ifdef _WIN32
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+	setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), POOL_NICE);
+#endif
+}
+
+// How far a solution length is outside the level's range, 0 inside it
+static int64_t DistanceToLevel(const MazeLevel& level, int64_t solution)
+{
+	if (solution < level.minSolution)
+		return level.minSolution - solution;
+	if (level.maxSolution > 0 and solution > level.maxSolution)
+		return solution - level.maxSolution;
+	return 0;
+}
+
+MazePool::MazePool(uint64_t seed, const std::vector<MazeLevel>& schedule, int capacity, int threadCount)
+	:m_schedule(schedule), m_capacity(capacity > 0 ? capacity : 1), m_threads(), m_mutex(), m_spaceFree(), m_roundBuilt(), m_roundSeeds(seed),
+	m_nextRound(1), m_building(0), m_ready(), m_stopping(false), m_hits(0), m_misses(0)
+{
+	if (m_schedule.empty())
+		m_schedule.push_back(MazeLevel());
+	if (threadCount <= 0)
+		threadCount = (int)std::thread::hardware_concurrency() - 1;
+	threadCount = std::max(1, std::min(threadCount, m_capacity));
+	for (int i = 0; i < threadCount; i++)
+	{
+		m_threads.emplace_back(&MazePool::WorkerLoop, this);
+	}
+}
+
+MazePool::~MazePool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_spaceFree.notify_all();
+	for (std::thread& thread : m_threads)
+	{
+		thread.join();
+	}
+}
+
+void MazePool::WorkerLoop()
+{
+	LowerThreadPriority();
+	MazeAnalyzer analyzer;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true)
+	{
+		m_spaceFree.wait(lock, [this]() { return m_stopping or (int)m_ready.size() + m_building < m_capacity; });
+		if (m_stopping)
+			return;
+		int round = m_nextRound++;
+		uint64_t seed = m_roundSeeds.Next64();
+		m_building++;
+		lock.unlock();
+
+		std::unique_ptr<PooledMaze> pMaze = Build(GetLevel(round), round, seed, analyzer);
+
+		lock.lock();
+		m_building--;
+		m_ready[round] = std::move(pMaze);
+		m_roundBuilt.notify_all();
+	}
+}
+
+std::unique_ptr<PooledMaze> MazePool::Take(int round)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	// Rounds before this one will never be asked for
+	while (!m_ready.empty() and m_ready.begin()->first < round)
+	{
+		m_ready.erase(m_ready.begin());
+	}
+
+	auto found = m_ready.find(round);
+	if (found != m_ready.end())
+	{
+		m_hits++;
+		std::unique_ptr<PooledMaze> pMaze = std::move(found->second);
+		m_ready.erase(found);
+		m_spaceFree.notify_one();
+		return pMaze;
+	}
+	m_misses++;
+
+	if (round < m_nextRound)
+	{
+		// A background thread is on it and has the head start
+		m_roundBuilt.wait(lock, [this, round]() { return m_ready.count(round) != 0; });
+		std::unique_ptr<PooledMaze> pMaze = std::move(m_ready[round]);
+		m_ready.erase(round);
+		m_spaceFree.notify_one();
+		return pMaze;
+	}
+
+	// Not started: claim it, and the seeds of any rounds skipped over, and build it here
+	uint64_t seed = 0;
+	while (m_nextRound <= round)
+	{
+		seed = m_roundSeeds.Next64();
+		m_nextRound++;
+	}
+	lock.unlock();
+	m_spaceFree.notify_all();
+	MazeAnalyzer analyzer;
+	return Build(GetLevel(round), round, seed, analyzer);
+}
+
+MazePoolStats MazePool::GetStats()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	MazePoolStats stats;
+	stats.capacity = m_capacity;
+	stats.ready = (int)m_ready.size();
+	stats.building = m_building;
+	stats.nextRound = m_nextRound;
+	stats.hits = m_hits;
+	stats.misses = m_misses;
+	return stats;
+}
+
+std::unique_ptr<PooledMaze> MazePool::Build(const MazeLevel& level, int round, uint64_t seed, MazeAnalyzer& analyzer)
+{
+	std::unique_ptr<PooledMaze> pBest;
+	int64_t bestDistance = 0;
+	Random candidates(seed);
+	Maze maze(level.width, level.height);
+	for (int attempt = 0; attempt < POOL_MAX_ATTEMPTS; attempt++)
+	{
+		uint64_t candidate = attempt == 0 ? seed : candidates.Next64();
+		if (attempt > 0)
+			maze.Reset();
+		RandomMazeGenerator generator(maze, candidate);
+		generator.Generate();
+		MazeMetrics metrics;
+		analyzer.Measure(maze, generator.GetFirstCell(), generator.GetLastCell(), metrics);
+		int64_t distance = DistanceToLevel(level, metrics.solutionLength);
+		if (pBest != nullptr and distance >= bestDistance)
+			continue;
+
+		if (pBest == nullptr)
+			pBest.reset(new PooledMaze());
+		maze.SetState(generator.GetLastCell(), CELL_GOAL);
+		pBest->round = round;
+		pBest->seed = candidate;
+		pBest->width = level.width;
+		pBest->height = level.height;
+		pBest->cells.assign(maze.GetData(), maze.GetData() + maze.GetCellCount());
+		pBest->start = generator.GetFirstCell();
+		pBest->goal = generator.GetLastCell();
+		pBest->metrics = metrics;
+		bestDistance = distance;
+		if (distance == 0)
+			break;
+	}
+	return pBest;
+}
+
+// One end of a range: digits, or nothing for 0, no bound. A sign is not a number here, so "-60"
+// is an empty minimum and a maximum of 60.
+static int64_t ParseBound(const char*& p)
+{
+	if (*p < '0' or *p > '9')
+		return 0;
+	char* pEnd;
+	int64_t value = strtoll(p, &pEnd, 10);
+	p = pEnd;
+	return value;
+}
+
+bool MazePool::ParseSchedule(const char* text, int width, int height, std::vector<MazeLevel>& schedule)
+{
+	schedule.clear();
+	const char* p = text;
+	while (*p != '\0')
+	{
+		MazeLevel level;
+		level.width = width;
+		level.height = height;
+		level.minSolution = ParseBound(p);
+		if (*p != '-')
+			return false;
+		p++;
+		level.maxSolution = ParseBound(p);
+		if ((*p != ',' and *p != '\0') or (level.maxSolution > 0 and level.maxSolution < level.minSolution))
+			return false;
+		schedule.push_back(level);
+		if (*p == ',')
+			p++;
+	}
+	return !schedule.empty();
+}
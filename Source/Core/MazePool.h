@@ -0,0 +1,101 @@
+#pragma once
+#include "Maze.h"
+#include "MazeAnalyzer.h"
+#include "Random.h"
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Seeds tried per round before settling for the maze closest to the level's difficulty
+#define POOL_MAX_ATTEMPTS 64
+
+// One step of a MazePool schedule: the size of a round's maze and the range its solution length
+// (MazeMetrics::solutionLength) must fall in
+struct MazeLevel
+{
+	int width = 20;
+	int height = 15;
+	int64_t minSolution = 0;
+	int64_t maxSolution = 0;   // 0 = no upper bound
+};
+
+// A finished maze ready to play: fully carved, goal marked, every cell in its final state
+struct PooledMaze
+{
+	int round = 0;
+	uint64_t seed = 0;         // Seed the maze was generated from, after the difficulty search
+	int width = 0;
+	int height = 0;
+	std::vector<byte> cells;
+	int64_t start = -1;
+	int64_t goal = -1;
+	MazeMetrics metrics;
+};
+
+struct MazePoolStats
+{
+	int capacity = 0;
+	int ready = 0;             // Built and waiting to be taken
+	int building = 0;
+	int nextRound = 0;         // First round no thread has started on
+	uint64_t hits = 0;         // Take() found the round ready
+	uint64_t misses = 0;       // Take() had to wait for it or build it itself
+};
+
+// Builds the mazes of upcoming rounds ahead of time, so starting the next level costs a copy
+// instead of generating, solving and measuring a maze. Round r (from 1) uses schedule[r - 1], the
+// last level repeating, and the r-th seed of Random(seed), the same sequence GameSession draws
+// its round seeds from. A level with a difficulty range tries derived seeds until the solution
+// length fits, so which maze a round gets depends only on the seed and the schedule, never on
+// timing: a round that is taken before it is ready is built the same way by the caller.
+//
+// Up to capacity rounds are built or waiting at once, by background threads running at the lowest
+// priority so they only take what the game leaves idle.
+class MazePool
+{
+private:
+	std::vector<MazeLevel> m_schedule;
+	int m_capacity;
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_mutex;
+	std::condition_variable m_spaceFree;
+	std::condition_variable m_roundBuilt;
+	Random m_roundSeeds;
+	int m_nextRound;
+	int m_building;
+	std::map<int, std::unique_ptr<PooledMaze>> m_ready;
+	bool m_stopping;
+	std::atomic<uint64_t> m_hits;
+	std::atomic<uint64_t> m_misses;
+
+	const MazeLevel& GetLevel(int round) const
+	{
+		return m_schedule[(size_t)std::min<int>(round, (int)m_schedule.size()) - 1];
+	}
+
+	void WorkerLoop();
+public:
+	// threadCount <= 0 uses one thread per hardware core but one, for the game
+	MazePool(uint64_t seed, const std::vector<MazeLevel>& schedule, int capacity, int threadCount = 0);
+	~MazePool();
+
+	MazePool(const MazePool&) = delete;
+	MazePool& operator=(const MazePool&) = delete;
+
+	// Rounds must be taken in increasing order; rounds skipped over are dropped
+	std::unique_ptr<PooledMaze> Take(int round);
+
+	MazePoolStats GetStats();
+
+	// Generates, solves and measures round's maze from its drawn seed on the calling thread
+	static std::unique_ptr<PooledMaze> Build(const MazeLevel& level, int round, uint64_t seed, MazeAnalyzer& analyzer);
+
+	// "MIN-MAX,MIN-MAX,..." solution length ranges at the given size. Either end may be left out or
+	// 0 for no bound: "-60" is up to 60, "90-" from 90 on.
+	static bool ParseSchedule(const char* text, int width, int height, std::vector<MazeLevel>& schedule);
+};
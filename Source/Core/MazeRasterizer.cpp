@@ -0,0 +1,284 @@
+#include "MazeRasterizer.h"
+#include <algorithm>
+#include <cstring>
+#if defined(__x86_64__) or defined(_M_X64)
+#include <immintrin.h>
+#define RASTER_X64
+#endif
+
+// Rows per task when drawing on a pool
+#define RASTER_BAND_ROWS 64
+
+// Spans up to this many pixels are stored one by one; the wide fills only pay off past it
+#define RASTER_SHORT_SPAN 8
+
+// Fills count 4-byte pixels with value
+typedef void (*FillFunction)(byte* pPixels, size_t count, uint32_t value);
+
+static void FillScalar(byte* pPixels, size_t count, uint32_t value)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		memcpy(pPixels + i * 4, &value, 4);
+	}
+}
+
+#ifdef RASTER_X64
+static void FillSse2(byte* pPixels, size_t count, uint32_t value)
+{
+	__m128i pattern = _mm_set1_epi32((int)value);
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_si128((__m128i*)(pPixels + i * 4), pattern);
+	}
+	FillScalar(pPixels + i * 4, count - i, value);
+}
+
+#if defined(__GNUC__)
+__attribute__((target("avx2")))
+static void FillAvx2(byte* pPixels, size_t count, uint32_t value)
+{
+	__m256i pattern = _mm256_set1_epi32((int)value);
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_si256((__m256i*)(pPixels + i * 4), pattern);
+	}
+	FillSse2(pPixels + i * 4, count - i, value);
+}
+#endif
+#endif
+
+// The widest fill the CPU runs; SSE2 is part of every x86-64 CPU
+static FillFunction SelectFill()
+{
+#ifdef RASTER_X64
+#if defined(__GNUC__)
+	if (__builtin_cpu_supports("avx2"))
+		return FillAvx2;
+#endif
+	return FillSse2;
+#else
+	return FillScalar;
+#endif
+}
+
+static const FillFunction s_fill = SelectFill();
+
+// Fills count pixels of a row from pixel start on
+static inline void Fill(byte* pRow, int channels, int start, int count, uint32_t color)
+{
+	if (channels == 1)
+	{
+		byte value = (byte)color;
+		if (count <= RASTER_SHORT_SPAN)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				pRow[start + i] = value;
+			}
+		}
+		else
+			memset(pRow + start, value, (size_t)count);
+	}
+	else if (count <= RASTER_SHORT_SPAN)
+		FillScalar(pRow + (size_t)start * 4, (size_t)count, color);
+	else
+		s_fill(pRow + (size_t)start * 4, (size_t)count, color);
+}
+
+// Collects runs of one colour along a row and fills each run with a single call
+class SpanWriter
+{
+private:
+	byte* m_pRow;
+	int m_channels;
+	int m_start;
+	int m_end;
+	uint32_t m_color;
+public:
+	SpanWriter(byte* pRow, int channels)
+		:m_pRow(pRow), m_channels(channels), m_start(0), m_end(0), m_color(0)
+	{
+	}
+
+	void Add(int length, uint32_t color)
+	{
+		if (color != m_color)
+		{
+			Flush();
+			m_start = m_end;
+			m_color = color;
+		}
+		m_end += length;
+	}
+
+	void Flush()
+	{
+		if (m_end == m_start)
+			return;
+		Fill(m_pRow, m_channels, m_start, m_end - m_start, m_color);
+		m_start = m_end;
+	}
+};
+
+static uint32_t MakeColor(byte r, byte g, byte b)
+{
+	return r | (g << 8) | (b << 16) | 0xff000000u;
+}
+
+MazeRasterizer::MazeRasterizer(const Maze& maze, int cellSize, int wallWidth, int channels)
+	:MazeRasterizer(maze.GetWidth(), maze.GetHeight(), cellSize, wallWidth, channels)
+{
+	m_pMaze = &maze;
+}
+
+MazeRasterizer::MazeRasterizer(int width, int height, int cellSize, int wallWidth, int channels)
+	:m_pMaze(nullptr), m_width(width), m_height(height), m_cellSize(cellSize), m_wallWidth(wallWidth), m_channels(channels),
+	m_imageWidth(width * cellSize + wallWidth), m_imageHeight(height * cellSize + wallWidth), m_floorColors(),
+	m_wallColor(channels == 1 ? 0 : MakeColor(0, 0, 0))
+{
+	if (channels == 1)
+	{
+		m_floorColors[0] = m_floorColors[CELL_VISITED >> 4] = m_floorColors[CELL_BACKTRACKED >> 4] = 255;
+		m_floorColors[CELL_GOAL >> 4] = 192;
+		return;
+	}
+
+	// Same colours as MazeTextureRenderer
+	m_floorColors[0] = MakeColor(26, 179, 153);
+	m_floorColors[CELL_VISITED >> 4] = MakeColor(26, 204, 128);
+	m_floorColors[CELL_BACKTRACKED >> 4] = MakeColor(26, 153, 204);
+	m_floorColors[CELL_GOAL >> 4] = MakeColor(255, 230, 191);
+}
+
+// The wall line between the rows of cells pAbove and pBelow, either of which is nullptr along the
+// border. It starts out all wall, then the open segments and the posts no wall ends at take the
+// floor colour of the cell above them. The border is drawn closed, as the generators leave it.
+void MazeRasterizer::BuildWallLine(const byte* pAbove, const byte* pBelow, byte* pRow) const
+{
+	Fill(pRow, m_channels, 0, m_imageWidth, m_wallColor);
+	if (pAbove == nullptr or pBelow == nullptr)
+		return;
+
+	bool leftOpen = false;
+	for (int x = 0; x < m_width; x++)
+	{
+		bool open = (pAbove[x] & WALL_DOWN) == 0;
+		if (!open)
+		{
+			leftOpen = false;
+			continue;
+		}
+		uint32_t gap = GetFloorColor(pAbove[x]);
+		Fill(pRow, m_channels, x * m_cellSize + m_wallWidth, m_cellSize - m_wallWidth, gap);
+		// The post on the left is open when no wall of the four meeting there is
+		if (leftOpen and (pAbove[x] & WALL_LEFT) == 0 and (pBelow[x] & WALL_LEFT) == 0)
+			Fill(pRow, m_channels, x * m_cellSize, m_wallWidth, gap);
+		leftOpen = true;
+	}
+}
+
+// A pixel row through the floors of a row of cells: the floors as runs of one colour, then the
+// left walls, and the right edge
+void MazeRasterizer::BuildFloorRow(const byte* pCells, byte* pRow) const
+{
+	SpanWriter writer(pRow, m_channels);
+	for (int x = 0; x < m_width; x++)
+	{
+		writer.Add(m_cellSize, GetFloorColor(pCells[x]));
+	}
+	writer.Add(m_wallWidth, GetFloorColor(pCells[m_width - 1]));
+	writer.Flush();
+
+	for (int x = 0; x < m_width; x++)
+	{
+		if ((pCells[x] & WALL_LEFT) != 0)
+			Fill(pRow, m_channels, x * m_cellSize, m_wallWidth, m_wallColor);
+	}
+	if ((pCells[m_width - 1] & WALL_RIGHT) != 0)
+		Fill(pRow, m_channels, m_width * m_cellSize, m_wallWidth, m_wallColor);
+}
+
+void MazeRasterizer::DrawRows(int firstRow, int rowCount, byte* pRows, size_t stride) const
+{
+	size_t rowBytes = (size_t)m_imageWidth * m_channels;
+	std::vector<byte> wallLine(rowBytes);
+	std::vector<byte> floorRow(rowBytes);
+	int builtWallLine = -1;
+	int builtFloorRow = -1;
+	const byte* pCells = m_pMaze->GetData();
+
+	for (int i = 0; i < rowCount; i++)
+	{
+		// Distance from the bottom of the image: cell row, then how far up inside it
+		int fromBottom = m_imageHeight - 1 - (firstRow + i);
+		int y = fromBottom / m_cellSize;
+		int inside = fromBottom % m_cellSize;
+		const byte* pSource;
+		if (inside < m_wallWidth)
+		{
+			if (builtWallLine != y)
+			{
+				// Row y is above the line and y - 1 below it
+				const byte* pAbove = y < m_height ? pCells + m_pMaze->GetIndex(0, y) : nullptr;
+				const byte* pBelow = y > 0 ? pCells + m_pMaze->GetIndex(0, y - 1) : nullptr;
+				BuildWallLine(pAbove, pBelow, wallLine.data());
+				builtWallLine = y;
+			}
+			pSource = wallLine.data();
+		}
+		else
+		{
+			if (builtFloorRow != y)
+			{
+				BuildFloorRow(pCells + m_pMaze->GetIndex(0, y), floorRow.data());
+				builtFloorRow = y;
+			}
+			pSource = floorRow.data();
+		}
+		memcpy(pRows + stride * i, pSource, rowBytes);
+	}
+}
+
+void MazeRasterizer::DrawRows(int firstRow, int rowCount, byte* pRows, size_t stride, ThreadPool& pool) const
+{
+	size_t bands = ((size_t)rowCount + RASTER_BAND_ROWS - 1) / RASTER_BAND_ROWS;
+	pool.ParallelFor(bands, 1, [&](size_t begin, size_t end)
+		{
+			for (size_t band = begin; band < end; band++)
+			{
+				int row = (int)band * RASTER_BAND_ROWS;
+				int count = std::min(RASTER_BAND_ROWS, rowCount - row);
+				DrawRows(firstRow + row, count, pRows + stride * row, stride);
+			}
+		});
+}
+
+void MazeRasterizer::DrawTopEdge(byte* pRows, size_t stride) const
+{
+	size_t rowBytes = (size_t)m_imageWidth * m_channels;
+	BuildWallLine(nullptr, nullptr, pRows);
+	for (int i = 1; i < m_wallWidth; i++)
+	{
+		memcpy(pRows + stride * i, pRows, rowBytes);
+	}
+}
+
+void MazeRasterizer::DrawCellRow(const byte* pCells, const byte* pBelow, byte* pRows, size_t stride) const
+{
+	size_t rowBytes = (size_t)m_imageWidth * m_channels;
+	int floorRows = m_cellSize - m_wallWidth;
+	BuildFloorRow(pCells, pRows);
+	for (int i = 1; i < floorRows; i++)
+	{
+		memcpy(pRows + stride * i, pRows, rowBytes);
+	}
+	byte* pWallLine = pRows + stride * floorRows;
+	BuildWallLine(pCells, pBelow, pWallLine);
+	for (int i = 1; i < m_wallWidth; i++)
+	{
+		memcpy(pWallLine + stride * i, pWallLine, rowBytes);
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "Maze.h"
+#include "ThreadPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Draws a maze into a greyscale or RGBA bitmap on the CPU, for exporting images where there is no
+// GL. Every cell is cellSize pixels square, and walls are wallWidth-pixel lines along the cell
+// edges, so the image is width * cellSize + wallWidth pixels wide and likewise high, the top row
+// first. Floors take the cell state colours of the game; in greyscale they are white, with walls
+// black.
+//
+// Walls are axis-aligned, so a cell row of the image holds only two distinct pixel rows: the wall
+// line along its bottom edge and the floor rows above it. Each is built once as a few long runs of
+// one colour, filled with SSE2 or AVX2 stores, and the image rows are copies of them. Drawing is
+// bound by memory bandwidth, and bands of rows can be drawn on separate threads.
+//
+// A maze too big to hold can be drawn as its rows of cells are generated (EllerMazeGenerator),
+// from the top down: DrawTopEdge, then DrawCellRow for each row of cells in turn.
+class MazeRasterizer
+{
+private:
+	const Maze* m_pMaze;
+	int m_width;
+	int m_height;
+	int m_cellSize;
+	int m_wallWidth;
+	int m_channels;
+	int m_imageWidth;
+	int m_imageHeight;
+	uint32_t m_floorColors[4]; // By cell state, CELL_STATE_MASK >> 4
+	uint32_t m_wallColor;
+
+	uint32_t GetFloorColor(byte cell) const
+	{
+		return m_floorColors[(cell & CELL_STATE_MASK) >> 4];
+	}
+
+	void BuildWallLine(const byte* pAbove, const byte* pBelow, byte* pRow) const;
+	void BuildFloorRow(const byte* pCells, byte* pRow) const;
+public:
+	// channels is 1 (greyscale) or 4 (RGBA); cellSize must be larger than wallWidth
+	MazeRasterizer(const Maze& maze, int cellSize, int wallWidth, int channels);
+
+	// For a width x height maze drawn row by row with DrawCellRow; DrawRows needs a Maze
+	MazeRasterizer(int width, int height, int cellSize, int wallWidth, int channels);
+
+	int GetImageWidth() const
+	{
+		return m_imageWidth;
+	}
+
+	int GetImageHeight() const
+	{
+		return m_imageHeight;
+	}
+
+	int GetChannels() const
+	{
+		return m_channels;
+	}
+
+	// Draws image rows [firstRow, firstRow + rowCount) into pRows, each row stride bytes after the
+	// one before
+	void DrawRows(int firstRow, int rowCount, byte* pRows, size_t stride) const;
+
+	// Same, split into bands drawn on the pool
+	void DrawRows(int firstRow, int rowCount, byte* pRows, size_t stride, ThreadPool& pool) const;
+
+	// The wallWidth image rows along the top edge of the maze
+	void DrawTopEdge(byte* pRows, size_t stride) const;
+
+	// The cellSize image rows of the row of cells pCells: its floor, then the wall line between it
+	// and the row below, pBelow, which is nullptr for the bottom row
+	void DrawCellRow(const byte* pCells, const byte* pBelow, byte* pRows, size_t stride) const;
+};
@@ -0,0 +1,105 @@
+#include "MazeSerializer.h"
+
+static const byte MAZE_MAGIC[4] = { 'R', 'B', 'T', 'M' };
+static const byte MAZE_VERSION = 1;
+
+static void PutU32(byte* p, uint32_t value)
+{
+	p[0] = (byte)value;
+	p[1] = (byte)(value >> 8);
+	p[2] = (byte)(value >> 16);
+	p[3] = (byte)(value >> 24);
+}
+
+static uint32_t GetU32(const byte* p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void MazeSerializer::Write(const Maze& maze, std::vector<byte>& out)
+{
+	const int64_t cellCount = maze.GetCellCount();
+	const byte* cells = maze.GetData();
+	size_t begin = out.size();
+	out.resize(begin + GetSerializedSize(maze.GetWidth(), maze.GetHeight()));
+
+	byte* p = &out[begin];
+	for (int i = 0; i < 4; i++)
+	{
+		p[i] = MAZE_MAGIC[i];
+	}
+	p[4] = MAZE_VERSION;
+	PutU32(p + 5, maze.GetWidth());
+	PutU32(p + 9, maze.GetHeight());
+	p += HEADER_SIZE;
+
+	// WALL_UP is bit 0 already; WALL_RIGHT moves from bit 3 to bit 1
+	int64_t i = 0;
+	for (; i + 4 <= cellCount; i += 4)
+	{
+		byte packed = 0U;
+		for (int j = 0; j < 4; j++)
+		{
+			byte cell = cells[i + j];
+			packed |= ((cell & WALL_UP) | ((cell & WALL_RIGHT) >> 2)) << (j * 2);
+		}
+		*p++ = packed;
+	}
+	if (i < cellCount)
+	{
+		byte packed = 0U;
+		for (int j = 0; i + j < cellCount; j++)
+		{
+			byte cell = cells[i + j];
+			packed |= ((cell & WALL_UP) | ((cell & WALL_RIGHT) >> 2)) << (j * 2);
+		}
+		*p++ = packed;
+	}
+}
+
+bool MazeSerializer::ReadSize(const byte* data, size_t size, int& width, int& height)
+{
+	if (size < HEADER_SIZE)
+		return false;
+	for (int i = 0; i < 4; i++)
+	{
+		if (data[i] != MAZE_MAGIC[i])
+			return false;
+	}
+	if (data[4] != MAZE_VERSION)
+		return false;
+	uint32_t w = GetU32(data + 5);
+	uint32_t h = GetU32(data + 9);
+	if (w == 0 or h == 0 or w > 0x7fffffff or h > 0x7fffffff)
+		return false;
+	width = (int)w;
+	height = (int)h;
+	return size >= GetSerializedSize(width, height);
+}
+
+bool MazeSerializer::Read(const byte* data, size_t size, Maze& maze)
+{
+	int width, height;
+	if (!ReadSize(data, size, width, height) or width != maze.GetWidth() or height != maze.GetHeight())
+		return false;
+
+	const byte* p = data + HEADER_SIZE;
+	for (int y = 0; y < height; y++)
+	{
+		int64_t row = (int64_t)y * width;
+		for (int x = 0; x < width; x++)
+		{
+			int64_t index = row + x;
+			byte bits = (p[index >> 2] >> ((index & 3) * 2)) & 0x03;
+			byte cell = (bits & 0x01) | ((bits & 0x02) << 2);
+
+			// Down and left come from the neighbours, which were read already
+			if (y == 0 or (maze.GetWalls(index - width) & WALL_UP))
+				cell |= WALL_DOWN;
+			if (x == 0 or (maze.GetWalls(index - 1) & WALL_RIGHT))
+				cell |= WALL_LEFT;
+			maze.SetCell(index, cell);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "Maze.h"
+#include <cstdint>
+#include <vector>
+
+// Compact on-disk/on-wire form of a finished maze. Only walls are kept, and only two per cell
+// (up and right): every down wall is the up wall of the cell below and every left wall the right
+// wall of the cell to the left, and the border is always closed. Generation states are not stored.
+//
+// Layout (little-endian): "RBTM" u8 version, u32 width, u32 height, then four cells per byte,
+// row-major, bit 0 = up and bit 1 = right of the first cell.
+class MazeSerializer
+{
+public:
+	static const size_t HEADER_SIZE = 13;
+
+	static size_t GetSerializedSize(int width, int height)
+	{
+		return HEADER_SIZE + ((size_t)width * height + 3) / 4;
+	}
+
+	static void Write(const Maze& maze, std::vector<byte>& out);
+
+	// Reads just the header; false if it isn't a serialized maze
+	static bool ReadSize(const byte* data, size_t size, int& width, int& height);
+
+	// maze must already have the serialized width and height
+	static bool Read(const byte* data, size_t size, Maze& maze);
+};
@@ -0,0 +1,87 @@
+#include "MazeSolver.h"
+#include <algorithm>
+
+// Marks the start cell, which has no direction to come from
+static const byte CAME_FROM_START = 0x10;
+
+MazeSolver::MazeSolver()
+	:m_cameFrom(), m_frontier(), m_nextFrontier(), m_path(), m_visitedCount(0)
+{
+}
+
+bool MazeSolver::Solve(const Maze& maze, int64_t start, int64_t goal)
+{
+	const int width = maze.GetWidth();
+	m_cameFrom.assign((size_t)maze.GetCellCount(), 0U);
+	m_frontier.clear();
+	m_nextFrontier.clear();
+	m_path.clear();
+
+	m_cameFrom[start] = CAME_FROM_START;
+	m_frontier.push_back(start);
+	m_visitedCount = 1;
+
+	// One level at a time; a maze frontier stays small, unlike a queue of every cell ever reached
+	bool found = start == goal;
+	while (!found and !m_frontier.empty())
+	{
+		for (int64_t current : m_frontier)
+		{
+			byte open = ~maze.GetWalls(current) & WALL_ALL;
+			if ((open & WALL_UP) and m_cameFrom[current + width] == 0U)
+			{
+				m_cameFrom[current + width] = WALL_DOWN;
+				m_nextFrontier.push_back(current + width);
+			}
+			if ((open & WALL_DOWN) and m_cameFrom[current - width] == 0U)
+			{
+				m_cameFrom[current - width] = WALL_UP;
+				m_nextFrontier.push_back(current - width);
+			}
+			if ((open & WALL_LEFT) and m_cameFrom[current - 1] == 0U)
+			{
+				m_cameFrom[current - 1] = WALL_RIGHT;
+				m_nextFrontier.push_back(current - 1);
+			}
+			if ((open & WALL_RIGHT) and m_cameFrom[current + 1] == 0U)
+			{
+				m_cameFrom[current + 1] = WALL_LEFT;
+				m_nextFrontier.push_back(current + 1);
+			}
+		}
+		m_visitedCount += (int64_t)m_nextFrontier.size();
+		m_frontier.swap(m_nextFrontier);
+		m_nextFrontier.clear();
+		found = m_cameFrom[goal] != 0U;
+	}
+	if (!found)
+		return false;
+
+	// Walk back from the goal, then flip the path around
+	for (int64_t current = goal; ; )
+	{
+		m_path.push_back(current);
+		switch (m_cameFrom[current])
+		{
+		case WALL_UP:
+			current += width;
+			break;
+		case WALL_DOWN:
+			current -= width;
+			break;
+		case WALL_LEFT:
+			current -= 1;
+			break;
+		case WALL_RIGHT:
+			current += 1;
+			break;
+		default:
+			current = -1;
+			break;
+		}
+		if (current == -1)
+			break;
+	}
+	std::reverse(m_path.begin(), m_path.end());
+	return true;
+}
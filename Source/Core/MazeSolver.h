@@ -0,0 +1,32 @@
+#pragma once
+#include "Maze.h"
+#include <vector>
+
+// Breadth-first shortest path between two cells. Buffers are kept between calls, so solving
+// many mazes of the same size allocates nothing after the first one.
+class MazeSolver
+{
+private:
+	std::vector<byte> m_cameFrom; // WALL_* direction each reached cell was entered from, 0 if unreached
+	std::vector<int64_t> m_frontier;
+	std::vector<int64_t> m_nextFrontier;
+	std::vector<int64_t> m_path;
+	int64_t m_visitedCount;
+public:
+	MazeSolver();
+
+	// Returns false if goal can't be reached from start
+	bool Solve(const Maze& maze, int64_t start, int64_t goal);
+
+	// Cells from start to goal, both included
+	const std::vector<int64_t>& GetPath() const
+	{
+		return m_path;
+	}
+
+	// Cells the last search reached before finding the goal
+	int64_t GetVisitedCount() const
+	{
+		return m_visitedCount;
+	}
+};
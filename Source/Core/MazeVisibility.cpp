@@ -0,0 +1,155 @@
+#include "MazeVisibility.h"
+
+// Line sets that shrink to a point still count; lines through a corner of two walls see past it
+#define CLIP_EPSILON 1e-9
+
+static void WriteNumber(std::vector<byte>& data, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		data.push_back((byte)(value | 0x80));
+		value >>= 7;
+	}
+	data.push_back((byte)value);
+}
+
+MazeVisibility::MazeVisibility()
+	:m_width(0), m_height(0), m_range(0), m_offsets(), m_runs(), m_sourceX(0), m_sourceY(0), m_signX(1), m_signY(1), m_swapped(false),
+	m_stepU(0), m_stepV(0), m_polygons(), m_visible()
+{
+}
+
+// Clips the polygon at [begin, end) of m_polygons to a m + b q + c >= 0. A polygon that loses
+// vertices is appended and the range moved to it. Returns false if nothing is left.
+bool MazeVisibility::Clip(size_t& begin, size_t& end, double a, double b, double c)
+{
+	size_t inside = 0;
+	for (size_t i = begin; i < end; i++)
+	{
+		inside += a * m_polygons[i].m + b * m_polygons[i].q + c >= -CLIP_EPSILON;
+	}
+	if (inside == end - begin)
+		return true;
+	if (inside == 0)
+		return false;
+
+	size_t start = m_polygons.size();
+	for (size_t i = begin; i < end; i++)
+	{
+		Line current = m_polygons[i];
+		Line next = m_polygons[i + 1 < end ? i + 1 : begin];
+		double currentSide = a * current.m + b * current.q + c;
+		double nextSide = a * next.m + b * next.q + c;
+		if (currentSide >= -CLIP_EPSILON)
+			m_polygons.push_back(current);
+		if ((currentSide >= -CLIP_EPSILON) != (nextSide >= -CLIP_EPSILON))
+		{
+			double t = currentSide / (currentSide - nextSide);
+			m_polygons.push_back(Line{ current.m + (next.m - current.m) * t, current.q + (next.q - current.q) * t });
+		}
+	}
+	begin = start;
+	end = m_polygons.size();
+	return true;
+}
+
+// Cell (u, v) of the current frame, whose lines are at [begin, end) of m_polygons. The source cell
+// is [0, 1] x [0, 1] and the frame only steps towards +u and +v.
+void MazeVisibility::Walk(const Maze& maze, int u, int v, size_t begin, size_t end)
+{
+	int x = m_sourceX + m_signX * (m_swapped ? v : u);
+	int y = m_sourceY + m_signY * (m_swapped ? u : v);
+	int64_t index = maze.GetIndex(x, y);
+	m_visible.push_back(index);
+	byte walls = maze.GetWalls(index);
+	size_t top = m_polygons.size();
+
+	// Through the opening at u + 1, between v and v + 1
+	size_t first = begin;
+	size_t last = end;
+	if ((walls & m_stepU) == 0 and u < m_range and Clip(first, last, u + 1.0, 1.0, -v) and Clip(first, last, -(u + 1.0), -1.0, v + 1.0))
+		Walk(maze, u + 1, v, first, last);
+	m_polygons.resize(top);
+
+	// Through the opening at v + 1, between u and u + 1
+	first = begin;
+	last = end;
+	if ((walls & m_stepV) == 0 and v < m_range and Clip(first, last, -u, -1.0, v + 1.0) and Clip(first, last, u + 1.0, 1.0, -(v + 1.0)))
+		Walk(maze, u, v + 1, first, last);
+	m_polygons.resize(top);
+}
+
+void MazeVisibility::Encode(int64_t cell)
+{
+	std::sort(m_visible.begin(), m_visible.end());
+	m_visible.erase(std::unique(m_visible.begin(), m_visible.end()), m_visible.end());
+
+	int64_t first = m_visible[0] - cell;
+	WriteNumber(m_runs, first < 0 ? ((uint64_t)(-first - 1) << 1) | 1 : (uint64_t)first << 1);
+
+	size_t runs = 1;
+	for (size_t i = 1; i < m_visible.size(); i++)
+	{
+		runs += m_visible[i] != m_visible[i - 1] + 1;
+	}
+	WriteNumber(m_runs, runs);
+
+	size_t runStart = 0;
+	for (size_t i = 1; i <= m_visible.size(); i++)
+	{
+		if (i == m_visible.size() or m_visible[i] != m_visible[i - 1] + 1)
+		{
+			WriteNumber(m_runs, i - runStart);
+			if (i < m_visible.size())
+				WriteNumber(m_runs, (uint64_t)(m_visible[i] - m_visible[i - 1] - 1));
+			runStart = i;
+		}
+	}
+}
+
+void MazeVisibility::Build(const Maze& maze, int range)
+{
+	m_width = maze.GetWidth();
+	m_height = maze.GetHeight();
+	m_range = range;
+	m_offsets.assign((size_t)maze.GetCellCount() + 1, 0);
+	m_runs.clear();
+
+	// Both quadrant signs, then x and y swapped for the lines steeper than 45 degrees
+	const int frames[8][3] = {
+		{ 1, 1, 0 }, { -1, 1, 0 }, { 1, -1, 0 }, { -1, -1, 0 },
+		{ 1, 1, 1 }, { -1, 1, 1 }, { 1, -1, 1 }, { -1, -1, 1 }
+	};
+
+	for (int y = 0; y < m_height; y++)
+	{
+		for (int x = 0; x < m_width; x++)
+		{
+			int64_t cell = maze.GetIndex(x, y);
+			m_offsets[cell] = (int64_t)m_runs.size();
+			m_sourceX = x;
+			m_sourceY = y;
+			m_visible.clear();
+			for (const int* frame : frames)
+			{
+				m_signX = frame[0];
+				m_signY = frame[1];
+				m_swapped = frame[2] != 0;
+				byte stepX = m_signX > 0 ? WALL_RIGHT : WALL_LEFT;
+				byte stepY = m_signY > 0 ? WALL_UP : WALL_DOWN;
+				m_stepU = m_swapped ? stepY : stepX;
+				m_stepV = m_swapped ? stepX : stepY;
+
+				// Lines through the source cell have 0 <= m <= 1 and -1 <= q <= 1
+				m_polygons.clear();
+				m_polygons.push_back(Line{ 0.0, -1.0 });
+				m_polygons.push_back(Line{ 1.0, -1.0 });
+				m_polygons.push_back(Line{ 1.0, 1.0 });
+				m_polygons.push_back(Line{ 0.0, 1.0 });
+				Walk(maze, 0, 0, 0, 4);
+			}
+			Encode(cell);
+		}
+	}
+	m_offsets.back() = (int64_t)m_runs.size();
+}
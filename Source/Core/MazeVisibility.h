@@ -0,0 +1,109 @@
+#pragma once
+#include "Maze.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Potentially visible set of every cell of a maze: the cells a line of sight can reach from
+// anywhere inside the cell through open walls, up to a given distance.
+//
+// Built by portal traversal. A straight line crosses cells in a staircase that only ever steps
+// one way in x and one way in y, so each cell is walked from once per quadrant, and once more with
+// x and y swapped, keeping the lines y = m x + q (0 <= m <= 1 in that frame) that pass through every
+// opening crossed so far. Those lines form a convex polygon in (m, q); each opening clips it by
+// two half-planes and the walk stops where it empties. In a maze that is a few straight corridor
+// runs and the first cells round their corners. Walls count as infinitely thin, so the sets err on
+// the visible side.
+//
+// Each set is stored as a run-length coded bitset over the row-major cell indices: the offset of
+// the first visible cell from the cell itself, the number of visible runs, then the lengths of
+// the visible and hidden runs in turn, all as variable-length integers. A backtracker maze's cell
+// sees around 11 cells, itself included, and takes 13 to 17 bytes.
+class MazeVisibility
+{
+private:
+	struct Line
+	{
+		double m;
+		double q;
+	};
+
+	int m_width;
+	int m_height;
+	int m_range;
+	std::vector<int64_t> m_offsets; // Start of each cell's runs in m_runs, plus the end
+	std::vector<byte> m_runs;
+
+	// Scratch for the walk from one cell
+	int m_sourceX;
+	int m_sourceY;
+	int m_signX;
+	int m_signY;
+	bool m_swapped;
+	byte m_stepU;
+	byte m_stepV;
+	std::vector<Line> m_polygons;   // Stack of the line sets along the current staircase
+	std::vector<int64_t> m_visible;
+
+	void Walk(const Maze& maze, int u, int v, size_t begin, size_t end);
+	bool Clip(size_t& begin, size_t& end, double a, double b, double c);
+	void Encode(int64_t cell);
+
+	static uint64_t ReadNumber(const byte*& pData)
+	{
+		uint64_t value = 0;
+		int shift = 0;
+		while (*pData & 0x80)
+		{
+			value |= (uint64_t)(*pData++ & 0x7f) << shift;
+			shift += 7;
+		}
+		return value | ((uint64_t)*pData++ << shift);
+	}
+public:
+	MazeVisibility();
+
+	// range caps how many cells away, along x or y, a visible cell may be
+	void Build(const Maze& maze, int range);
+
+	bool IsBuilt() const
+	{
+		return !m_offsets.empty();
+	}
+
+	int GetRange() const
+	{
+		return m_range;
+	}
+
+	// Size of the coded sets
+	int64_t GetByteCount() const
+	{
+		return (int64_t)m_runs.size();
+	}
+
+	// Calls f(start, length) for each run of cells visible from cell, in row-major order. Runs
+	// never span two rows.
+	template <typename F>
+	void ForEachRun(int64_t cell, F f) const
+	{
+		const byte* pData = m_runs.data() + m_offsets[cell];
+		uint64_t first = ReadNumber(pData);
+		int64_t start = cell + ((first & 1) ? -(int64_t)(first >> 1) - 1 : (int64_t)(first >> 1));
+		uint64_t runs = ReadNumber(pData);
+		for (uint64_t run = 0; run < runs; run++)
+		{
+			int64_t length = (int64_t)ReadNumber(pData);
+			while (length > 0)
+			{
+				int64_t rowEnd = (start / m_width + 1) * m_width;
+				int64_t count = std::min(length, rowEnd - start);
+				f(start, count);
+				start += count;
+				length -= count;
+			}
+			if (run + 1 < runs)
+				start += (int64_t)ReadNumber(pData);
+		}
+	}
+};
@@ -0,0 +1,221 @@
+#include "MazeWorld.h"
+#include "RandomMazeGenerator.h"
+
+static const uint32_t SIGN_FLIP = 0x80000000U;
+static const uint32_t SPAWN_CHUNK = 0x55555555U; // Unsigned; alternating bits sit mid-block at every level
+static const uint64_t CHUNK_SALT = 0x43484E4BULL;
+static const uint64_t DOOR_SALT = 0x444F4F52ULL;
+
+static uint64_t Mix(uint64_t value)
+{
+	value ^= value >> 30;
+	value *= 0xBF58476D1CE4E5B9ULL;
+	value ^= value >> 27;
+	value *= 0x94D049BB133111EBULL;
+	return value ^ (value >> 31);
+}
+
+static uint64_t Hash(uint64_t a, uint64_t b, uint64_t c, uint64_t d)
+{
+	uint64_t hash = Mix(a + 0x9E3779B97F4A7C15ULL);
+	hash = Mix(hash ^ b);
+	hash = Mix(hash ^ c);
+	return Mix(hash ^ d);
+}
+
+static int CountTrailingOnes(uint32_t value)
+{
+	int count = 0;
+	while (value & 1)
+	{
+		value >>= 1;
+		count++;
+	}
+	return count;
+}
+
+static int64_t FloorDivide(int64_t value, int64_t divisor)
+{
+	int64_t quotient = value / divisor;
+	return quotient * divisor > value ? quotient - 1 : quotient;
+}
+
+MazeWorld::MazeWorld(uint64_t seed, int chunkSize, int keepRadius)
+	:m_seed(seed), m_chunkSize(chunkSize), m_keepRadius(keepRadius < 1 ? 1 : keepRadius), m_chunks(), m_spareMazes(), m_generatedCount(0),
+	m_lastX(0), m_lastY(0), m_pLast(nullptr)
+{
+}
+
+uint64_t MazeWorld::MakeKey(int32_t chunkX, int32_t chunkY)
+{
+	return ((uint64_t)(uint32_t)chunkX << 32) | (uint32_t)chunkY;
+}
+
+// Border edge of the 2x2 block (blockX, blockY) at level: 0 and 1 join the lower and upper pair
+// of children left to right, 2 and 3 the left and right pair bottom to top. One of the four is
+// left closed; the others get a door on the chunk border whose position along them matches.
+bool MazeWorld::HasDoor(int level, uint64_t blockX, uint64_t blockY, int edge, uint32_t along, int& offset) const
+{
+	uint64_t blockHash = Hash(m_seed, DOOR_SALT + level, blockX, blockY);
+	if ((int)(blockHash & 3) == edge)
+		return false;
+
+	uint64_t doorHash = Mix(blockHash ^ (uint64_t)edge);
+	uint32_t span = 1U << (level - 1);
+	if ((along & (span - 1)) != (uint32_t)(doorHash % span))
+		return false;
+	offset = (int)((doorHash >> 32) % (uint64_t)m_chunkSize);
+	return true;
+}
+
+bool MazeWorld::HasEastDoor(int32_t chunkX, int32_t chunkY, int& offset) const
+{
+	// Unsigned coordinates put the origin mid-world, so the hierarchy has a single top block
+	uint32_t u = (uint32_t)chunkX ^ SIGN_FLIP;
+	uint32_t v = (uint32_t)chunkY ^ SIGN_FLIP;
+	if (u == UINT32_MAX)
+		return false;
+
+	// The lowest level whose blocks hold both chunks: u ends in level - 1 ones, u + 1 in zeros
+	int level = CountTrailingOnes(u) + 1;
+	int edge = (int)((v >> (level - 1)) & 1);
+	return HasDoor(level, (uint64_t)u >> level, (uint64_t)v >> level, edge, v, offset);
+}
+
+bool MazeWorld::HasNorthDoor(int32_t chunkX, int32_t chunkY, int& offset) const
+{
+	uint32_t u = (uint32_t)chunkX ^ SIGN_FLIP;
+	uint32_t v = (uint32_t)chunkY ^ SIGN_FLIP;
+	if (v == UINT32_MAX)
+		return false;
+
+	int level = CountTrailingOnes(v) + 1;
+	int edge = 2 + (int)((u >> (level - 1)) & 1);
+	return HasDoor(level, (uint64_t)u >> level, (uint64_t)v >> level, edge, u, offset);
+}
+
+void MazeWorld::Generate(int32_t chunkX, int32_t chunkY, Maze& maze) const
+{
+	maze.Reset();
+	RandomMazeGenerator generator(maze, Hash(m_seed, CHUNK_SALT, (uint32_t)chunkX, (uint32_t)chunkY));
+	generator.Generate();
+
+	int last = m_chunkSize - 1;
+	int offset;
+	if (HasEastDoor(chunkX, chunkY, offset))
+		maze.RemoveWalls(maze.GetIndex(last, offset), WALL_RIGHT);
+	if (chunkX != INT32_MIN and HasEastDoor(chunkX - 1, chunkY, offset))
+		maze.RemoveWalls(maze.GetIndex(0, offset), WALL_LEFT);
+	if (HasNorthDoor(chunkX, chunkY, offset))
+		maze.RemoveWalls(maze.GetIndex(offset, last), WALL_UP);
+	if (chunkY != INT32_MIN and HasNorthDoor(chunkX, chunkY - 1, offset))
+		maze.RemoveWalls(maze.GetIndex(offset, 0), WALL_DOWN);
+}
+
+const Maze& MazeWorld::GetChunk(int32_t chunkX, int32_t chunkY)
+{
+	if (m_pLast != nullptr and chunkX == m_lastX and chunkY == m_lastY)
+		return *m_pLast;
+
+	uint64_t key = MakeKey(chunkX, chunkY);
+	std::unordered_map<uint64_t, Maze>::iterator it = m_chunks.find(key);
+	if (it == m_chunks.end())
+	{
+		if (m_spareMazes.empty())
+		{
+			it = m_chunks.emplace(key, Maze(m_chunkSize, m_chunkSize)).first;
+		}
+		else
+		{
+			it = m_chunks.emplace(key, std::move(m_spareMazes.back())).first;
+			m_spareMazes.pop_back();
+		}
+		Generate(chunkX, chunkY, it->second);
+		m_generatedCount++;
+	}
+	m_lastX = chunkX;
+	m_lastY = chunkY;
+	m_pLast = &it->second;
+	return it->second;
+}
+
+void MazeWorld::GetChunkPosition(int64_t x, int64_t y, int32_t& chunkX, int32_t& chunkY) const
+{
+	chunkX = (int32_t)FloorDivide(x, m_chunkSize);
+	chunkY = (int32_t)FloorDivide(y, m_chunkSize);
+}
+
+void MazeWorld::GetSpawn(int64_t& x, int64_t& y) const
+{
+	int64_t chunk = (int32_t)(SPAWN_CHUNK ^ SIGN_FLIP);
+	x = chunk * m_chunkSize + m_chunkSize / 2;
+	y = x;
+}
+
+byte MazeWorld::GetWalls(int64_t x, int64_t y)
+{
+	int32_t chunkX, chunkY;
+	GetChunkPosition(x, y, chunkX, chunkY);
+	const Maze& chunk = GetChunk(chunkX, chunkY);
+	return chunk.GetWalls((int)(x - (int64_t)chunkX * m_chunkSize), (int)(y - (int64_t)chunkY * m_chunkSize));
+}
+
+void MazeWorld::CopyRegion(int64_t left, int64_t bottom, Maze& out)
+{
+	// A chunk at a time, each one copied row by row
+	for (int y = 0; y < out.GetHeight();)
+	{
+		int32_t chunkX, chunkY;
+		GetChunkPosition(left, bottom + y, chunkX, chunkY);
+		int localY = (int)(bottom + y - (int64_t)chunkY * m_chunkSize);
+		int rows = m_chunkSize - localY < out.GetHeight() - y ? m_chunkSize - localY : out.GetHeight() - y;
+		for (int x = 0; x < out.GetWidth();)
+		{
+			GetChunkPosition(left + x, bottom + y, chunkX, chunkY);
+			const Maze& chunk = GetChunk(chunkX, chunkY);
+			int localX = (int)(left + x - (int64_t)chunkX * m_chunkSize);
+			int columns = m_chunkSize - localX < out.GetWidth() - x ? m_chunkSize - localX : out.GetWidth() - x;
+			for (int row = 0; row < rows; row++)
+			{
+				for (int column = 0; column < columns; column++)
+				{
+					out.SetCell(out.GetIndex(x + column, y + row), chunk.GetCell(chunk.GetIndex(localX + column, localY + row)));
+				}
+			}
+			x += columns;
+		}
+		y += rows;
+	}
+}
+
+void MazeWorld::Update(int64_t x, int64_t y)
+{
+	int32_t centerX, centerY;
+	GetChunkPosition(x, y, centerX, centerY);
+
+	for (std::unordered_map<uint64_t, Maze>::iterator it = m_chunks.begin(); it != m_chunks.end();)
+	{
+		int64_t chunkX = (int32_t)(it->first >> 32);
+		int64_t chunkY = (int32_t)(uint32_t)it->first;
+		if (chunkX < centerX - m_keepRadius or chunkX > centerX + m_keepRadius or chunkY < centerY - m_keepRadius or chunkY > centerY + m_keepRadius)
+		{
+			if (m_pLast == &it->second)
+				m_pLast = nullptr;
+			m_spareMazes.push_back(std::move(it->second));
+			it = m_chunks.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	for (int64_t chunkY = centerY - 1; chunkY <= centerY + 1; chunkY++)
+	{
+		for (int64_t chunkX = centerX - 1; chunkX <= centerX + 1; chunkX++)
+		{
+			if (chunkX >= INT32_MIN and chunkX <= INT32_MAX and chunkY >= INT32_MIN and chunkY <= INT32_MAX)
+				GetChunk((int32_t)chunkX, (int32_t)chunkY);
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "Maze.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Endless maze made of square chunks, each generated on first use from the world seed and its
+// coordinates alone, and dropped again once the player is far away. Coming back regenerates the
+// same chunk, so memory follows the chunks around the player, not the size of the world.
+//
+// Inside a chunk the maze is a RandomMazeGenerator maze. Chunks are joined through single doors
+// picked by a hierarchy: at level L, 2x2 blocks of level L-1 (a block of level 0 is a chunk) are
+// connected by doors on three of the four borders between them, and each of those borders gets
+// one door. That makes the whole world one perfect maze, and whether a chunk border has a door
+// only depends on the border itself, never on which chunks were generated first.
+//
+// Chunk coordinates are 32-bit: the world is 2^32 chunks across, and closed at its edges.
+class MazeWorld
+{
+private:
+	uint64_t m_seed;
+	int m_chunkSize;
+	int m_keepRadius;
+	std::unordered_map<uint64_t, Maze> m_chunks; // Keyed by MakeKey()
+	std::vector<Maze> m_spareMazes;               // Evicted chunks, reused for the next ones
+	uint64_t m_generatedCount;
+
+	// The chunk asked for last, which is nearly always the next one asked for
+	int32_t m_lastX;
+	int32_t m_lastY;
+	const Maze* m_pLast;
+
+	static uint64_t MakeKey(int32_t chunkX, int32_t chunkY);
+	bool HasDoor(int level, uint64_t blockX, uint64_t blockY, int edge, uint32_t along, int& offset) const;
+	void Generate(int32_t chunkX, int32_t chunkY, Maze& maze) const;
+public:
+	// Chunks more than keepRadius chunks (at least 1) from the player are dropped by Update()
+	MazeWorld(uint64_t seed, int chunkSize = 32, int keepRadius = 2);
+
+	// Border between chunk (chunkX, chunkY) and the chunk to its right/above. offset is the row or
+	// column of the door within the chunk.
+	bool HasEastDoor(int32_t chunkX, int32_t chunkY, int& offset) const;
+	bool HasNorthDoor(int32_t chunkX, int32_t chunkY, int& offset) const;
+
+	const Maze& GetChunk(int32_t chunkX, int32_t chunkY);
+
+	byte GetWalls(int64_t x, int64_t y);
+
+	// Copies the walls of out's width x height cells starting at (left, bottom) into out
+	void CopyRegion(int64_t left, int64_t bottom, Maze& out);
+
+	// Generates the chunks next to the one holding (x, y) ahead of time and drops the far ones
+	void Update(int64_t x, int64_t y);
+
+	void GetChunkPosition(int64_t x, int64_t y, int32_t& chunkX, int32_t& chunkY) const;
+
+	// Where a player should start: the middle of a chunk as far as possible from the borders of
+	// big blocks, which have only one door each
+	void GetSpawn(int64_t& x, int64_t& y) const;
+
+	int GetChunkSize() const
+	{
+		return m_chunkSize;
+	}
+
+	size_t GetLoadedCount() const
+	{
+		return m_chunks.size();
+	}
+
+	// Chunks generated so far, counting the ones generated again after being dropped
+	uint64_t GetGeneratedCount() const
+	{
+		return m_generatedCount;
+	}
+};
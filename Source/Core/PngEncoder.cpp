@@ -0,0 +1,99 @@
+#include "PngEncoder.h"
+#include <cstring>
+
+#define PNG_FILTER_UP 2
+
+static const byte PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+static void PutU32(std::vector<byte>& data, uint32_t value)
+{
+	data.push_back((byte)(value >> 24));
+	data.push_back((byte)(value >> 16));
+	data.push_back((byte)(value >> 8));
+	data.push_back((byte)value);
+}
+
+// Length, type and data are already in png from start on; adds the length and the CRC
+static void FinishChunk(std::vector<byte>& png, size_t start)
+{
+	uint32_t length = (uint32_t)(png.size() - start - 8);
+	png[start] = (byte)(length >> 24);
+	png[start + 1] = (byte)(length >> 16);
+	png[start + 2] = (byte)(length >> 8);
+	png[start + 3] = (byte)length;
+	uLong crc = crc32(0L, png.data() + start + 4, (uInt)(length + 4));
+	PutU32(png, (uint32_t)crc);
+}
+
+static size_t BeginChunk(std::vector<byte>& png, const char* type)
+{
+	size_t start = png.size();
+	PutU32(png, 0);
+	png.insert(png.end(), type, type + 4);
+	return start;
+}
+
+PngEncoder::PngEncoder(int level)
+	:m_stream(), m_filtered(), m_ready(false)
+{
+	m_ready = deflateInit(&m_stream, level) == Z_OK;
+}
+
+PngEncoder::~PngEncoder()
+{
+	if (m_ready)
+		deflateEnd(&m_stream);
+}
+
+bool PngEncoder::Encode(const byte* pTopRow, int width, int height, int channels, ptrdiff_t stride, std::vector<byte>& png)
+{
+	if (!m_ready or width <= 0 or height <= 0 or (channels != 1 and channels != 3 and channels != 4))
+		return false;
+
+	size_t rowBytes = (size_t)width * channels;
+	m_filtered.resize((rowBytes + 1) * height);
+	for (int y = 0; y < height; y++)
+	{
+		const byte* pRow = pTopRow + stride * y;
+		byte* pOut = &m_filtered[(rowBytes + 1) * y];
+		pOut[0] = PNG_FILTER_UP;
+		if (y == 0)
+		{
+			memcpy(pOut + 1, pRow, rowBytes);
+			continue;
+		}
+		const byte* pAbove = pRow - stride;
+		for (size_t i = 0; i < rowBytes; i++)
+		{
+			pOut[i + 1] = (byte)(pRow[i] - pAbove[i]);
+		}
+	}
+
+	png.assign(PNG_SIGNATURE, PNG_SIGNATURE + 8);
+	size_t chunk = BeginChunk(png, "IHDR");
+	PutU32(png, (uint32_t)width);
+	PutU32(png, (uint32_t)height);
+	png.push_back(8);                      // Bit depth
+	png.push_back(channels == 4 ? 6 : channels == 3 ? 2 : 0);  // Colour type: RGBA, RGB or greyscale
+	png.push_back(0);                      // Deflate
+	png.push_back(0);                      // Per-row filters
+	png.push_back(0);                      // Not interlaced
+	FinishChunk(png, chunk);
+
+	chunk = BeginChunk(png, "IDAT");
+	size_t dataStart = png.size();
+	png.resize(dataStart + deflateBound(&m_stream, (uLong)m_filtered.size()));
+	deflateReset(&m_stream);
+	m_stream.next_in = m_filtered.data();
+	m_stream.avail_in = (uInt)m_filtered.size();
+	m_stream.next_out = png.data() + dataStart;
+	m_stream.avail_out = (uInt)(png.size() - dataStart);
+	if (deflate(&m_stream, Z_FINISH) != Z_STREAM_END)
+		return false;
+	png.resize(dataStart + m_stream.total_out);
+	FinishChunk(png, chunk);
+
+	chunk = BeginChunk(png, "IEND");
+	FinishChunk(png, chunk);
+	return true;
+}
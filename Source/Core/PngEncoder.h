@@ -0,0 +1,30 @@
+#pragma once
+#include "Maze.h"
+#include <cstddef>
+#include <vector>
+#include <zlib.h>
+
+// Encodes 8-bit greyscale, RGB or RGBA images as PNG. Rows are filtered with Up, which turns the flat
+// colours and straight walls of a maze drawing into long runs of zeros, and deflated with zlib.
+//
+// An encoder keeps its zlib state and row buffer between images, so encoding many small images
+// costs no allocations after the first; give each thread its own.
+class PngEncoder
+{
+private:
+	z_stream m_stream;
+	std::vector<byte> m_filtered;
+	bool m_ready;
+public:
+	// level is zlib's, 1 (fastest) to 9 (smallest)
+	PngEncoder(int level = 6);
+	~PngEncoder();
+
+	PngEncoder(const PngEncoder&) = delete;
+	PngEncoder& operator=(const PngEncoder&) = delete;
+
+	// Replaces png with the encoded image. pTopRow points at the first pixel of the top row and each
+	// row starts stride bytes after the one above it, so a bottom-up image (a GL read-back) is passed
+	// with its last row and a negative stride. channels is 1, 3 or 4.
+	bool Encode(const byte* pTopRow, int width, int height, int channels, ptrdiff_t stride, std::vector<byte>& png);
+};
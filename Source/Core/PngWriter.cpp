@@ -0,0 +1,264 @@
+#include "PngWriter.h"
+#include <algorithm>
+#include <cstring>
+
+#define PNG_FILTER_UP 2
+
+// Compressed bytes per IDAT chunk
+#define PNG_CHUNK_BYTES (1 << 20)
+
+// Least filtered data worth a deflate stream of its own on the pool
+#define PNG_SLICE_BYTES (4 << 20)
+
+static const byte PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+static void PutU32(byte* pOut, uint32_t value)
+{
+	pOut[0] = (byte)(value >> 24);
+	pOut[1] = (byte)(value >> 16);
+	pOut[2] = (byte)(value >> 8);
+	pOut[3] = (byte)value;
+}
+
+// Raw deflate, with no zlib header or trailer of its own
+static bool InitRawDeflate(z_stream& stream, int level)
+{
+	return deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+}
+
+PngWriter::PngWriter(int level)
+	:m_pFile(nullptr), m_stream(), m_ready(false), m_failed(false), m_streamStale(false), m_level(level), m_width(0), m_height(0),
+	m_channels(0), m_rowsWritten(0), m_adler(0), m_previous(), m_filtered(), m_chunk(), m_slices()
+{
+	m_ready = InitRawDeflate(m_stream, level);
+}
+
+PngWriter::~PngWriter()
+{
+	if (m_pFile != nullptr)
+		fclose(m_pFile);
+	if (m_ready)
+		deflateEnd(&m_stream);
+	for (std::unique_ptr<Slice>& pSlice : m_slices)
+	{
+		if (pSlice->ready)
+			deflateEnd(&pSlice->stream);
+	}
+}
+
+bool PngWriter::WriteChunk(const char* type, const byte* pData, size_t length)
+{
+	byte header[8];
+	PutU32(header, (uint32_t)length);
+	memcpy(header + 4, type, 4);
+	// crc32 of a null buffer is its initial value, not a no-op, so empty chunks skip the data
+	uLong sum = crc32(0L, header + 4, 4);
+	if (length > 0)
+		sum = crc32(sum, pData, (uInt)length);
+	byte crc[4];
+	PutU32(crc, (uint32_t)sum);
+	if (fwrite(header, 1, 8, m_pFile) != 8 or fwrite(pData, 1, length, m_pFile) != length or fwrite(crc, 1, 4, m_pFile) != 4)
+		m_failed = true;
+	return !m_failed;
+}
+
+// Writes out every full chunk's worth of compressed data and keeps the rest
+bool PngWriter::WriteFullChunks()
+{
+	size_t written = 0;
+	while (m_chunk.size() - written >= PNG_CHUNK_BYTES)
+	{
+		if (!WriteChunk("IDAT", m_chunk.data() + written, PNG_CHUNK_BYTES))
+			return false;
+		written += PNG_CHUNK_BYTES;
+	}
+	m_chunk.erase(m_chunk.begin(), m_chunk.begin() + written);
+	return true;
+}
+
+void PngWriter::FilterRow(const byte* pRow, const byte* pAbove, byte* pFiltered) const
+{
+	size_t rowBytes = m_previous.size();
+	pFiltered[0] = PNG_FILTER_UP;
+	for (size_t i = 0; i < rowBytes; i++)
+	{
+		pFiltered[i + 1] = (byte)(pRow[i] - pAbove[i]);
+	}
+}
+
+bool PngWriter::Deflate(z_stream& stream, std::vector<byte>& out, int flush)
+{
+	while (true)
+	{
+		size_t used = out.size();
+		out.resize(used + std::max((size_t)stream.avail_in / 4, (size_t)4096));
+		stream.next_out = out.data() + used;
+		stream.avail_out = (uInt)(out.size() - used);
+		int result = deflate(&stream, flush);
+		out.resize(out.size() - stream.avail_out);
+		if (result == Z_STREAM_ERROR)
+			return false;
+		// Output space left over means deflate has taken all the input and done the flush
+		if (stream.avail_out > 0 and (flush != Z_FINISH or result == Z_STREAM_END))
+			return true;
+	}
+}
+
+bool PngWriter::Open(const char* path, int width, int height, int channels)
+{
+	if (!m_ready or m_pFile != nullptr or width <= 0 or height <= 0 or (channels != 1 and channels != 3 and channels != 4))
+		return false;
+	m_pFile = fopen(path, "wb");
+	if (m_pFile == nullptr)
+		return false;
+	m_failed = false;
+	m_streamStale = false;
+	m_width = width;
+	m_height = height;
+	m_channels = channels;
+	m_rowsWritten = 0;
+	m_adler = adler32(0L, nullptr, 0);
+	size_t rowBytes = (size_t)width * channels;
+	m_previous.assign(rowBytes, 0);
+	m_filtered.resize(rowBytes + 1);
+	deflateReset(&m_stream);
+
+	// zlib header: deflate with a 32K window, the level class zlib would give, and a check that
+	// makes the pair a multiple of 31
+	int levelClass = m_level < 2 ? 0 : m_level < 6 ? 1 : m_level == 6 ? 2 : 3;
+	int flags = levelClass << 6;
+	flags += 31 - (0x7800 + flags) % 31;
+	m_chunk.assign(1, 0x78);
+	m_chunk.push_back((byte)flags);
+
+	byte header[13];
+	PutU32(header, (uint32_t)width);
+	PutU32(header + 4, (uint32_t)height);
+	header[8] = 8;                                           // Bit depth
+	header[9] = channels == 4 ? 6 : channels == 3 ? 2 : 0;  // Colour type: RGBA, RGB or greyscale
+	header[10] = 0;                                          // Deflate
+	header[11] = 0;                                          // Per-row filters
+	header[12] = 0;                                          // Not interlaced
+	if (fwrite(PNG_SIGNATURE, 1, 8, m_pFile) != 8)
+		m_failed = true;
+	return WriteChunk("IHDR", header, sizeof(header));
+}
+
+bool PngWriter::WriteRows(const byte* pRows, int count, ptrdiff_t stride)
+{
+	if (m_pFile == nullptr or m_failed or count > m_height - m_rowsWritten)
+		return false;
+	if (m_streamStale)
+	{
+		deflateReset(&m_stream);
+		m_streamStale = false;
+	}
+	size_t rowBytes = m_previous.size();
+	for (int y = 0; y < count; y++)
+	{
+		// The row above the top one is all zeros, so the first row goes through unchanged
+		const byte* pRow = pRows + stride * y;
+		FilterRow(pRow, m_previous.data(), m_filtered.data());
+		memcpy(m_previous.data(), pRow, rowBytes);
+		m_adler = adler32(m_adler, m_filtered.data(), (uInt)m_filtered.size());
+		m_stream.next_in = m_filtered.data();
+		m_stream.avail_in = (uInt)m_filtered.size();
+		if (!Deflate(m_stream, m_chunk, Z_NO_FLUSH) or !WriteFullChunks())
+		{
+			m_failed = true;
+			return false;
+		}
+	}
+	m_rowsWritten += count;
+	return true;
+}
+
+bool PngWriter::WriteRows(const byte* pRows, int count, ptrdiff_t stride, ThreadPool& pool)
+{
+	if (m_pFile == nullptr or m_failed or count > m_height - m_rowsWritten)
+		return false;
+	size_t filteredBytes = m_filtered.size();
+	int sliceCount = (int)std::min((size_t)pool.GetThreadCount(), filteredBytes * count / PNG_SLICE_BYTES);
+	if (sliceCount <= 1)
+		return WriteRows(pRows, count, stride);
+
+	// Whatever m_stream holds has to end on a byte boundary before the slices follow it
+	if (!m_streamStale)
+	{
+		if (!Deflate(m_stream, m_chunk, Z_SYNC_FLUSH))
+		{
+			m_failed = true;
+			return false;
+		}
+		m_streamStale = true;
+	}
+	while ((int)m_slices.size() < sliceCount)
+	{
+		std::unique_ptr<Slice> pSlice(new Slice());
+		pSlice->ready = InitRawDeflate(pSlice->stream, m_level);
+		m_slices.push_back(std::move(pSlice));
+	}
+
+	pool.ParallelFor((size_t)sliceCount, 1, [&](size_t begin, size_t end)
+	{
+		for (size_t s = begin; s < end; s++)
+		{
+			Slice& slice = *m_slices[s];
+			int first = (int)((int64_t)count * s / sliceCount);
+			int last = (int)((int64_t)count * (s + 1) / sliceCount);
+			slice.filtered.resize(filteredBytes * (last - first));
+			for (int y = first; y < last; y++)
+			{
+				const byte* pAbove = y == 0 ? m_previous.data() : pRows + stride * (y - 1);
+				FilterRow(pRows + stride * y, pAbove, slice.filtered.data() + filteredBytes * (y - first));
+			}
+			slice.adler = adler32(adler32(0L, nullptr, 0), slice.filtered.data(), (uInt)slice.filtered.size());
+			slice.compressed.clear();
+			if (slice.ready)
+			{
+				deflateReset(&slice.stream);
+				slice.stream.next_in = slice.filtered.data();
+				slice.stream.avail_in = (uInt)slice.filtered.size();
+				slice.ready = Deflate(slice.stream, slice.compressed, Z_SYNC_FLUSH);
+			}
+		}
+	});
+
+	for (int s = 0; s < sliceCount; s++)
+	{
+		Slice& slice = *m_slices[s];
+		if (!slice.ready)
+		{
+			m_failed = true;
+			return false;
+		}
+		m_adler = adler32_combine(m_adler, slice.adler, (z_off_t)slice.filtered.size());
+		m_chunk.insert(m_chunk.end(), slice.compressed.begin(), slice.compressed.end());
+		if (!WriteFullChunks())
+			return false;
+	}
+	memcpy(m_previous.data(), pRows + stride * (count - 1), m_previous.size());
+	m_rowsWritten += count;
+	return true;
+}
+
+bool PngWriter::Close()
+{
+	if (m_pFile == nullptr)
+		return false;
+	// The last block comes from m_stream, empty if the slices had everything
+	if (m_streamStale)
+		deflateReset(&m_stream);
+	bool complete = !m_failed and m_rowsWritten == m_height and Deflate(m_stream, m_chunk, Z_FINISH);
+	if (complete)
+	{
+		byte trailer[4];
+		PutU32(trailer, (uint32_t)m_adler);
+		m_chunk.insert(m_chunk.end(), trailer, trailer + 4);
+		complete = WriteChunk("IDAT", m_chunk.data(), m_chunk.size()) and WriteChunk("IEND", nullptr, 0);
+	}
+	if (fclose(m_pFile) != 0)
+		complete = false;
+	m_pFile = nullptr;
+	return complete;
+}
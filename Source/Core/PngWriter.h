@@ -0,0 +1,74 @@
+#pragma once
+#include "Maze.h"
+#include "ThreadPool.h"
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include <zlib.h>
+
+// Writes a PNG file a few rows at a time, for images far too big to hold: each batch of rows is
+// Up-filtered against the row before it and deflated, and the compressed data goes out as IDAT
+// chunks whenever a chunk's worth has built up. Memory stays at one batch and one chunk whatever
+// the image size.
+//
+// The zlib header and trailer are written here around raw deflate data, so a batch can also be cut
+// into slices deflated on a pool, each by its own stream ending in a sync flush (pigz's approach):
+// the slices' data joins into one valid stream, and their adler32 sums are combined. Slices start
+// without the history of the one before, which costs little on Up-filtered maze rows.
+//
+// PngEncoder is the in-memory counterpart, for many small images.
+class PngWriter
+{
+private:
+	struct Slice
+	{
+		z_stream stream;
+		bool ready;
+		std::vector<byte> filtered;
+		std::vector<byte> compressed;
+		uLong adler;
+	};
+
+	FILE* m_pFile;
+	z_stream m_stream;
+	bool m_ready;
+	bool m_failed;
+	bool m_streamStale;           // A pool batch went out since m_stream last ran; its history is wrong
+	int m_level;
+	int m_width;
+	int m_height;
+	int m_channels;
+	int m_rowsWritten;
+	uLong m_adler;                // Of every filtered byte so far
+	std::vector<byte> m_previous; // Last row written, for the Up filter
+	std::vector<byte> m_filtered; // Filter type and filtered row
+	std::vector<byte> m_chunk;    // Compressed data not yet written out
+	std::vector<std::unique_ptr<Slice>> m_slices;
+
+	bool WriteChunk(const char* type, const byte* pData, size_t length);
+	bool WriteFullChunks();
+	void FilterRow(const byte* pRow, const byte* pAbove, byte* pFiltered) const;
+
+	// Deflates all of the stream's pending input onto the end of out
+	static bool Deflate(z_stream& stream, std::vector<byte>& out, int flush);
+public:
+	// level is zlib's, 1 (fastest) to 9 (smallest)
+	PngWriter(int level = 6);
+	~PngWriter();
+
+	PngWriter(const PngWriter&) = delete;
+	PngWriter& operator=(const PngWriter&) = delete;
+
+	// Creates the file and writes the header. channels is 1, 3 or 4.
+	bool Open(const char* path, int width, int height, int channels);
+
+	// Appends count rows, top first, each stride bytes after the one before
+	bool WriteRows(const byte* pRows, int count, ptrdiff_t stride);
+
+	// Same, filtered and deflated in slices on the pool
+	bool WriteRows(const byte* pRows, int count, ptrdiff_t stride, ThreadPool& pool);
+
+	// Finishes and closes the file; false if it is short of rows or anything failed on the way
+	bool Close();
+};
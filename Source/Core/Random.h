@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+
+// Small seedable generator (SplitMix64). Every maze owns one, so generation is
+// reproducible from its seed and independent of rand()'s global state.
+class Random
+{
+private:
+	uint64_t m_state;
+public:
+	Random(uint64_t seed = 0U)
+		:m_state(seed) {}
+
+	void Seed(uint64_t seed)
+	{
+		m_state = seed;
+	}
+
+	uint64_t Next64()
+	{
+		uint64_t z = (m_state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	uint32_t Next()
+	{
+		return (uint32_t)(Next64() >> 32);
+	}
+
+	// Uniform in [0, bound)
+	uint32_t Next(uint32_t bound)
+	{
+		return (uint32_t)(((uint64_t)Next() * bound) >> 32);
+	}
+};
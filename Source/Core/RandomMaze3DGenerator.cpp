@@ -0,0 +1,117 @@
+#include "RandomMaze3DGenerator.h"
+#include <memory>
+
+// Set bits per 6-bit direction mask
+static const byte BIT_COUNTS[64] = {
+	0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
+	1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6
+};
+
+// SELECT[mask][k] is the k-th lowest set bit of a 6-bit direction mask
+static const byte SELECT[64][6] = {
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x01, 0x00, 0x00, 0x00, 0x00, 0x00 },
+	{ 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x01, 0x02, 0x00, 0x00, 0x00, 0x00 },
+	{ 0x04, 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x01, 0x04, 0x00, 0x00, 0x00, 0x00 },
+	{ 0x02, 0x04, 0x00, 0x00, 0x00, 0x00 }, { 0x01, 0x02, 0x04, 0x00, 0x00, 0x00 },
+	{ 0x08, 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x01, 0x08, 0x00, 0x00, 0x00, 0x00 },
+	{ 0x02, 0x08, 0x00, 0x00, 0x00, 0x00 }, { 0x01, 0x02, 0x08, 0x00, 0x00, 0x00 },
+	{ 0x04, 0x08, 0x00, 0x00, 0x00, 0x00 }, { 0x01, 0x04, 0x08, 0x00, 0x00, 0x00 },
+	{ 0x02, 0x04, 0x08, 0x00, 0x00, 0x00 }, { 0x01, 0x02, 0x04, 0x08, 0x00, 0x00 },
+	{ 0x10, 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x01, 0x10, 0x00, 0x00, 0x00, 0x00 },
+	{ 0x02, 0x10, 0x00, 0x00, 0x00, 0x00 }, { 0x01, 0x02, 0x10, 0x00, 0x00, 0x00 },
+	{ 0x04, 0x10, 0x00, 0x00, 0x00, 0x00 }, { 0x01, 0x04, 0x10, 0x00, 0x00, 0x00 },
+	{ 0x02, 0x04, 0x10, 0x00, 0x00, 0x00 }, { 0x01, 0x02, 0x04, 0x10, 0x00, 0x00 },
+	{ 0x08, 0x10, 0x00, 0x00, 0x00, 0x00 }, { 0x01, 0x08, 0x10, 0x00, 0x00, 0x00 },
+	{ 0x02, 0x08, 0x10, 0x00, 0x00, 0x00 }, { 0x01, 0x02, 0x08, 0x10, 0x00, 0x00 },
+	{ 0x04, 0x08, 0x10, 0x00, 0x00, 0x00 }, { 0x01, 0x04, 0x08, 0x10, 0x00, 0x00 },
+	{ 0x02, 0x04, 0x08, 0x10, 0x00, 0x00 }, { 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 },
+	{ 0x20, 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x01, 0x20, 0x00, 0x00, 0x00, 0x00 },
+	{ 0x02, 0x20, 0x00, 0x00, 0x00, 0x00 }, { 0x01, 0x02, 0x20, 0x00, 0x00, 0x00 },
+	{ 0x04, 0x20, 0x00, 0x00, 0x00, 0x00 }, { 0x01, 0x04, 0x20, 0x00, 0x00, 0x00 },
+	{ 0x02, 0x04, 0x20, 0x00, 0x00, 0x00 }, { 0x01, 0x02, 0x04, 0x20, 0x00, 0x00 },
+	{ 0x08, 0x20, 0x00, 0x00, 0x00, 0x00 }, { 0x01, 0x08, 0x20, 0x00, 0x00, 0x00 },
+	{ 0x02, 0x08, 0x20, 0x00, 0x00, 0x00 }, { 0x01, 0x02, 0x08, 0x20, 0x00, 0x00 },
+	{ 0x04, 0x08, 0x20, 0x00, 0x00, 0x00 }, { 0x01, 0x04, 0x08, 0x20, 0x00, 0x00 },
+	{ 0x02, 0x04, 0x08, 0x20, 0x00, 0x00 }, { 0x01, 0x02, 0x04, 0x08, 0x20, 0x00 },
+	{ 0x10, 0x20, 0x00, 0x00, 0x00, 0x00 }, { 0x01, 0x10, 0x20, 0x00, 0x00, 0x00 },
+	{ 0x02, 0x10, 0x20, 0x00, 0x00, 0x00 }, { 0x01, 0x02, 0x10, 0x20, 0x00, 0x00 },
+	{ 0x04, 0x10, 0x20, 0x00, 0x00, 0x00 }, { 0x01, 0x04, 0x10, 0x20, 0x00, 0x00 },
+	{ 0x02, 0x04, 0x10, 0x20, 0x00, 0x00 }, { 0x01, 0x02, 0x04, 0x10, 0x20, 0x00 },
+	{ 0x08, 0x10, 0x20, 0x00, 0x00, 0x00 }, { 0x01, 0x08, 0x10, 0x20, 0x00, 0x00 },
+	{ 0x02, 0x08, 0x10, 0x20, 0x00, 0x00 }, { 0x01, 0x02, 0x08, 0x10, 0x20, 0x00 },
+	{ 0x04, 0x08, 0x10, 0x20, 0x00, 0x00 }, { 0x01, 0x04, 0x08, 0x10, 0x20, 0x00 },
+	{ 0x02, 0x04, 0x08, 0x10, 0x20, 0x00 }, { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20 }
+};
+
+// direction if the cell that way is inside the maze and not visited yet, else 0
+static byte Unvisited(const Maze3D& maze, int64_t current, byte direction, bool inside)
+{
+	int64_t next = inside ? maze.GetNeighbor(current, direction) : current;
+	return maze.IsVisited(next) ? 0U : direction;
+}
+
+static void Move(byte direction, int& x, int& y, int& z)
+{
+	x += (direction == WALL_RIGHT) - (direction == WALL_LEFT);
+	y += (direction == WALL_UP) - (direction == WALL_DOWN);
+	z += (direction == WALL_ABOVE) - (direction == WALL_BELOW);
+}
+
+RandomMaze3DGenerator::RandomMaze3DGenerator(Maze3D& maze, uint64_t seed)
+	:m_pMaze(&maze), m_random(seed), m_firstCell(-1), m_lastCell(-1)
+{
+}
+
+void RandomMaze3DGenerator::Generate()
+{
+	Maze3D& maze = *m_pMaze;
+	const int width = maze.GetWidth();
+	const int height = maze.GetHeight();
+	const int depth = maze.GetDepth();
+
+	// Every cell but the first can be on the stack at once; it is only needed while carving
+	int64_t remaining = maze.GetCellCount();
+	std::unique_ptr<byte[]> path(new byte[(size_t)remaining]);
+	int64_t stackSize = 0;
+
+	int x = m_random.Next(width);
+	int y = m_random.Next(height);
+	int z = m_random.Next(depth);
+	int64_t current = maze.GetIndex(x, y, z);
+	m_firstCell = current;
+	maze.SetVisited(current);
+	remaining--;
+
+	while (remaining > 0)
+	{
+		// Branch-free: a step off the maze is pointed back at the current cell, which is visited
+		byte candidates = 0U;
+		candidates |= Unvisited(maze, current, WALL_UP, y + 1 < height);
+		candidates |= Unvisited(maze, current, WALL_DOWN, y > 0);
+		candidates |= Unvisited(maze, current, WALL_LEFT, x > 0);
+		candidates |= Unvisited(maze, current, WALL_RIGHT, x + 1 < width);
+		candidates |= Unvisited(maze, current, WALL_ABOVE, z + 1 < depth);
+		candidates |= Unvisited(maze, current, WALL_BELOW, z > 0);
+
+		if (candidates != 0U)
+		{
+			byte direction = SELECT[candidates][m_random.Next(BIT_COUNTS[candidates])];
+			int64_t next = maze.GetNeighbor(current, direction);
+			maze.RemoveWalls(current, direction);
+			maze.RemoveWalls(next, Maze3D::GetOpposite(direction));
+			maze.SetVisited(next);
+			path[stackSize++] = direction;
+			Move(direction, x, y, z);
+			current = next;
+			remaining--;
+		}
+		else
+		{
+			// Every cell is visited before the stack can empty, so there is always one to go back to
+			byte back = Maze3D::GetOpposite(path[--stackSize]);
+			current = maze.GetNeighbor(current, back);
+			Move(back, x, y, z);
+		}
+	}
+	m_lastCell = current;
+}
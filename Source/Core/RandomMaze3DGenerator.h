@@ -0,0 +1,33 @@
+#pragma once
+#include "Maze3D.h"
+#include "Random.h"
+
+// Recursive back-tracker over a Maze3D, run to completion in one call; 3D mazes aren't animated.
+// Like RandomMazeGenerator, the stack holds the direction each cell was entered from, one byte per
+// entry, and stepping back goes against it. The walk keeps its coordinates alongside the storage
+// index, so bounds are checked without decoding the brick layout.
+class RandomMaze3DGenerator
+{
+private:
+	Maze3D* m_pMaze;
+	Random m_random;
+	int64_t m_firstCell;
+	int64_t m_lastCell;
+public:
+	RandomMaze3DGenerator(Maze3D& maze, uint64_t seed);
+
+	// maze must be freshly constructed or Reset()
+	void Generate();
+
+	// Storage index of the cell generation started from, or -1 before Generate()
+	int64_t GetFirstCell() const
+	{
+		return m_firstCell;
+	}
+
+	// Storage index of the last cell visited, the far end of the last corridor carved
+	int64_t GetLastCell() const
+	{
+		return m_lastCell;
+	}
+};
@@ -0,0 +1,172 @@
+#include "RandomMazeGenerator.h"
+
+RandomMazeGenerator::RandomMazeGenerator(Maze& maze, uint64_t seed, std::vector<int64_t>* pChangedCells, Arena* pArena)
+	:m_pMaze(&maze), m_random(seed), m_visitedCount(0), m_current(-1), m_path(nullptr), m_depth(0), m_ownedPath(),
+	m_pChangedCells(pChangedCells), m_firstCell(-1), m_lastCell(-1)
+{
+	// Every cell but the first can be on the stack at once
+	size_t capacity = (size_t)maze.GetCellCount();
+	if (pArena != nullptr)
+	{
+		m_path = pArena->Allocate<byte>(capacity);
+	}
+	else
+	{
+		m_ownedPath.reset(new byte[capacity]);
+		m_path = m_ownedPath.get();
+	}
+}
+
+RandomMazeGenerator::RandomMazeGenerator(Maze& maze)
+	:m_pMaze(&maze), m_random(0), m_visitedCount(maze.GetCellCount()), m_current(-1), m_path(nullptr), m_depth(0), m_ownedPath(),
+	m_pChangedCells(nullptr), m_firstCell(-1), m_lastCell(-1)
+{
+}
+
+bool RandomMazeGenerator::Step()
+{
+	Maze& maze = *m_pMaze;
+	const int width = maze.GetWidth();
+	const int height = maze.GetHeight();
+
+	if (IsFinished())
+	{
+		return true;
+	}
+	if (m_current == -1)
+	{
+		int64_t index;
+		do
+		{
+			int x = m_random.Next(width);
+			int y = m_random.Next(height);
+			index = maze.GetIndex(x, y);
+		} while (maze.GetState(index) != CELL_UNVISITED);
+		m_firstCell = index;
+		m_visitedCount++;
+		maze.SetState(index, CELL_VISITED);
+		if (m_pChangedCells != nullptr)
+			m_pChangedCells->push_back(index);
+		m_current = index;
+	}
+	else
+	{
+		byte nextDir = 0U;
+
+		int64_t current = m_current;
+		int x, y; // Position of last cell in stack
+		maze.GetPosition(current, x, y);
+
+		byte directionsChecked = 0U;
+
+		do
+		{
+			byte rDir = 0U; // Random direction
+			do
+			{
+				int sorted = m_random.Next(4);
+				rDir = 0x01 << sorted;
+			} while ((rDir & directionsChecked) != 0U);
+
+			directionsChecked |= rDir;
+
+			int64_t next = -1;
+			byte opposite = 0U;
+			switch (rDir)
+			{
+			case WALL_UP:
+				if (y + 1 < height)
+				{
+					next = current + width;
+					opposite = WALL_DOWN;
+				}
+				break;
+			case WALL_DOWN:
+				if (y - 1 >= 0)
+				{
+					next = current - width;
+					opposite = WALL_UP;
+				}
+				break;
+			case WALL_LEFT:
+				if (x - 1 >= 0)
+				{
+					next = current - 1;
+					opposite = WALL_RIGHT;
+				}
+				break;
+			case WALL_RIGHT:
+				if (x + 1 < width)
+				{
+					next = current + 1;
+					opposite = WALL_LEFT;
+				}
+				break;
+			}
+
+			if (next != -1 and maze.GetState(next) == CELL_UNVISITED)
+			{
+				m_visitedCount++;
+				maze.SetState(next, CELL_VISITED);
+				maze.RemoveWalls(next, opposite);
+				maze.RemoveWalls(current, rDir);
+				if (m_pChangedCells != nullptr)
+				{
+					m_pChangedCells->push_back(next);
+					m_pChangedCells->push_back(current);
+				}
+				m_path[m_depth++] = rDir;
+				m_current = next;
+				nextDir = rDir;
+			}
+		} while (directionsChecked != 0x0f and nextDir == 0x00); // While still didn't check all directions AND there's no defined next direction
+
+		if (nextDir == 0U) // There's nowhere to go
+		{
+			maze.SetState(current, CELL_BACKTRACKED);
+			if (m_pChangedCells != nullptr)
+				m_pChangedCells->push_back(current);
+			if (m_depth == 0)
+			{
+				m_current = -1;
+			}
+			else
+			{
+				// Step back against the direction this cell was entered from
+				switch (m_path[--m_depth])
+				{
+				case WALL_UP:
+					m_current -= width;
+					break;
+				case WALL_DOWN:
+					m_current += width;
+					break;
+				case WALL_LEFT:
+					m_current += 1;
+					break;
+				case WALL_RIGHT:
+					m_current -= 1;
+					break;
+				}
+			}
+		}
+		if (m_visitedCount == maze.GetCellCount() and m_lastCell == -1)
+		{
+			m_lastCell = m_current == -1 ? current : m_current;
+		}
+		if (m_current == -1 and m_ownedPath)
+		{
+			// Nothing left to carve; don't keep the stack's memory around for the rest of the session
+			m_ownedPath.reset();
+			m_path = nullptr;
+		}
+	}
+	return false;
+}
+
+void RandomMazeGenerator::Generate()
+{
+	while (!Step())
+	{
+	}
+}
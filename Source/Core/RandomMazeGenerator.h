@@ -0,0 +1,65 @@
+#pragma once
+#include "Maze.h"
+#include "Random.h"
+#include <memory>
+#include <vector>
+
+// Recursive back-tracker. Each Step() carves one cell or backtracks once, so the
+// game can animate the generation; Generate() runs it to completion.
+//
+// The stack holds the direction each cell was entered from rather than its index, one byte per
+// entry instead of eight; the cell below the top is found by stepping back from the current one.
+// The stack is sized for the deepest possible path up front and taken from the arena when one is
+// given, so a generator never allocates while it runs.
+class RandomMazeGenerator
+{
+private:
+	Maze* m_pMaze;
+	Random m_random;
+	int64_t m_visitedCount;
+	int64_t m_current;         // Top of the stack, -1 when the stack is empty
+	byte* m_path;              // WALL_* direction taken into each cell above the bottom of the stack
+	int64_t m_depth;           // Entries in m_path
+	std::unique_ptr<byte[]> m_ownedPath;
+	std::vector<int64_t>* m_pChangedCells;
+	int64_t m_firstCell;
+	int64_t m_lastCell;
+public:
+	// When pChangedCells is set, the index of every cell a Step() touches is appended to it
+	// The stack comes from pArena if set, and is then only valid until the arena is reset.
+	RandomMazeGenerator(Maze& maze, uint64_t seed, std::vector<int64_t>* pChangedCells = nullptr, Arena* pArena = nullptr);
+
+	// For a maze that is already carved: finished from the start, so it needs and allocates no stack
+	explicit RandomMazeGenerator(Maze& maze);
+
+	bool Step();
+	void Generate();
+
+	bool IsFinished() const
+	{
+		return m_visitedCount == m_pMaze->GetCellCount() and m_current == -1;
+	}
+
+	int64_t GetVisitedCount() const
+	{
+		return m_visitedCount;
+	}
+
+	// Cells on the stack below the current one
+	int64_t GetDepth() const
+	{
+		return m_depth;
+	}
+
+	// Index of the cell generation started from, or -1 before the first step
+	int64_t GetFirstCell() const
+	{
+		return m_firstCell;
+	}
+
+	// Top of the stack at the moment the last cell was visited, or -1 until then
+	int64_t GetLastCell() const
+	{
+		return m_lastCell;
+	}
+};
@@ -0,0 +1,222 @@
+#include "Replay.h"
+#include <fstream>
+#include <iterator>
+
+static const byte REPLAY_MAGIC[4] = { 'R', 'B', 'T', 'R' };
+static const byte REPLAY_VERSION = 3;
+static const size_t REPLAY_HEADER_SIZE_V1 = 19;
+static const size_t REPLAY_HEADER_SIZE_V2 = 23;
+static const size_t REPLAY_LEVEL_SIZE = 8;
+
+static void PutU16(std::vector<byte>& data, unsigned int value)
+{
+	data.push_back((byte)value);
+	data.push_back((byte)(value >> 8));
+}
+
+static void PutU64(std::vector<byte>& data, uint64_t value)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		data.push_back((byte)(value >> (i * 8)));
+	}
+}
+
+static void PutVarint(std::vector<byte>& data, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		data.push_back((byte)(value | 0x80));
+		value >>= 7;
+	}
+	data.push_back((byte)value);
+}
+
+static void PutU32(std::vector<byte>& data, uint32_t value)
+{
+	PutU16(data, value & 0xffff);
+	PutU16(data, value >> 16);
+}
+
+static unsigned int GetU16(const byte* p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static uint32_t GetU32(const byte* p)
+{
+	return GetU16(p) | ((uint32_t)GetU16(p + 2) << 16);
+}
+
+static uint64_t GetU64(const byte* p)
+{
+	uint64_t value = 0;
+	for (int i = 0; i < 8; i++)
+	{
+		value |= (uint64_t)p[i] << (i * 8);
+	}
+	return value;
+}
+
+ReplayWriter::ReplayWriter(const ReplayHeader& header)
+	:m_data(), m_lastTick(0), m_finished(false)
+{
+	m_data.assign(REPLAY_MAGIC, REPLAY_MAGIC + 4);
+	m_data.push_back(REPLAY_VERSION);
+	PutU16(m_data, header.width);
+	PutU16(m_data, header.height);
+	PutU64(m_data, header.seed);
+	PutU16(m_data, header.tickRate);
+	PutU32(m_data, header.generationSteps);
+	size_t levels = std::min<size_t>(header.levels.size(), 255);
+	m_data.push_back((byte)levels);
+	for (size_t i = 0; i < levels; i++)
+	{
+		PutU32(m_data, (uint32_t)header.levels[i].minSolution);
+		PutU32(m_data, (uint32_t)header.levels[i].maxSolution);
+	}
+}
+
+void ReplayWriter::PutEvent(uint64_t tick, byte moves)
+{
+	PutVarint(m_data, tick - m_lastTick);
+	m_data.push_back(moves);
+	m_lastTick = tick;
+}
+
+void ReplayWriter::Record(uint64_t tick, byte moves)
+{
+	if (moves == 0 or m_finished)
+		return;
+	PutEvent(tick, moves);
+}
+
+void ReplayWriter::Finish(uint64_t tickCount)
+{
+	if (m_finished)
+		return;
+	PutEvent(tickCount < m_lastTick ? m_lastTick : tickCount, 0);
+	m_finished = true;
+}
+
+bool ReplayWriter::Save(const char* path) const
+{
+	std::ofstream file(path, std::ios::binary);
+	file.write((const char*)m_data.data(), m_data.size());
+	return file.good();
+}
+
+ReplayReader::ReplayReader()
+	:m_header(), m_data(), m_headerSize(REPLAY_HEADER_SIZE_V2), m_offset(0), m_nextTick(0), m_nextMoves(0), m_endTick(0), m_ended(false)
+{
+}
+
+bool ReplayReader::Load(const char* path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+	std::vector<byte> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	return Parse(data);
+}
+
+bool ReplayReader::Parse(const std::vector<byte>& data)
+{
+	if (data.size() < REPLAY_HEADER_SIZE_V1)
+		return false;
+	for (int i = 0; i < 4; i++)
+	{
+		if (data[i] != REPLAY_MAGIC[i])
+			return false;
+	}
+	byte version = data[4];
+	if (version < 1 or version > REPLAY_VERSION)
+		return false;
+	size_t headerSize = version == 1 ? REPLAY_HEADER_SIZE_V1 : REPLAY_HEADER_SIZE_V2;
+	if (version >= 3)
+		headerSize += data.size() > headerSize ? 1 + data[headerSize] * REPLAY_LEVEL_SIZE : 1;
+	if (data.size() < headerSize)
+		return false;
+
+	m_header.width = GetU16(&data[5]);
+	m_header.height = GetU16(&data[7]);
+	m_header.seed = GetU64(&data[9]);
+	m_header.tickRate = GetU16(&data[17]);
+	m_header.generationSteps = version == 1 ? 1 : (int)GetU32(&data[19]);
+	if (m_header.width == 0 or m_header.height == 0 or m_header.tickRate == 0 or m_header.generationSteps <= 0)
+		return false;
+	m_header.levels.clear();
+	for (size_t offset = REPLAY_HEADER_SIZE_V2 + 1; version >= 3 and offset < headerSize; offset += REPLAY_LEVEL_SIZE)
+	{
+		MazeLevel level;
+		level.width = m_header.width;
+		level.height = m_header.height;
+		level.minSolution = GetU32(&data[offset]);
+		level.maxSolution = GetU32(&data[offset + 4]);
+		m_header.levels.push_back(level);
+	}
+
+	m_data = data;
+	m_headerSize = headerSize;
+	Rewind();
+	return true;
+}
+
+void ReplayReader::Rewind()
+{
+	m_offset = m_headerSize;
+	m_nextTick = 0;
+	m_nextMoves = 0;
+	m_endTick = 0;
+	m_ended = false;
+	ReadEvent();
+}
+
+// Reads the next event into m_nextTick/m_nextMoves. A truncated stream ends where it breaks off.
+bool ReplayReader::ReadEvent()
+{
+	uint64_t delta = 0;
+	int shift = 0;
+	while (true)
+	{
+		if (m_offset >= m_data.size() or shift > 63)
+		{
+			m_ended = true;
+			m_endTick = m_nextTick;
+			return false;
+		}
+		byte b = m_data[m_offset++];
+		delta |= (uint64_t)(b & 0x7f) << shift;
+		shift += 7;
+		if ((b & 0x80) == 0)
+			break;
+	}
+	if (m_offset >= m_data.size())
+	{
+		m_ended = true;
+		m_endTick = m_nextTick;
+		return false;
+	}
+
+	m_nextTick += delta;
+	m_nextMoves = m_data[m_offset++];
+	if (m_nextMoves == 0)
+	{
+		m_ended = true;
+		m_endTick = m_nextTick;
+		return false;
+	}
+	return true;
+}
+
+byte ReplayReader::GetMoves(uint64_t tick)
+{
+	byte moves = 0;
+	while (!m_ended and m_nextTick <= tick)
+	{
+		// Events skipped by a caller jumping ahead still count, as they would have on the live thread
+		moves |= m_nextMoves;
+		ReadEvent();
+	}
+	return moves;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "Maze.h"
+#include "MazePool.h"
+#include <cstdint>
+#include <vector>
+
+// Recorded game: the maze parameters plus every non-empty input with the tick it was applied on.
+// Given the same header and inputs, GameSession reproduces the game exactly.
+//
+// File layout (little-endian):
+//   "RBTR" u8 version, u16 width, u16 height, u64 seed, u16 tick rate, u32 generator steps per tick
+//          (version 2; version 1 files have no step count and animate one step per tick),
+//          u8 level count, then u32 min and u32 max solution length per level (version 3; none in
+//          older files, which generate every round)
+//   events: varint ticks since the previous event, u8 input (WALL_* moves, INPUT_NEW_MAZE)
+//   end:    varint ticks since the previous event, u8 0 (input is never 0 otherwise)
+struct ReplayHeader
+{
+	int width = 0;
+	int height = 0;
+	uint64_t seed = 0;
+	int tickRate = 60;
+	int generationSteps = 1;
+	std::vector<MazeLevel> levels; // Rounds after the first come ready-made from a MazePool with this schedule; empty to generate them
+};
+
+class ReplayWriter
+{
+private:
+	std::vector<byte> m_data;
+	uint64_t m_lastTick;
+	bool m_finished;
+
+	void PutEvent(uint64_t tick, byte moves);
+public:
+	ReplayWriter(const ReplayHeader& header);
+
+	// tick is the index of the GameSession::Tick() call the moves were passed to
+	void Record(uint64_t tick, byte moves);
+
+	// Marks the total number of ticks played; nothing can be recorded afterwards
+	void Finish(uint64_t tickCount);
+
+	bool Save(const char* path) const;
+
+	const std::vector<byte>& GetData() const
+	{
+		return m_data;
+	}
+};
+
+class ReplayReader
+{
+private:
+	ReplayHeader m_header;
+	std::vector<byte> m_data;
+	size_t m_headerSize;
+	size_t m_offset;
+	uint64_t m_nextTick;
+	byte m_nextMoves;
+	uint64_t m_endTick;
+	bool m_ended;
+
+	bool ReadEvent();
+public:
+	ReplayReader();
+
+	bool Load(const char* path);
+	bool Parse(const std::vector<byte>& data);
+
+	// Back to the first event, for playing the same replay again
+	void Rewind();
+
+	const ReplayHeader& GetHeader() const
+	{
+		return m_header;
+	}
+
+	// Moves to pass to the given tick; ticks must be asked for in increasing order
+	byte GetMoves(uint64_t tick);
+
+	// Number of ticks in the recording, known once the end marker has been read
+	bool IsFinished(uint64_t tick) const
+	{
+		return m_ended and tick >= m_endTick;
+	}
+
+	uint64_t GetEndTick() const
+	{
+		return m_endTick;
+	}
+};
@@ -0,0 +1,158 @@
+#include "SimulationThread.h"
+#include "FixedTimestep.h"
+#include <chrono>
+
+// Generator steps between clock reads while filling a time budget
+#define BUDGET_STEPS 256
+
+SimulationThread::SimulationThread(int width, int height, uint64_t seed, int tickRate)
+	:m_game(width, height, seed, true), m_step(1.0 / tickRate), m_generationBudget(0.0), m_thread(), m_running(false), m_input(0U), m_pRecorder(nullptr), m_pReplay(nullptr), m_pTelemetry(nullptr),
+	m_snapshots(), m_deltas(DELTA_RING_CAPACITY), m_backlog(), m_backlogStart(0), m_emitted(0), m_received(0), m_appliedRound(0)
+{
+}
+
+SimulationThread::~SimulationThread()
+{
+	Stop();
+}
+
+void SimulationThread::Start()
+{
+	m_running = true;
+	m_thread = std::thread(&SimulationThread::Run, this);
+}
+
+void SimulationThread::Stop()
+{
+	m_running = false;
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+void SimulationThread::Run()
+{
+	typedef std::chrono::steady_clock Clock;
+	FixedTimestep timestep(m_step);
+	Clock::time_point last = Clock::now();
+	uint64_t tick = 0;
+
+	while (m_running.load(std::memory_order_relaxed))
+	{
+		Clock::time_point now = Clock::now();
+		int ticks = timestep.Advance(std::chrono::duration<double>(now - last).count());
+		last = now;
+
+		for (int i = 0; i < ticks; i++)
+		{
+			byte moves = m_input.exchange(0U, std::memory_order_relaxed);
+			if (m_pReplay != nullptr)
+				moves = m_pReplay->GetMoves(tick);
+			if (m_pRecorder != nullptr)
+				m_pRecorder->Record(tick, moves);
+			int round = m_game.GetRound();
+			Clock::time_point tickStart = Clock::now();
+			m_game.Tick(moves);
+			tick++;
+			if (m_game.GetRound() != round)
+			{
+				// The old maze is gone; whatever of it was kept back is dropped
+				m_emitted -= m_backlog.size() - m_backlogStart;
+				m_backlog.clear();
+				m_backlogStart = 0;
+				m_backlog.push_back(DELTA_NEW_ROUND | (CellDelta)m_game.GetRound());
+				m_emitted++;
+			}
+			Emit();
+
+			// Extra generation only while the ring keeps up, so the backlog can't grow without bound
+			if (m_generationBudget > 0.0)
+			{
+				while (!m_game.IsGenerated() and m_backlogStart == m_backlog.size()
+					and std::chrono::duration<double>(Clock::now() - tickStart).count() < m_generationBudget)
+				{
+					m_game.StepGeneration(BUDGET_STEPS);
+					Emit();
+				}
+			}
+			if (m_pTelemetry != nullptr)
+				m_pTelemetry->RecordTick(m_game, moves, std::chrono::duration<double>(Clock::now() - tickStart).count());
+		}
+		// Deltas kept back on earlier ticks go out as the reader makes room
+		Flush();
+		if (ticks > 0)
+			Publish(tick, tick * m_step);
+
+		std::this_thread::sleep_for(std::chrono::duration<double>(m_step * (1.0 - timestep.GetAlpha())));
+	}
+	if (m_pRecorder != nullptr)
+		m_pRecorder->Finish(tick);
+}
+
+// Queues the cells the game changed since the last call and pushes what fits into the ring
+void SimulationThread::Emit()
+{
+	const Maze& maze = m_game.GetMaze();
+	for (int64_t index : m_game.GetChangedCells())
+	{
+		m_backlog.push_back(((CellDelta)index << 8) | maze.GetCell(index));
+	}
+	m_emitted += m_game.GetChangedCells().size();
+	m_game.ClearChangedCells();
+	Flush();
+}
+
+// Pushes the backlog into the ring until it is full
+void SimulationThread::Flush()
+{
+	while (m_backlogStart < m_backlog.size() and m_deltas.Push(m_backlog[m_backlogStart]))
+	{
+		m_backlogStart++;
+	}
+	if (m_backlogStart == m_backlog.size())
+	{
+		m_backlog.clear();
+		m_backlogStart = 0;
+	}
+}
+
+void SimulationThread::Publish(uint64_t tick, double time)
+{
+	SimulationSnapshot& snapshot = m_snapshots.GetBack();
+	snapshot.tick = tick;
+	snapshot.time = time;
+	snapshot.round = m_game.GetRound();
+	snapshot.player = m_game.GetPlayer();
+	snapshot.goal = m_game.GetGoal();
+	snapshot.generated = m_game.IsGenerated();
+	snapshot.won = m_game.IsWon();
+	snapshot.deltaCount = m_emitted;
+	m_snapshots.Publish();
+}
+
+bool SimulationThread::Sync(Maze& mirror, std::vector<int64_t>& changedCells)
+{
+	bool published = m_snapshots.Acquire();
+	int round = m_snapshots.GetFront().round;
+
+	while (const CellDelta* pDelta = m_deltas.Peek())
+	{
+		CellDelta delta = *pDelta;
+		if (delta & DELTA_NEW_ROUND)
+		{
+			int deltaRound = (int)(delta & ~DELTA_NEW_ROUND);
+			if (deltaRound > round)
+				break;
+			mirror.Reset();
+			m_appliedRound = deltaRound;
+		}
+		else
+		{
+			int64_t index = (int64_t)(delta >> 8);
+			mirror.SetCell(index, (byte)delta);
+			changedCells.push_back(index);
+		}
+		m_deltas.Pop();
+		m_received++;
+	}
+	return published;
+}
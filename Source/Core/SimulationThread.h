@@ -0,0 +1,153 @@
+#pragma once
+#include "GameSession.h"
+#include "Replay.h"
+#include "SpscRing.h"
+#include "Telemetry.h"
+#include "TripleBuffer.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// One change to a cell in 8 bytes: the cell index above the low byte, the new walls and state of
+// the cell in it. Deltas are absolute cell values, so applying one twice is harmless.
+typedef uint64_t CellDelta;
+
+// Flag of the delta marking the start of a new round, whose number is in the bits below it: the
+// mirror is cleared before the deltas after it. Cell indices never reach the top bit. The reader
+// takes the round from the marker, so it still lands on the right one when the simulation drops
+// a marker it had kept back along with the rest of an abandoned round.
+#define DELTA_NEW_ROUND ((CellDelta)1 << 63)
+
+// Deltas the ring holds before the simulation keeps the rest back for later ticks
+#define DELTA_RING_CAPACITY (1 << 20)
+
+// What the renderer needs from one simulation tick. Published snapshots are never modified again.
+struct SimulationSnapshot
+{
+	uint64_t tick = 0;
+	double time = 0.0;        // Simulated seconds at this tick
+	int round = 0;            // GameSession round; deltas only ever belong to the current one
+	int64_t player = -1;
+	int64_t goal = -1;
+	bool generated = false;
+	bool won = false;
+	uint64_t deltaCount = 0;  // Deltas emitted up to this tick, round markers included
+};
+
+// Runs a GameSession at a fixed tick rate on its own thread and hands snapshots to the render
+// thread through a TripleBuffer.
+//
+// The cells a tick changes go through a separate lock-free ring as they are made, so snapshots stay
+// small however fast the maze is generated and the reader sees every change exactly once, whichever
+// snapshots it skips. When the ring is full the simulation keeps the rest back and sends them on
+// later ticks, and a time budget stops generating until they are through; neither thread ever waits
+// for the other.
+class SimulationThread
+{
+private:
+	GameSession m_game;
+	double m_step;
+	double m_generationBudget;
+	std::thread m_thread;
+	std::atomic<bool> m_running;
+	std::atomic<byte> m_input;
+	ReplayWriter* m_pRecorder;
+	ReplayReader* m_pReplay;
+	TelemetryData* m_pTelemetry;
+
+	TripleBuffer<SimulationSnapshot> m_snapshots;
+	SpscRing<CellDelta> m_deltas;
+	std::vector<CellDelta> m_backlog;      // Writer side, did not fit in the ring yet
+	size_t m_backlogStart;                 // First entry of m_backlog not yet pushed
+	uint64_t m_emitted;                    // Writer side, deltas emitted so far
+
+	uint64_t m_received;                   // Reader side, deltas popped so far
+	int m_appliedRound;                    // Reader side
+
+	void Emit();
+	void Flush();
+	void Publish(uint64_t tick, double time);
+	void Run();
+public:
+	SimulationThread(int width, int height, uint64_t seed, int tickRate);
+	~SimulationThread();
+
+	// Before Start(): every tick's input is recorded, and the recording is finished when the thread
+	// stops. The recorder must outlive the thread.
+	void SetRecorder(ReplayWriter* pRecorder)
+	{
+		m_pRecorder = pRecorder;
+	}
+
+	// Before Start(): inputs come from the replay instead of AddInput()
+	void SetReplay(ReplayReader* pReplay)
+	{
+		m_pReplay = pReplay;
+	}
+
+	// Before Start(): generator steps every tick runs (GameSession::SetGenerationSteps)
+	void SetGenerationSteps(int steps)
+	{
+		m_game.SetGenerationSteps(steps);
+	}
+
+	// Before Start(): after its fixed steps, each tick keeps generating until this many seconds
+	// have passed since it began. How far generation gets then depends on the machine, so a
+	// budget cannot be recorded or replayed.
+	void SetGenerationBudget(double seconds)
+	{
+		m_generationBudget = seconds;
+	}
+
+	// Before Start(): every tick's totals go to the telemetry, which must outlive the thread
+	void SetTelemetry(TelemetryData* pTelemetry)
+	{
+		m_pTelemetry = pTelemetry;
+	}
+
+	// Before Start(): rounds after the first come from the pool (GameSession::SetPool)
+	void SetPool(MazePool* pPool)
+	{
+		m_game.SetPool(pPool);
+	}
+
+	void Start();
+	void Stop();
+
+	// Any thread: directions pressed since the last call, consumed by the next tick
+	void AddInput(byte moves)
+	{
+		m_input.fetch_or(moves, std::memory_order_relaxed);
+	}
+
+	// Render thread: takes the newest snapshot, applies the deltas waiting in the ring to the mirror
+	// maze and lists the touched cells in changedCells. Returns false if no snapshot was published
+	// since the last call. Deltas of a round the snapshot doesn't show yet are left in the ring;
+	// when the mirror moves on to a new round it is reset first, and every cell should be redrawn.
+	bool Sync(Maze& mirror, std::vector<int64_t>& changedCells);
+
+	// Render thread: the round the mirror holds, which can trail the snapshot's by a few frames
+	// while the ring catches up
+	int GetMirrorRound() const
+	{
+		return m_appliedRound;
+	}
+
+	// Render thread: whether the mirror has every change up to the snapshot's tick
+	bool IsMirrorCurrent() const
+	{
+		return m_received >= m_snapshots.GetFront().deltaCount;
+	}
+
+	// Render thread: the snapshot taken by the last successful Sync
+	const SimulationSnapshot& GetSnapshot() const
+	{
+		return m_snapshots.GetFront();
+	}
+
+	double GetStep() const
+	{
+		return m_step;
+	}
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Lock-free single-producer/single-consumer ring of fixed capacity. The producer Push()es, the
+// consumer Peek()s and Pop()s, and each side only ever writes its own index. Both sides keep a
+// copy of the other's index and only reload it when the ring looks full or empty, so a burst of
+// pushes or pops moves the shared cache lines once rather than once per item. Nothing waits: a
+// full ring makes Push() return false and an empty one makes Peek() return nullptr.
+template <typename T>
+class SpscRing
+{
+private:
+	std::vector<T> m_items;
+	size_t m_mask;
+	alignas(64) std::atomic<size_t> m_head; // Next item to pop; consumer writes
+	size_t m_tailCache;                     // Consumer's copy of m_tail
+	alignas(64) std::atomic<size_t> m_tail; // Next free slot; producer writes
+	size_t m_headCache;                     // Producer's copy of m_head
+public:
+	// capacity is rounded up to a power of two
+	SpscRing(size_t capacity)
+		:m_items(), m_mask(0), m_head(0), m_tailCache(0), m_tail(0), m_headCache(0)
+	{
+		size_t size = 1;
+		while (size < capacity)
+		{
+			size <<= 1;
+		}
+		m_items.resize(size);
+		m_mask = size - 1;
+	}
+
+	SpscRing(const SpscRing&) = delete;
+	SpscRing& operator=(const SpscRing&) = delete;
+
+	// Producer: returns false, leaving the ring as it was, when it is full
+	bool Push(const T& item)
+	{
+		size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_headCache > m_mask)
+		{
+			m_headCache = m_head.load(std::memory_order_acquire);
+			if (tail - m_headCache > m_mask)
+				return false;
+		}
+		m_items[tail & m_mask] = item;
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer: the oldest item, or nullptr when the ring is empty. It stays valid until Pop().
+	const T* Peek()
+	{
+		size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tailCache)
+		{
+			m_tailCache = m_tail.load(std::memory_order_acquire);
+			if (head == m_tailCache)
+				return nullptr;
+		}
+		return &m_items[head & m_mask];
+	}
+
+	// Consumer: drops the item returned by Peek()
+	void Pop()
+	{
+		m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	size_t GetCapacity() const
+	{
+		return m_items.size();
+	}
+};
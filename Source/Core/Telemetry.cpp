@@ -0,0 +1,197 @@
+#include "Telemetry.h"
+#include <chrono>
+#include <ctime>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+uint64_t TelemetryData::GetMicros()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void StoreMax(std::atomic<uint64_t>& counter, uint64_t value)
+{
+	if (value > counter.load(std::memory_order_relaxed))
+		counter.store(value, std::memory_order_relaxed);
+}
+
+uint64_t TelemetryHistogram::GetPercentile(double share) const
+{
+	uint64_t total = count.load(std::memory_order_relaxed);
+	if (total == 0)
+		return 0;
+	uint64_t target = (uint64_t)(share * total);
+	uint64_t seen = 0;
+	for (int k = 0; k < TELEMETRY_BUCKETS; k++)
+	{
+		seen += buckets[k].load(std::memory_order_relaxed);
+		if (seen > target)
+			return ((uint64_t)2 << k) - 1;
+	}
+	return max.load(std::memory_order_relaxed);
+}
+
+void TelemetryHistogram::Reset()
+{
+	for (int k = 0; k < TELEMETRY_BUCKETS; k++)
+	{
+		buckets[k].store(0, std::memory_order_relaxed);
+	}
+	count.store(0, std::memory_order_relaxed);
+	sum.store(0, std::memory_order_relaxed);
+	max.store(0, std::memory_order_relaxed);
+}
+
+void TelemetryData::Reset()
+{
+	std::atomic<uint64_t>* counters[] = { &ticks, &generatorSteps, &backtracks, &stackDepth, &maxStackDepth, &rounds, &wins, &inputEvents,
+		&frames, &drawCalls, &frameDrawCalls };
+	for (std::atomic<uint64_t>* pCounter : counters)
+	{
+		pCounter->store(0, std::memory_order_relaxed);
+	}
+	tickMicros.Reset();
+	winMillis.Reset();
+	frameMicros.Reset();
+}
+
+void TelemetryData::RecordTick(const GameSession& session, byte moves, double tickSeconds)
+{
+	heartbeat.store(GetMicros(), std::memory_order_relaxed);
+	ticks.store(session.GetTickCount(), std::memory_order_relaxed);
+	generatorSteps.store(session.GetStepCount(), std::memory_order_relaxed);
+	backtracks.store(session.GetBacktrackCount(), std::memory_order_relaxed);
+	stackDepth.store((uint64_t)session.GetDepth(), std::memory_order_relaxed);
+	StoreMax(maxStackDepth, (uint64_t)session.GetMaxDepth());
+	rounds.store((uint64_t)session.GetRound() + 1, std::memory_order_relaxed);
+
+	// Moves are WALL_* bits plus INPUT_NEW_MAZE, one per key
+	int presses = 0;
+	for (byte bits = moves; bits != 0; bits &= bits - 1)
+	{
+		presses++;
+	}
+	if (presses > 0)
+		inputEvents.fetch_add((uint64_t)presses, std::memory_order_relaxed);
+
+	if (session.GetWinCount() > wins.load(std::memory_order_relaxed))
+	{
+		winMillis.Record(session.GetLastWinTicks() * 1000 / (tickRate > 0 ? tickRate : 1));
+		wins.store(session.GetWinCount(), std::memory_order_relaxed);
+	}
+	tickMicros.Record((uint64_t)(tickSeconds * 1e6));
+}
+
+void TelemetryData::RecordFrame(uint64_t drawCount, double frameSeconds)
+{
+	frames.fetch_add(1, std::memory_order_relaxed);
+	drawCalls.fetch_add(drawCount, std::memory_order_relaxed);
+	frameDrawCalls.store(drawCount, std::memory_order_relaxed);
+	frameMicros.Record((uint64_t)(frameSeconds * 1e6));
+}
+
+bool TelemetryData::IsValid(const void* pData, size_t size)
+{
+	if (pData == nullptr or size < sizeof(TelemetryData))
+		return false;
+	const TelemetryData* pTelemetry = (const TelemetryData*)pData;
+	return pTelemetry->magic == TELEMETRY_MAGIC and pTelemetry->version == TELEMETRY_VERSION and pTelemetry->size == sizeof(TelemetryData);
+}
+
+#ifdef _WIN32
+TelemetryFile::TelemetryFile()
+	:m_pData(nullptr), m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr)
+{
+}
+
+bool TelemetryFile::Create(const char* path, int tickRate)
+{
+	Close();
+	m_file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+		CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE, 0, (DWORD)sizeof(TelemetryData), nullptr);
+	if (m_mapping == nullptr)
+	{
+		Close();
+		return false;
+	}
+	void* pView = MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, sizeof(TelemetryData));
+	if (pView == nullptr)
+	{
+		Close();
+		return false;
+	}
+	m_pData = new (pView) TelemetryData();
+	m_pData->processId = GetCurrentProcessId();
+#else
+TelemetryFile::TelemetryFile()
+	:m_pData(nullptr), m_fd(-1)
+{
+}
+
+bool TelemetryFile::Create(const char* path, int tickRate)
+{
+	Close();
+	m_fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (m_fd < 0)
+		return false;
+	if (ftruncate(m_fd, (off_t)sizeof(TelemetryData)) != 0)
+	{
+		Close();
+		return false;
+	}
+	void* pView = mmap(nullptr, sizeof(TelemetryData), PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+	if (pView == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+	m_pData = new (pView) TelemetryData();
+	m_pData->processId = (uint64_t)getpid();
+#endif
+	m_pData->magic = TELEMETRY_MAGIC;
+	m_pData->size = sizeof(TelemetryData);
+	m_pData->startTime = (uint64_t)time(nullptr);
+	m_pData->tickRate = (uint32_t)tickRate;
+	// Last, so a reader never takes a half-initialized file for a valid one
+	std::atomic_thread_fence(std::memory_order_release);
+	m_pData->version = TELEMETRY_VERSION;
+	return true;
+}
+
+void TelemetryFile::Close()
+{
+#ifdef _WIN32
+	if (m_pData != nullptr)
+		UnmapViewOfFile(m_pData);
+	if (m_mapping != nullptr)
+		CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+	m_mapping = nullptr;
+	m_file = INVALID_HANDLE_VALUE;
+#else
+	if (m_pData != nullptr)
+		munmap(m_pData, sizeof(TelemetryData));
+	if (m_fd >= 0)
+		close(m_fd);
+	m_fd = -1;
+#endif
+	m_pData = nullptr;
+}
+
+TelemetryFile::~TelemetryFile()
+{
+	Close();
+}
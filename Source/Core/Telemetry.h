@@ -0,0 +1,124 @@
+#pragma once
+#include "GameSession.h"
+#include <atomic>
+#include <cstdint>
+
+#define TELEMETRY_MAGIC   0x54544252U  // "RBTT"
+#define TELEMETRY_VERSION 1
+
+// Histogram buckets; bucket k counts values in [2^k, 2^(k+1)), bucket 0 also counts 0
+#define TELEMETRY_BUCKETS 32
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "telemetry counters are shared between processes");
+
+// Log2 histogram of one quantity, in the unit its name gives
+struct TelemetryHistogram
+{
+	std::atomic<uint64_t> buckets[TELEMETRY_BUCKETS];
+	std::atomic<uint64_t> count;
+	std::atomic<uint64_t> sum;
+	std::atomic<uint64_t> max;
+
+	void Record(uint64_t value)
+	{
+		int bucket = 0;
+		while (bucket + 1 < TELEMETRY_BUCKETS and (value >> (bucket + 1)) != 0)
+		{
+			bucket++;
+		}
+		buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+		count.fetch_add(1, std::memory_order_relaxed);
+		sum.fetch_add(value, std::memory_order_relaxed);
+		uint64_t previous = max.load(std::memory_order_relaxed);
+		while (value > previous and !max.compare_exchange_weak(previous, value, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	// Upper end of the bucket the given share of the values falls in, 0 if there are none
+	uint64_t GetPercentile(double share) const;
+
+	void Reset();
+};
+
+// Counters of a running game, laid out as-is in a memory-mapped file so another process can read
+// them while the game runs, without locks or system calls on either side. Each field has one
+// writing thread and is written with relaxed atomics: a reader sees every counter on its own up to
+// date, though not necessarily consistent with the others at one instant.
+struct TelemetryData
+{
+	// Fixed when the file is created
+	uint32_t magic;
+	uint32_t version;
+	uint64_t size;                          // sizeof(TelemetryData) of the writer
+	uint64_t processId;
+	uint64_t startTime;                     // Unix time in seconds
+	uint32_t tickRate;
+	uint32_t reserved;
+
+	// Simulation thread
+	std::atomic<uint64_t> heartbeat;        // Steady clock at the last tick in microseconds, the same clock in every process
+	std::atomic<uint64_t> ticks;
+	std::atomic<uint64_t> generatorSteps;   // Carving and backtracking
+	std::atomic<uint64_t> backtracks;
+	std::atomic<uint64_t> stackDepth;       // Generator stack now
+	std::atomic<uint64_t> maxStackDepth;    // Deepest in any round
+	std::atomic<uint64_t> rounds;
+	std::atomic<uint64_t> wins;
+	std::atomic<uint64_t> inputEvents;      // Key presses that reached the simulation
+	TelemetryHistogram tickMicros;          // Time spent in each tick
+	TelemetryHistogram winMillis;           // Simulated time from a maze being finished to reaching its goal
+
+	// Render thread
+	std::atomic<uint64_t> frames;
+	std::atomic<uint64_t> drawCalls;
+	std::atomic<uint64_t> frameDrawCalls;   // In the last frame
+	TelemetryHistogram frameMicros;         // Between the starts of consecutive frames
+
+	// Simulation thread: the session's totals after a tick that took tickSeconds. The totals are
+	// the session's own, so a new session must start from Reset().
+	void RecordTick(const GameSession& session, byte moves, double tickSeconds);
+
+	// Simulation thread, with the render thread idle: zeroes every counter and histogram, for a new
+	// session. Readers see the counters drop.
+	void Reset();
+
+	// Render thread: a frame that issued drawCalls draws, frameSeconds after the last one started
+	void RecordFrame(uint64_t frameDrawCalls, double frameSeconds);
+
+	// Steady clock in microseconds, as heartbeat holds it
+	static uint64_t GetMicros();
+
+	// Whether a mapped file holds telemetry of this layout
+	static bool IsValid(const void* pData, size_t size);
+};
+
+// Creates and maps the file telemetry is written to. The file stays behind after the game exits,
+// with the last values.
+class TelemetryFile
+{
+private:
+	TelemetryData* m_pData;
+#ifdef _WIN32
+	void* m_file;
+	void* m_mapping;
+#else
+	int m_fd;
+#endif
+public:
+	TelemetryFile();
+	~TelemetryFile();
+
+	TelemetryFile(const TelemetryFile&) = delete;
+	TelemetryFile& operator=(const TelemetryFile&) = delete;
+
+	// Replaces whatever the file held
+	bool Create(const char* path, int tickRate);
+	void Close();
+
+	// nullptr unless created
+	TelemetryData* GetData() const
+	{
+		return m_pData;
+	}
+};
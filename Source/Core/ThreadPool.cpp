@@ -0,0 +1,80 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threadCount)
+	:m_threads(), m_tasks(), m_mutex(), m_taskAvailable(), m_tasksDone(), m_pending(0), m_stopping(false)
+{
+	if (threadCount <= 0)
+	{
+		threadCount = (int)std::thread::hardware_concurrency();
+		if (threadCount <= 0)
+			threadCount = 1;
+	}
+	for (int i = 0; i < threadCount; i++)
+	{
+		m_threads.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_taskAvailable.notify_all();
+	for (std::thread& thread : m_threads)
+	{
+		thread.join();
+	}
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tasks.push_back(std::move(task));
+		m_pending++;
+	}
+	m_taskAvailable.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_tasksDone.wait(lock, [this] { return m_pending == 0; });
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t batchSize, const std::function<void(size_t, size_t)>& fn)
+{
+	if (batchSize == 0)
+		batchSize = 1;
+	for (size_t begin = 0; begin < count; begin += batchSize)
+	{
+		size_t end = begin + batchSize < count ? begin + batchSize : count;
+		Submit([&fn, begin, end] { fn(begin, end); });
+	}
+	Wait();
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_taskAvailable.wait(lock, [this] { return m_stopping or !m_tasks.empty(); });
+			if (m_tasks.empty())
+				return;
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		task();
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pending--;
+			if (m_pending == 0)
+				m_tasksDone.notify_all();
+		}
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads pulling tasks from one queue
+class ThreadPool
+{
+private:
+	std::vector<std::thread> m_threads;
+	std::deque<std::function<void()>> m_tasks;
+	std::mutex m_mutex;
+	std::condition_variable m_taskAvailable;
+	std::condition_variable m_tasksDone;
+	int m_pending;
+	bool m_stopping;
+
+	void WorkerLoop();
+public:
+	// threadCount <= 0 uses one thread per hardware core
+	ThreadPool(int threadCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void Submit(std::function<void()> task);
+
+	// Blocks until every submitted task has finished
+	void Wait();
+
+	// Splits [0, count) into batches of batchSize and runs fn(begin, end) on the workers, then waits
+	void ParallelFor(size_t count, size_t batchSize, const std::function<void(size_t, size_t)>& fn);
+
+	int GetThreadCount() const
+	{
+		return (int)m_threads.size();
+	}
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+
+// Lock-free single-writer/single-reader triple buffer. The writer fills GetBack() and Publish()es it;
+// the reader Acquire()s the most recently published buffer and reads GetFront(). Neither side ever
+// waits, and a reader that falls behind simply skips to the newest buffer.
+template <typename T>
+class TripleBuffer
+{
+private:
+	static const int INDEX_MASK = 0x03;
+	static const int FRESH = 0x04;
+
+	T m_buffers[3];
+	std::atomic<int> m_middle; // Index of the shared buffer, FRESH while the reader hasn't taken it
+	int m_back;                // Writer only
+	int m_front;               // Reader only
+public:
+	TripleBuffer()
+		:m_middle(1), m_back(0), m_front(2) {}
+
+	T& GetBack()
+	{
+		return m_buffers[m_back];
+	}
+
+	void Publish()
+	{
+		int previous = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel);
+		m_back = previous & INDEX_MASK;
+	}
+
+	// Returns false when nothing new has been published since the last call
+	bool Acquire()
+	{
+		if ((m_middle.load(std::memory_order_relaxed) & FRESH) == 0)
+			return false;
+		int previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+		m_front = previous & INDEX_MASK;
+		return true;
+	}
+
+	const T& GetFront() const
+	{
+		return m_buffers[m_front];
+	}
+};
@@ -0,0 +1,43 @@
+#include "WorldSession.h"
+
+WorldSession::WorldSession(uint64_t seed, int chunkSize)
+	:m_world(seed, chunkSize), m_playerX(0), m_playerY(0), m_chunkX(0), m_chunkY(0)
+{
+	m_world.GetSpawn(m_playerX, m_playerY);
+	m_world.GetChunkPosition(m_playerX, m_playerY, m_chunkX, m_chunkY);
+	m_world.Update(m_playerX, m_playerY);
+}
+
+void WorldSession::Tick(byte moves)
+{
+	byte walls = m_world.GetWalls(m_playerX, m_playerY);
+	if ((moves & WALL_UP) and (walls & WALL_UP) == 0x00)
+	{
+		m_playerY++;
+		walls = m_world.GetWalls(m_playerX, m_playerY);
+	}
+	if ((moves & WALL_DOWN) and (walls & WALL_DOWN) == 0x00)
+	{
+		m_playerY--;
+		walls = m_world.GetWalls(m_playerX, m_playerY);
+	}
+	if ((moves & WALL_LEFT) and (walls & WALL_LEFT) == 0x00)
+	{
+		m_playerX--;
+		walls = m_world.GetWalls(m_playerX, m_playerY);
+	}
+	if ((moves & WALL_RIGHT) and (walls & WALL_RIGHT) == 0x00)
+	{
+		m_playerX++;
+	}
+
+	// Only a new chunk changes what should be loaded
+	int32_t chunkX, chunkY;
+	m_world.GetChunkPosition(m_playerX, m_playerY, chunkX, chunkY);
+	if (chunkX != m_chunkX or chunkY != m_chunkY)
+	{
+		m_chunkX = chunkX;
+		m_chunkY = chunkY;
+		m_world.Update(m_playerX, m_playerY);
+	}
+}
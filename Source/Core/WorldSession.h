@@ -0,0 +1,34 @@
+#pragma once
+#include "MazeWorld.h"
+
+// Windowless game logic of the endless mode: a player walking a MazeWorld. There is no goal and
+// no generation to watch; chunks appear as the player gets near them.
+class WorldSession
+{
+private:
+	MazeWorld m_world;
+	int64_t m_playerX;
+	int64_t m_playerY;
+	int32_t m_chunkX;
+	int32_t m_chunkY;
+public:
+	WorldSession(uint64_t seed, int chunkSize = 32);
+
+	// Same WALL_* moves as GameSession::Tick()
+	void Tick(byte moves);
+
+	int64_t GetPlayerX() const
+	{
+		return m_playerX;
+	}
+
+	int64_t GetPlayerY() const
+	{
+		return m_playerY;
+	}
+
+	MazeWorld& GetWorld()
+	{
+		return m_world;
+	}
+};
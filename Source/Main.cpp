@@ -1,641 +1,98 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
-#include <stack>
 #include <iostream>
-
-#define WALL_UP    0x01
-#define WALL_DOWN  0x02
-#define WALL_LEFT  0x04
-#define WALL_RIGHT 0x08
-
-const int MAZE_WIDTH = 20;
-const int MAZE_HEIGHT = 15;
-
-typedef unsigned char byte;
+#include <memory>
+#include <thread>
+#include "Core/FixedTimestep.h"
+#include "Core/SimulationThread.h"
+#include "Core/Telemetry.h"
+#include "Core/WorldSession.h"
+#include "Render/Cube3D.h"
+#include "Render/MazeRenderer.h"
+
+// Size of the finite game's maze, --size WxH
+int mazeWidth = 20;
+int mazeHeight = 15;
 
 void window_size_callback(GLFWwindow* window, int width, int height)
 {
 	glViewport(0, 0, width, height);
 }
 
-class Cube3D
-{
-private:
-	static GLuint s_vbo;
-	static GLuint s_vao;
-	static GLuint s_ebo;
-	static GLuint s_diffuseTexture;
-	static GLuint s_specularTexture;
-	static GLuint s_shaderProgram;
-	static GLint s_projUniform;
-	static GLint s_viewUniform;
-	static GLint s_worldUniform;
-	static GLint s_diffuseUniform;
-	static GLint s_specularUniform;
-	static glm::mat4 s_worldMat;
-
-	struct Vertex
-	{
-		float  x,  y,  z;
-		float nx, ny, nz;
-		float  u,  v;
-	};
+// Draw calls since the last frame was recorded, counted by wrapping GL's draw entry points with --telemetry
+uint64_t drawCallCount = 0;
+PFNGLDRAWARRAYSPROC realDrawArrays = nullptr;
+PFNGLDRAWELEMENTSPROC realDrawElements = nullptr;
+PFNGLDRAWELEMENTSINSTANCEDPROC realDrawElementsInstanced = nullptr;
 
-	struct Color
-	{
-		byte r, g, b;
-	};
-public:
-	static void Init()
-	{
-		const Vertex cube[]
-		{
-			// Front face
-			{  1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 0.0f },
-			{  1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f },
-			{ -1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 1.0f },
-			{ -1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f },
-			// Right face
-			{  1.0f, -1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 0.0f },
-			{  1.0f,  1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 1.0f },
-			{  1.0f,  1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 1.0f },
-			{  1.0f, -1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 0.0f },
-			// Back face
-			{ -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 0.0f },
-			{ -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 1.0f },
-			{  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 1.0f },
-			{  1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 0.0f },
-			// Left face
-			{ -1.0f, -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 0.0f },
-			{ -1.0f,  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 1.0f },
-			{ -1.0f,  1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 1.0f },
-			{ -1.0f, -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 0.0f },
-			// Top face
-			{  1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 0.0f },
-			{  1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 1.0f },
-			{ -1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 1.0f },
-			{ -1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 0.0f },
-			// Bottom face
-			{  1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 0.0f },
-			{  1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 1.0f },
-			{ -1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 1.0f },
-			{ -1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 0.0f }
-		};
-
-		const GLubyte indices[]
-		{
-			0, 1, 2,
-			0, 2, 3,
-			4, 5, 6,
-			4, 6, 7,
-			8, 9, 10,
-			8, 10, 11,
-			12, 13, 14,
-			12, 14, 15,
-			16, 17, 18,
-			16, 18, 19,
-			20, 21, 22,
-			20, 22, 23
-		};
-
-		constexpr Color diffusePixels[]
-		{
-			{ 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64},
-			{ 64,  64,  64}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, { 64,  64,  64},
-			{ 64,  64,  64}, {  0,   0,   0}, {255, 216,   0}, {255, 216,   0}, {255, 216,   0}, {255, 216,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, { 64,  64,  64},
-			{ 64,  64,  64}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, { 64,  64,  64},
-			{ 64,  64,  64}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {255, 216,   0}, {  0,   0,   0}, { 64,  64,  64},
-			{ 64,  64,  64}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, { 64,  64,  64},
-			{ 64,  64,  64}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, { 64,  64,  64},
-			{ 64,  64,  64}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, { 64,  64,  64},
-			{ 64,  64,  64}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, { 64,  64,  64},
-			{ 64,  64,  64}, {  0,   0,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 106,   0}, {255, 106,   0}, {255, 106,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {255, 106,   0}, {255, 106,   0}, {  0,   0,   0}, { 64,  64,  64},
-			{ 64,  64,  64}, {  0,   0,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, { 64,  64,  64},
-			{ 64,  64,  64}, {  0,   0,   0}, {255, 106,   0}, {255, 106,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, { 64,  64,  64},
-			{ 64,  64,  64}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, { 64,  64,  64},
-			{ 64,  64,  64}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {255, 106,   0}, {255, 106,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, { 64,  64,  64},
-			{ 64,  64,  64}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, { 64,  64,  64},
-			{ 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}
-		};
-
-		constexpr Color specularPixels[]
-		{
-			{255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255},
-			{255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255},
-			{255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
-			{255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
-			{255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
-			{255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
-			{255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
-			{255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255},
-			{255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255},
-			{255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
-			{255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
-			{255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
-			{255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
-			{255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
-			{255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255},
-			{255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}
-		};
-
-		glGenBuffers(1, &s_vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, s_vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(cube), cube, GL_STATIC_DRAW);
-		
-		glGenVertexArrays(1, &s_vao);
-		glBindVertexArray(s_vao);
-		glVertexAttribPointer(0U, 3, GL_FLOAT, GL_FALSE, 32, (void*)0);
-		glVertexAttribPointer(1U, 3, GL_FLOAT, GL_FALSE, 32, (void*)12);
-		glVertexAttribPointer(2U, 2, GL_FLOAT, GL_FALSE, 32, (void*)24);
-		glEnableVertexAttribArray(0U);
-		glEnableVertexAttribArray(1U);
-		glEnableVertexAttribArray(2U);
-
-		glGenBuffers(1, &s_ebo);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s_ebo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-		glGenTextures(1, &s_diffuseTexture);
-		glBindTexture(GL_TEXTURE_2D, s_diffuseTexture);
-		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 16, 16, 0, GL_RGB, GL_UNSIGNED_BYTE, diffusePixels);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		glGenTextures(1, &s_specularTexture);
-		glBindTexture(GL_TEXTURE_2D, s_specularTexture);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 16, 16, 0, GL_RGB, GL_UNSIGNED_BYTE, specularPixels);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		const GLchar* vs_source = R"(
-#version 330 core
-
-layout(location = 0) in vec3 v_in_pos;
-layout(location = 1) in vec3 v_in_nor;
-layout(location = 2) in vec2 v_in_uv;
-
-uniform mat4 u_projection;
-uniform mat4 u_view;
-uniform mat4 u_world;
-
-out vec3 v_out_pos;
-out vec3 v_out_nor;
-out vec2 v_out_uv;
-
-void main()
+void APIENTRY CountDrawArrays(GLenum mode, GLint first, GLsizei count)
 {
-    gl_Position = u_projection * u_view * u_world * vec4(v_in_pos, 1.0);
-    v_out_pos = vec3(u_world * vec4(v_in_pos, 1.0));
-    v_out_nor = mat3(transpose(inverse(u_world))) * v_in_nor;
-    v_out_uv  = v_in_uv;
+	drawCallCount++;
+	realDrawArrays(mode, first, count);
 }
-)";
-		
-		const GLchar* fs_source = R"(
-#version 330 core
-
-in vec3 v_out_pos;
-in vec3 v_out_nor;
-in vec2 v_out_uv;
-
-out vec4 f_color;
-
-uniform sampler2D u_diffuse;
-uniform sampler2D u_specular;
 
-void main()
+void APIENTRY CountDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
 {
-    vec3 lightDir = normalize(vec3(0.3, 0.3, 1.0));
-
-    // Texture
-    vec3 diffColor = vec3(texture(u_diffuse, v_out_uv));
-    vec3 specColor = vec3(texture(u_specular, v_out_uv));
-
-    // Ambient lighting
-    float ambient = 0.15;
-
-    // Diffuse lighting
-    float diffuse = max(dot(v_out_nor, lightDir), 0.0);
-
-    // Specular highlight
-    vec3 viewDir = normalize(-v_out_pos);
-    vec3 reflectDir = reflect(-lightDir, v_out_nor);
-	vec3 specular = vec3(0.9) * pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
-    
-	f_color = vec4((ambient + diffuse) * diffColor + (specular * specColor), 1.0);
+	drawCallCount++;
+	realDrawElements(mode, count, type, indices);
 }
-)";
-
-		s_shaderProgram = glCreateProgram();
-		GLuint vs = glCreateShader(GL_VERTEX_SHADER);
-		GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(vs, 1, &vs_source, 0);
-		glShaderSource(fs, 1, &fs_source, 0);
-		glCompileShader(vs);
-		glCompileShader(fs);
-		glAttachShader(s_shaderProgram, vs);
-		glAttachShader(s_shaderProgram, fs);
-		glLinkProgram(s_shaderProgram);
-
-		s_projUniform = glGetUniformLocation(s_shaderProgram, "u_projection");
-		s_viewUniform =	glGetUniformLocation(s_shaderProgram, "u_view");
-		s_worldUniform = glGetUniformLocation(s_shaderProgram, "u_world");
-		s_diffuseUniform = glGetUniformLocation(s_shaderProgram, "u_diffuse");
-		s_specularUniform = glGetUniformLocation(s_shaderProgram, "u_specular");
-
-		glm::mat4 projMat = glm::perspective(glm::radians(80.0f), 4.0f / 3.0f, 0.1f, 10.0f);
-		glm::mat4 viewMat(1.0f);
-
-		glUseProgram(s_shaderProgram);
-
-		glUniformMatrix4fv(s_projUniform, 1, GL_FALSE, &projMat[0][0]);
-		glUniformMatrix4fv(s_viewUniform, 1, GL_FALSE, &viewMat[0][0]);
-		glUniform1i(s_diffuseUniform, 0);
-		glUniform1i(s_specularUniform, 1);
-	}
-
-	static void Render()
-	{
-		static float angleY = 0.0f;
-		static float angleX = 0.0f;
-		glm::mat4 pos = glm::translate(glm::mat4(1.0f), glm::vec3(cosf((float)glfwGetTime()) * 2.0f, -1.5f * sinf((float)glfwGetTime()), 3.0f * sinf((float)glfwGetTime() * 0.3f) - 6.0f));
-		glm::mat4 rotY = glm::rotate(glm::mat4(1.0f), angleY, glm::vec3(0.0f, 1.0f, 0.0f));
-		glm::mat4 rotX = glm::rotate(glm::mat4(1.0f), angleX, glm::vec3(1.0f, 0.0f, 0.0f));
-		s_worldMat = pos * rotY * rotX;
-		glUseProgram(s_shaderProgram);
-		glUniformMatrix4fv(s_worldUniform, 1, GL_FALSE, &s_worldMat[0][0]);
-		glBindVertexArray(s_vao);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s_ebo);
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, s_diffuseTexture);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, s_specularTexture);
-		glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_BYTE, (void*)0);
-		angleY += 0.01f;
-		angleX += 0.003f;
-	}
 
-	static void Cleanup()
-	{
-		glDeleteBuffers(1, &s_vbo);
-		glDeleteVertexArrays(1, &s_vao);
-		glDeleteBuffers(1, &s_ebo);
-		glDeleteTextures(1, &s_diffuseTexture);
-		glDeleteTextures(1, &s_specularTexture);
-		glDeleteProgram(s_shaderProgram);
-	}
-};
-
-GLuint Cube3D::s_vbo = 0U;
-GLuint Cube3D::s_vao = 0U;
-GLuint Cube3D::s_ebo = 0U;
-GLuint Cube3D::s_diffuseTexture = 0U;
-GLuint Cube3D::s_specularTexture = 0U;
-GLuint Cube3D::s_shaderProgram = 0U;
-GLint Cube3D::s_projUniform = 0;
-GLint Cube3D::s_viewUniform = 0;
-GLint Cube3D::s_worldUniform = 0;
-GLint Cube3D::s_diffuseUniform = 0;
-GLint Cube3D::s_specularUniform = 0;
-glm::mat4 Cube3D::s_worldMat = glm::mat4(1.0f);
-
-class Shader
+void APIENTRY CountDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instances)
 {
-private:
-	static GLuint s_vbo;
-	static GLuint s_vao;
-	static GLuint s_shaderProgram;
-	static GLint s_posUniform;
-	static GLint s_colUniform;
-public:
-	static void Init()
-	{
-		float data[8];
-
-		data[0] = 1.0f / (float)MAZE_WIDTH;
-		data[1] = 0.0f;
-
-		data[2] = 1.0f / (float)MAZE_WIDTH;
-		data[3] = 1.0f / (float)MAZE_HEIGHT;
-
-		data[4] = 0.0f;
-		data[5] = 1.0f / (float)MAZE_HEIGHT;
-
-		data[6] = 0.0f;
-		data[7] = 0.0f;
-
-		glGenBuffers(1, &s_vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, s_vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
-
-		glGenVertexArrays(1, &s_vao);
-		glBindVertexArray(s_vao);
-		glVertexAttribPointer(0U, 2, GL_FLOAT, GL_FALSE, 8, (void*)0);
-		glEnableVertexAttribArray(0U);
-
-		const GLchar* vs_source = R"(
-#version 330 core
-
-layout(location = 0) in vec2 v_pos;
-
-uniform vec2 u_pos;
-
-void main()
-{
-	gl_Position = vec4(((v_pos.x + u_pos.x) * 2.0) - 1.0, ((v_pos.y + u_pos.y) * 2.0) - 1.0, 0.0, 1.0);
+	drawCallCount++;
+	realDrawElementsInstanced(mode, count, type, indices, instances);
 }
-)";
-		const GLchar* fs_source = R"(
-#version 330 core
 
-uniform vec3 u_col;
-
-out vec4 f_color;
-
-void main()
+void CountDrawCalls()
 {
-	f_color = vec4(u_col.r, u_col.g, u_col.b, 1.0);
+	realDrawArrays = glad_glDrawArrays;
+	realDrawElements = glad_glDrawElements;
+	realDrawElementsInstanced = glad_glDrawElementsInstanced;
+	glad_glDrawArrays = CountDrawArrays;
+	glad_glDrawElements = CountDrawElements;
+	glad_glDrawElementsInstanced = CountDrawElementsInstanced;
 }
-)";
-
-		s_shaderProgram = glCreateProgram();
-		GLuint vs = glCreateShader(GL_VERTEX_SHADER);
-		GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(vs, 1, &vs_source, 0);
-		glShaderSource(fs, 1, &fs_source, 0);
-		glCompileShader(vs);
-		glCompileShader(fs);
-		glAttachShader(s_shaderProgram, vs);
-		glAttachShader(s_shaderProgram, fs);
-		glLinkProgram(s_shaderProgram);
-		glDeleteShader(vs);
-		glDeleteShader(fs);
-
-		s_posUniform = glGetUniformLocation(s_shaderProgram, "u_pos");
-		s_colUniform = glGetUniformLocation(s_shaderProgram, "u_col");
-	}
-
-	static void Cleanup()
-	{
-		glDeleteBuffers(1, &s_vbo);
-		glDeleteVertexArrays(1, &s_vao);
-		glDeleteProgram(s_shaderProgram);
-	}
-
-	static void Use()
-	{
-		glUseProgram(s_shaderProgram);
-	}
-
-	static void BindCell()
-	{
-		glBindVertexArray(s_vao);
-	}
-
-	static GLint GetPosUniform()
-	{
-		return s_posUniform;
-	}
-
-	static GLint GetColUniform()
-	{
-		return s_colUniform;
-	}
-};
-
-GLuint Shader::s_vbo = 0U;
-GLuint Shader::s_vao = 0U;
-GLuint Shader::s_shaderProgram = 0U;
-GLint  Shader::s_posUniform = 0;
-GLint  Shader::s_colUniform = 0;
 
-class Cell
-{
-private:
-	int m_x, m_y;
-	float m_r, m_g, m_b;
-	byte m_walls;
-public:
-	Cell(int x = 0, int y = 0)
-		:m_x(x), m_y(y), m_r(1.0f), m_g(1.0f), m_b(1.0f), m_walls(0x0f) {}
-	
-	void GetUnitPosition(int& x, int& y) const
-	{
-		x = m_x;
-		y = m_y;
-	}
-
-	void SetPosition(int x, int y)
-	{
-		m_x = x;
-		m_y = y;
-	}
-
-	void SetColor(float r, float g, float b)
-	{
-		m_r = r;
-		m_g = g;
-		m_b = b;
-	}
+// Scroll wheel notches since the last frame, for zooming the overview
+double scrollOffset = 0.0;
 
-	byte GetWalls() const
-	{
-		return m_walls;
-	}
-
-	void RemoveWalls(byte walls)
-	{
-		m_walls ^= walls;
-	}
-
-	void Render() const
-	{
-		glUniform2f(Shader::GetPosUniform(), (float)m_x / MAZE_WIDTH, (float)m_y / MAZE_HEIGHT);
-		glUniform3f(Shader::GetColUniform(), m_r, m_g, m_b);
-		Shader::BindCell();
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-		glUniform3f(Shader::GetColUniform(), 0.0f, 0.0f, 0.0f);
-		glDepthFunc(GL_ALWAYS);
-		if (m_walls & WALL_UP) // Top wall
-			glDrawArrays(GL_LINES, 1, 2);
-		if (m_walls & WALL_DOWN) // Bottom wall
-			glDrawArrays(GL_LINES, 3, 2);
-		if (m_walls & WALL_LEFT) // Left wall
-			glDrawArrays(GL_LINES, 2, 2);
-		if (m_walls & WALL_RIGHT) // Right wall
-			glDrawArrays(GL_LINES, 0, 2);
-		glDepthFunc(GL_LESS);
-	}
-};
-
-class RandomMazeGenerator
+void scroll_callback(GLFWwindow*, double, double yOffset)
 {
-private:
-	Cell(&m_maze)[MAZE_WIDTH][MAZE_HEIGHT];
-	int m_visitedCount;
-	bool m_visitedList[MAZE_WIDTH][MAZE_HEIGHT];
-	std::stack<Cell*> m_path;
-	Cell* m_pFirstCell;
-	Cell* m_pLastCell;
-	bool m_lastChecked;
-public:
-	RandomMazeGenerator(Cell(&maze)[MAZE_WIDTH][MAZE_HEIGHT])
-		:m_maze(maze), m_visitedCount(0), m_path(std::stack<Cell*>()), m_pFirstCell(nullptr), m_pLastCell(nullptr), m_lastChecked(false)
-	{
-		memset(m_visitedList, false, sizeof(m_visitedList));
-	}
-	
-	bool Step()
-	{
-		if (m_visitedCount == MAZE_HEIGHT * MAZE_WIDTH and m_path.empty())
-		{
-			return true;
-		}
-		if (m_path.empty())
-		{
-			int x, y;
-			do
-			{
-				x = rand() % MAZE_WIDTH;
-				y = rand() % MAZE_HEIGHT;
-			} while (m_visitedList[x][y]);
-			m_pFirstCell = &m_maze[x][y];
-			m_visitedList[x][y] = true;
-			m_visitedCount++;
-			m_maze[x][y].SetColor(0.1f, 0.8f, 0.5f);
-			m_path.push(&m_maze[x][y]);
-		}
-		else
-		{
-			byte nextDir = 0U;
-
-			int x, y; // Position of last Cell in stack
-			m_path.top()->GetUnitPosition(x, y);
-			
-			byte directionsChecked = 0U;
-
-			do
-			{
-				byte rDir = 0U; // Random direction
-				do
-				{
-					int sorted = rand() % 4;
-					rDir = 0x01 << sorted;
-				} while ((rDir & directionsChecked) != 0U);
-
-				directionsChecked |= rDir;
-
-				switch (rDir)
-				{
-				case WALL_UP:
-					if (y + 1 < MAZE_HEIGHT and m_visitedList[x][y + 1] == false)
-					{
-						m_visitedList[x][y + 1] = true;
-						m_visitedCount++;
-						m_maze[x][y + 1].SetColor(0.1f, 0.8f, 0.5f);
-						m_maze[x][y + 1].RemoveWalls(WALL_DOWN);
-						m_maze[x][y].RemoveWalls(WALL_UP);
-						m_path.push(&m_maze[x][y + 1]);
-						nextDir = rDir;
-					}
-					break;
-				case WALL_DOWN:
-					if (y - 1 >= 0 and m_visitedList[x][y - 1] == false)
-					{
-						m_visitedList[x][y - 1] = true;
-						m_visitedCount++;
-						m_maze[x][y - 1].SetColor(0.1f, 0.8f, 0.5f);
-						m_maze[x][y - 1].RemoveWalls(WALL_UP);
-						m_maze[x][y].RemoveWalls(WALL_DOWN);
-						m_path.push(&m_maze[x][y - 1]);
-						nextDir = rDir;
-					}
-					break;
-				case WALL_LEFT:
-					if (x - 1 >= 0 and m_visitedList[x - 1][y] == false)
-					{
-						m_visitedList[x - 1][y] = true;
-						m_visitedCount++;
-						m_maze[x - 1][y].SetColor(0.1f, 0.8f, 0.5f);
-						m_maze[x - 1][y].RemoveWalls(WALL_RIGHT);
-						m_maze[x][y].RemoveWalls(WALL_LEFT);
-						m_path.push(&m_maze[x - 1][y]);
-						nextDir = rDir;
-					}
-					break;
-				case WALL_RIGHT:
-					if (x + 1 < MAZE_WIDTH and m_visitedList[x + 1][y] == false)
-					{
-						m_visitedList[x + 1][y] = true;
-						m_visitedCount++;
-						m_maze[x + 1][y].SetColor(0.1f, 0.8f, 0.5f);
-						m_maze[x + 1][y].RemoveWalls(WALL_LEFT);
-						m_maze[x][y].RemoveWalls(WALL_RIGHT);
-						m_path.push(&m_maze[x + 1][y]);
-						nextDir = rDir;
-					}
-					break;
-				}
-			} while (directionsChecked != 0x0f and nextDir == 0x00); // While still didn't check all directions AND there's no defined next direction
-
-			if (nextDir == 0U) // There's nowhere to go
-			{
-				m_path.top()->SetColor(0.1f, 0.6f, 0.8f);
-				m_path.pop();
-			}
-			if (m_visitedCount == MAZE_WIDTH * MAZE_HEIGHT and !m_lastChecked)
-			{
-				m_pLastCell = m_path.top();
-				m_lastChecked = true;
-			}
-		}
-		return false;
-	}
-
-	Cell* GetFirstCell()
-	{
-		return m_pFirstCell;
-	}
-
-	Cell* GetLastCell()
-	{
-		return m_pLastCell;
-	}
-};
+	scrollOffset += yOffset;
+}
 
+// Keyboard input and drawing for the player; the movement itself happens in GameSession
 class Player
 {
 private:
-	const Cell(&m_maze)[MAZE_WIDTH][MAZE_HEIGHT];
 	GLFWwindow* m_pWindow;
 	GLuint m_vbo;
 	GLuint m_vao;
 	int m_x;
 	int m_y;
-	bool keyState[4];
+	bool keyState[5];
 public:
-	Player(const Cell(&maze)[MAZE_WIDTH][MAZE_HEIGHT], GLFWwindow* pWindow)
-		:m_maze(maze), m_pWindow(pWindow), m_vbo(0U), m_vao(0U), m_x(0), m_y(0)
+	Player(GLFWwindow* pWindow)
+		:m_pWindow(pWindow), m_vbo(0U), m_vao(0U), m_x(0), m_y(0)
 	{
 		memset(keyState, false, sizeof(keyState));
 		float vertices[6];
-		vertices[0] = 1.0f / MAZE_WIDTH * 0.9f;
-		vertices[1] = 1.0f / MAZE_HEIGHT * 0.1f;
+		vertices[0] = 1.0f / mazeWidth * 0.9f;
+		vertices[1] = 1.0f / mazeHeight * 0.1f;
 
-		vertices[2] = 1.0f / MAZE_WIDTH * 0.5f;
-		vertices[3] = 1.0f / MAZE_HEIGHT * 0.9f;
+		vertices[2] = 1.0f / mazeWidth * 0.5f;
+		vertices[3] = 1.0f / mazeHeight * 0.9f;
 
-		vertices[4] = 1.0f / MAZE_WIDTH * 0.1f;
-		vertices[5] = 1.0f / MAZE_HEIGHT * 0.1f;
+		vertices[4] = 1.0f / mazeWidth * 0.1f;
+		vertices[5] = 1.0f / mazeHeight * 0.1f;
 
 		glGenBuffers(1, &m_vbo);
 		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
@@ -659,56 +116,33 @@ public:
 		m_y = y;
 	}
 
-	void Process()
+	// Returns the WALL_* bits of the arrow keys pressed since the last call, plus INPUT_NEW_MAZE for N
+	byte Process()
 	{
-		if (glfwGetKey(m_pWindow, GLFW_KEY_UP) == GLFW_PRESS and keyState[0] == false)
-		{
-			keyState[0] = true;
-			if ((m_maze[m_x][m_y].GetWalls() & WALL_UP) == 0x00)
-				m_y += 1;
-		}
-		if (glfwGetKey(m_pWindow, GLFW_KEY_DOWN) == GLFW_PRESS and keyState[1] == false)
-		{
-			keyState[1] = true;
-			if ((m_maze[m_x][m_y].GetWalls() & WALL_DOWN) == 0x00)
-				m_y -= 1;
-		}
-		if (glfwGetKey(m_pWindow, GLFW_KEY_LEFT) == GLFW_PRESS and keyState[2] == false)
+		const int keys[5] = { GLFW_KEY_UP, GLFW_KEY_DOWN, GLFW_KEY_LEFT, GLFW_KEY_RIGHT, GLFW_KEY_N };
+		const byte directions[5] = { WALL_UP, WALL_DOWN, WALL_LEFT, WALL_RIGHT, INPUT_NEW_MAZE };
+		byte moves = 0U;
+		for (int i = 0; i < 5; i++)
 		{
-			keyState[2] = true;
-			if ((m_maze[m_x][m_y].GetWalls() & WALL_LEFT) == 0x00)
-				m_x -= 1;
-		}
-		if (glfwGetKey(m_pWindow, GLFW_KEY_RIGHT) == GLFW_PRESS and keyState[3] == false)
-		{
-			keyState[3] = true;
-			if ((m_maze[m_x][m_y].GetWalls() & WALL_RIGHT) == 0x00)
-				m_x += 1;
-		}
-
-		if (glfwGetKey(m_pWindow, GLFW_KEY_UP) == GLFW_RELEASE)
-		{
-			keyState[0] = false;
-		}
-		if (glfwGetKey(m_pWindow, GLFW_KEY_DOWN) == GLFW_RELEASE)
-		{
-			keyState[1] = false;
-		}
-		if (glfwGetKey(m_pWindow, GLFW_KEY_LEFT) == GLFW_RELEASE)
-		{
-			keyState[2] = false;
-		}
-		if (glfwGetKey(m_pWindow, GLFW_KEY_RIGHT) == GLFW_RELEASE)
-		{
-			keyState[3] = false;
+			int state = glfwGetKey(m_pWindow, keys[i]);
+			if (state == GLFW_PRESS and keyState[i] == false)
+			{
+				keyState[i] = true;
+				moves |= directions[i];
+			}
+			else if (state == GLFW_RELEASE)
+			{
+				keyState[i] = false;
+			}
 		}
+		return moves;
 	}
 
 	void Render()
 	{
 		glDepthFunc(GL_ALWAYS);
 		glBindVertexArray(m_vao);
-		glUniform2f(Shader::GetPosUniform(), (float)m_x / MAZE_WIDTH, (float)m_y / MAZE_HEIGHT);
+		glUniform2f(Shader::GetPosUniform(), (float)m_x / mazeWidth, (float)m_y / mazeHeight);
 		glUniform3f(Shader::GetColUniform(), 0.9f, 0.25f, 0.0f);
 		glDrawArrays(GL_TRIANGLES, 0, 3);
 		glUniform3f(Shader::GetColUniform(), 0.0f, 0.0f, 0.0f);
@@ -723,8 +157,162 @@ public:
 	}
 };
 
-int main()
+// Endless mode: a WorldSession ticked on this thread and drawn through a mazeWidth x mazeHeight
+// window that keeps the player in the middle
+void RunEndless(GLFWwindow* pWindow, Player& player, uint64_t seed, int chunkSize, int tickRate, int maxFrameRate)
 {
+	WorldSession session(seed, chunkSize);
+	FixedTimestep timestep(1.0 / tickRate);
+	Maze view(mazeWidth, mazeHeight);
+	bool viewValid = false;
+	int64_t viewX = 0;
+	int64_t viewY = 0;
+	byte moves = 0U;
+	double lastTime = glfwGetTime();
+	double lastRenderTime = 0.0;
+	player.SetUnitPosition(mazeWidth / 2, mazeHeight / 2);
+
+	while (!glfwWindowShouldClose(pWindow))
+	{
+		double now = glfwGetTime();
+		moves |= player.Process() & WALL_ALL;
+		int ticks = timestep.Advance(now - lastTime);
+		lastTime = now;
+		for (int i = 0; i < ticks; i++)
+		{
+			session.Tick(moves);
+			moves = 0U;
+		}
+
+		if (maxFrameRate > 0 and now - lastRenderTime < 1.0 / maxFrameRate)
+		{
+			glfwWaitEventsTimeout(1.0 / maxFrameRate - (now - lastRenderTime));
+			continue;
+		}
+		lastRenderTime = now;
+
+		if (!viewValid or session.GetPlayerX() != viewX or session.GetPlayerY() != viewY)
+		{
+			viewX = session.GetPlayerX();
+			viewY = session.GetPlayerY();
+			session.GetWorld().CopyRegion(viewX - mazeWidth / 2, viewY - mazeHeight / 2, view);
+			MazeTextureRenderer::Upload(view);
+			viewValid = true;
+		}
+
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		MazeTextureRenderer::Render();
+		Shader::Use();
+		player.Render();
+
+		glfwSwapBuffers(pWindow);
+		glfwPollEvents();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	// Simulation runs at a fixed rate; rendering can be capped separately (0 = every vsync)
+	int tickRate = 60;
+	int maxFrameRate = 0;
+	uint64_t seed = (uint64_t)time(NULL);
+	const char* recordPath = nullptr;
+	const char* replayPath = nullptr;
+	int endlessChunkSize = 0;
+	int generationSteps = 1;
+	double generationBudget = 0.0;
+	int prefetch = 0;
+	const char* levelsText = nullptr;
+	const char* telemetryPath = nullptr;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--tick-rate") == 0)
+			tickRate = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--fps") == 0)
+			maxFrameRate = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--seed") == 0)
+			seed = strtoull(argv[i + 1], nullptr, 10);
+		else if (strcmp(argv[i], "--record") == 0)
+			recordPath = argv[i + 1];
+		else if (strcmp(argv[i], "--replay") == 0)
+			replayPath = argv[i + 1];
+		else if (strcmp(argv[i], "--endless") == 0)
+			endlessChunkSize = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--size") == 0)
+		{
+			if (sscanf(argv[i + 1], "%dx%d", &mazeWidth, &mazeHeight) != 2 or mazeWidth < 1 or mazeHeight < 1
+				or mazeWidth > 0xffff or mazeHeight > 0xffff)
+			{
+				std::cerr << "Bad size " << argv[i + 1] << std::endl;
+				return -1;
+			}
+		}
+		else if (strcmp(argv[i], "--gen-steps") == 0)
+			generationSteps = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--gen-budget") == 0)
+			generationBudget = atof(argv[i + 1]) / 1000.0;
+		else if (strcmp(argv[i], "--prefetch") == 0)
+			prefetch = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--levels") == 0)
+			levelsText = argv[i + 1];
+		else if (strcmp(argv[i], "--telemetry") == 0)
+			telemetryPath = argv[i + 1];
+	}
+	if (tickRate <= 0)
+		tickRate = 60;
+	if (generationSteps <= 0)
+		generationSteps = 1;
+	if (generationBudget > 0.0 and recordPath != nullptr)
+	{
+		std::cerr << "--gen-budget depends on the machine's speed and cannot be recorded; use --gen-steps" << std::endl;
+		return -1;
+	}
+	if (telemetryPath != nullptr and endlessChunkSize > 0)
+	{
+		// Telemetry counts GameSession ticks, which the endless world doesn't have
+		std::cerr << "--telemetry only covers the finite game, not --endless" << std::endl;
+		return -1;
+	}
+
+	// A replay brings its own maze size, seed, tick rate and generation speed; the keyboard is
+	// ignored while it plays
+	ReplayReader replay;
+	if (replayPath != nullptr)
+	{
+		if (!replay.Load(replayPath))
+		{
+			std::cerr << "Cannot read replay " << replayPath << std::endl;
+			return -1;
+		}
+		mazeWidth = replay.GetHeader().width;
+		mazeHeight = replay.GetHeader().height;
+		seed = replay.GetHeader().seed;
+		tickRate = replay.GetHeader().tickRate;
+		generationSteps = replay.GetHeader().generationSteps;
+		generationBudget = 0.0;
+	}
+	ReplayHeader header;
+	header.width = mazeWidth;
+	header.height = mazeHeight;
+	header.seed = seed;
+	header.tickRate = tickRate;
+	header.generationSteps = generationSteps;
+	if (replayPath != nullptr)
+		header.levels = replay.GetHeader().levels;
+	else if (levelsText != nullptr and !MazePool::ParseSchedule(levelsText, mazeWidth, mazeHeight, header.levels))
+	{
+		std::cerr << "Bad levels " << levelsText << "; expected MIN-MAX solution lengths, comma separated" << std::endl;
+		return -1;
+	}
+	else if (levelsText == nullptr and prefetch > 0)
+		header.levels.push_back(MazeLevel{ mazeWidth, mazeHeight, 0, 0 });
+	ReplayWriter recorder(header);
+
+	// Next levels are built in the background, so N starts one without the wait
+	std::unique_ptr<MazePool> pPool;
+	if (!header.levels.empty())
+		pPool.reset(new MazePool(seed, header.levels, prefetch > 0 ? prefetch : 2));
+
 	if (glfwInit() == GLFW_FALSE)
 		return -1;
 
@@ -735,9 +323,8 @@ int main()
 		return -1;
 	}
 
-	srand(time(NULL));
-
 	glfwSetWindowSizeCallback(pWindow, window_size_callback);
+	glfwSetScrollCallback(pWindow, scroll_callback);
 	glfwMakeContextCurrent(pWindow);
 	glfwSwapInterval(1);
 
@@ -748,92 +335,331 @@ int main()
 		return -1;
 	}
 
-	Cube3D::Init();
-	Shader::Init();
-
-	Cell maze[MAZE_WIDTH][MAZE_HEIGHT];
-
-	RandomMazeGenerator rmg = RandomMazeGenerator(maze);
+	// Every maze the game shows, pooled levels included, is one texel per cell of a single texture
+	GLint maxTextureSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+	int largestSide = std::max(mazeWidth, mazeHeight);
+	for (const MazeLevel& level : header.levels)
+	{
+		largestSide = std::max(largestSide, std::max(level.width, level.height));
+	}
+	if (largestSide > maxTextureSize)
+	{
+		std::cerr << "Mazes with a side over " << maxTextureSize << " cells don't fit this GPU's textures" << std::endl;
+		glfwDestroyWindow(pWindow);
+		glfwTerminate();
+		return -1;
+	}
 
-	for (int i = 0; i < MAZE_WIDTH; i++)
+	// Counters another process can watch live (MazeTelemetry)
+	TelemetryFile telemetry;
+	if (telemetryPath != nullptr)
 	{
-		for (int j = 0; j < MAZE_HEIGHT; j++)
+		if (!telemetry.Create(telemetryPath, tickRate))
 		{
-			maze[i][j].SetPosition(i, j);
-			if ((i + j) % 2 == 0)
-				maze[i][j].SetColor(0.1f, 0.7f, 0.6f);
-			else
-				maze[i][j].SetColor(0.1f, 0.7f, 0.65f);
+			std::cerr << "Cannot create telemetry file " << telemetryPath << std::endl;
+			glfwDestroyWindow(pWindow);
+			glfwTerminate();
+			return -1;
 		}
+		CountDrawCalls();
 	}
 
-	Player player = Player(maze, pWindow);
+	Cube3D::Init();
+	Shader::Init(mazeWidth, mazeHeight);
+	MazeTextureRenderer::Init(mazeWidth, mazeHeight);
+	MazeOverviewRenderer::Init(mazeWidth, mazeHeight);
+
+	// The simulation owns the GameSession; this thread only renders a mirror of its maze
+	SimulationThread simulation(mazeWidth, mazeHeight, seed, tickRate);
+	if (recordPath != nullptr)
+		simulation.SetRecorder(&recorder);
+	if (replayPath != nullptr)
+		simulation.SetReplay(&replay);
+	simulation.SetGenerationSteps(generationSteps);
+	simulation.SetGenerationBudget(generationBudget);
+	simulation.SetPool(pPool.get());
+	simulation.SetTelemetry(telemetry.GetData());
+	Maze maze(mazeWidth, mazeHeight);
+	std::vector<int64_t> changedCells;
+	MazeTextureRenderer::Upload(maze);
+	MazeOverviewRenderer::Upload(maze);
+	int uploadedRound = 0;
+
+	Player player = Player(pWindow);
 
 	glEnable(GL_DEPTH_TEST);
-	glLineWidth(2.0f);
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
 	glFrontFace(GL_CCW);
 
+	if (endlessChunkSize > 0)
+	{
+		// Recording and replays only cover the finite game
+		RunEndless(pWindow, player, seed, endlessChunkSize, tickRate, maxFrameRate);
+		MazeOverviewRenderer::Cleanup();
+		MazeTextureRenderer::Cleanup();
+		Shader::Cleanup();
+		Cube3D::Cleanup();
+		glfwDestroyWindow(pWindow);
+		glfwTerminate();
+		return 0;
+	}
+
+	// M toggles between the single-pass texture renderer and the old per-cell geometry, V between
+	// the top-down map and a first-person view, Z to the zoomable overview
+	bool useTextureRenderer = true;
+	bool modeKeyState = false;
+	bool firstPerson = false;
+	bool firstPersonReady = false; // The first-person renderer is only set up once V is first pressed
+	bool viewKeyState = false;
+	bool overview = false;
+	bool overviewKeyState = false;
+
+	// The overview zooms about the cursor with the scroll wheel and pans by dragging
+	float overviewX = mazeWidth * 0.5f;
+	float overviewY = mazeHeight * 0.5f;
+	float overviewScale = 0.0f; // Cells per pixel; 0 fits the maze to the window on first use
+	double dragX = 0.0;
+	double dragY = 0.0;
+	bool dragging = false;
+
+	// The first-person camera eases after the player and turns to face the last move
+	float cameraX = 0.5f;
+	float cameraY = 0.5f;
+	float cameraYaw = 0.0f;
+	float targetYaw = 0.0f;
+	// Visible sets are built on their own thread from a copy of the finished maze, and the chunks
+	// are drawn until one is ready
+	MazeVisibility visibility;
+	MazeVisibility nextVisibility;
+	std::unique_ptr<Maze> pVisibilityMaze;
+	std::thread visibilityThread;
+	std::atomic<bool> visibilityDone(false);
+	int visibilityRound = -1; // Round the last set was started for
+
+	// From now rather than 0, so the first frame's time doesn't take in the whole startup
+	double lastRenderTime = glfwGetTime();
+
+	// Simulated time of the previous and the newest snapshot, and when the newest one arrived
+	double previousTime = 0.0;
+	double currentTime = 0.0;
+	double currentArrival = glfwGetTime();
+
+	simulation.Start();
+
 	while (!glfwWindowShouldClose(pWindow))
 	{
-		Shader::Use();
-		
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		double now = glfwGetTime();
+
+		// Key presses are polled every frame but only consumed by the next tick
+		byte moves = player.Process();
+		simulation.AddInput(moves);
+		if (moves & WALL_UP)
+			targetYaw = 0.0f;
+		else if (moves & WALL_RIGHT)
+			targetYaw = glm::half_pi<float>();
+		else if (moves & WALL_DOWN)
+			targetYaw = glm::pi<float>();
+		else if (moves & WALL_LEFT)
+			targetYaw = -glm::half_pi<float>();
+		if (simulation.Sync(maze, changedCells))
+		{
+			previousTime = currentTime;
+			currentTime = simulation.GetSnapshot().time;
+			currentArrival = now;
+		}
+
+		if (maxFrameRate > 0 and now - lastRenderTime < 1.0 / maxFrameRate)
+		{
+			// Skip this frame; the simulation keeps its own pace
+			glfwWaitEventsTimeout(1.0 / maxFrameRate - (now - lastRenderTime));
+			continue;
+		}
+		float frameTime = (float)(now - lastRenderTime);
+		lastRenderTime = now;
 
-		for (int i = 0; i < MAZE_WIDTH; i++)
+		if (glfwGetKey(pWindow, GLFW_KEY_M) == GLFW_PRESS and modeKeyState == false)
 		{
-			for (int j = 0; j < MAZE_HEIGHT; j++)
+			useTextureRenderer = !useTextureRenderer;
+			glLineWidth(useTextureRenderer ? 1.0f : 2.0f);
+		}
+		modeKeyState = glfwGetKey(pWindow, GLFW_KEY_M) == GLFW_PRESS;
+		if (glfwGetKey(pWindow, GLFW_KEY_V) == GLFW_PRESS and viewKeyState == false)
+		{
+			firstPerson = !firstPerson;
+			if (firstPerson and !firstPersonReady)
 			{
-				maze[i][j].Render();
+				MazeFirstPersonRenderer::Init(mazeWidth, mazeHeight);
+				MazeFirstPersonRenderer::Upload(maze);
+				firstPersonReady = true;
 			}
 		}
+		viewKeyState = glfwGetKey(pWindow, GLFW_KEY_V) == GLFW_PRESS;
+		if (glfwGetKey(pWindow, GLFW_KEY_Z) == GLFW_PRESS and overviewKeyState == false)
+			overview = !overview;
+		overviewKeyState = glfwGetKey(pWindow, GLFW_KEY_Z) == GLFW_PRESS;
+
+		if (overview)
 		{
-			static int firstX = -1, firstY = -1;
-			if (firstX == -1)
+			int windowWidth, windowHeight;
+			double cursorX, cursorY;
+			glfwGetWindowSize(pWindow, &windowWidth, &windowHeight);
+			glfwGetCursorPos(pWindow, &cursorX, &cursorY);
+			if (overviewScale <= 0.0f and windowWidth > 0 and windowHeight > 0)
+				overviewScale = std::max((float)mazeWidth / windowWidth, (float)mazeHeight / windowHeight) * 1.1f;
+
+			// The cell under the cursor stays put while zooming
+			float offsetX = (float)(cursorX - windowWidth * 0.5);
+			float offsetY = (float)(windowHeight * 0.5 - cursorY);
+			float zoom = powf(0.8f, (float)scrollOffset);
+			overviewX += offsetX * overviewScale * (1.0f - zoom);
+			overviewY += offsetY * overviewScale * (1.0f - zoom);
+			overviewScale *= zoom;
+
+			bool pressed = glfwGetMouseButton(pWindow, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+			if (pressed and dragging)
 			{
-				rmg.Step();
-				rmg.GetFirstCell()->GetUnitPosition(firstX, firstY);
-				player.SetUnitPosition(firstX, firstY);
+				overviewX -= (float)(cursorX - dragX) * overviewScale;
+				overviewY += (float)(cursorY - dragY) * overviewScale;
 			}
+			dragging = pressed;
+			dragX = cursorX;
+			dragY = cursorY;
 		}
+		scrollOffset = 0.0;
 
-		static Cell* pLastCell = nullptr;
+		// Cells the simulation changed since the last drawn frame, however many the generator got
+		// through, go up in one batch; a mirror that moved on to a new round replaces the whole maze
+		const SimulationSnapshot& snapshot = simulation.GetSnapshot();
+		if (simulation.GetMirrorRound() != uploadedRound)
+		{
+			MazeTextureRenderer::Upload(maze);
+			MazeOverviewRenderer::Upload(maze);
+			if (firstPersonReady)
+				MazeFirstPersonRenderer::Upload(maze);
+			uploadedRound = simulation.GetMirrorRound();
+			if (pPool != nullptr)
+			{
+				MazePoolStats stats = pPool->GetStats();
+				std::cout << "Round " << uploadedRound << ": pool " << stats.hits << " hits, " << stats.misses << " misses, "
+					<< stats.ready << " of " << stats.capacity << " ready" << std::endl;
+			}
+		}
+		else
+		{
+			MazeTextureRenderer::UpdateCells(maze, changedCells);
+			MazeOverviewRenderer::UpdateCells(maze, changedCells);
+			if (firstPersonReady)
+			{
+				for (int64_t index : changedCells)
+				{
+					MazeFirstPersonRenderer::UpdateCell(maze, index);
+				}
+			}
+		}
+		changedCells.clear();
 
-		if (rmg.Step())
+		// What each cell can see is worked out once the maze is finished, and only for the first-person view
+		if (visibilityThread.joinable() and visibilityDone)
 		{
-			static bool initialized = false;
-			if (!initialized)
+			visibilityThread.join();
+			pVisibilityMaze.reset();
+			if (visibilityRound == snapshot.round)
 			{
-				pLastCell = rmg.GetLastCell();
-				pLastCell->SetColor(1.0f, 0.9f, 0.75f);
-				initialized = true;
+				std::swap(visibility, nextVisibility);
+				MazeFirstPersonRenderer::SetVisibility(&visibility);
 			}
+			else
+				visibilityRound = -1;
+		}
+		if (firstPerson and snapshot.generated and simulation.IsMirrorCurrent() and visibilityRound != snapshot.round
+			and !visibilityThread.joinable() and maze.GetCellCount() <= MazeFirstPersonRenderer::VISIBILITY_MAX_CELLS)
+		{
+			pVisibilityMaze.reset(new Maze(maze.GetWidth(), maze.GetHeight()));
+			for (int64_t i = 0; i < maze.GetCellCount(); i++)
+				pVisibilityMaze->SetCell(i, maze.GetCell(i));
+			visibilityDone = false;
+			visibilityRound = snapshot.round;
+			visibilityThread = std::thread([&]()
+			{
+				nextVisibility.Build(*pVisibilityMaze, MazeFirstPersonRenderer::VISIBILITY_RANGE);
+				visibilityDone = true;
+			});
+		}
 
-			player.Process();
-			player.Render();
+		if (snapshot.generated)
+		{
+			int playerX, playerY;
+			maze.GetPosition(snapshot.player, playerX, playerY);
+			player.SetUnitPosition(playerX, playerY);
+
+			float blend = 1.0f - expf(-12.0f * frameTime);
+			float turn = remainderf(targetYaw - cameraYaw, glm::two_pi<float>());
+			cameraX += (playerX + 0.5f - cameraX) * blend;
+			cameraY += (playerY + 0.5f - cameraY) * blend;
+			cameraYaw += turn * blend;
 		}
 
-		if (pLastCell != nullptr)
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		if (firstPerson)
+		{
+			int framebufferWidth, framebufferHeight;
+			glfwGetFramebufferSize(pWindow, &framebufferWidth, &framebufferHeight);
+			float aspect = framebufferHeight > 0 ? (float)framebufferWidth / framebufferHeight : 1.0f;
+			MazeFirstPersonRenderer::Render(maze, cameraX, cameraY, cameraYaw, aspect);
+		}
+		else if (overview)
 		{
-			int lastX, lastY;
-			pLastCell->GetUnitPosition(lastX, lastY);
 			int playerX, playerY;
 			player.GetUnitPosition(playerX, playerY);
-			if (lastX == playerX and lastY == playerY)
-			{
-				glClear(GL_DEPTH_BUFFER_BIT);
-				Cube3D::Render();
-			}
+			MazeOverviewRenderer::Render(overviewX, overviewY, overviewScale, playerX, playerY);
+		}
+		else if (useTextureRenderer)
+		{
+			MazeTextureRenderer::Render();
+			Shader::Use();
+		}
+		else
+		{
+			Shader::Use();
+			MazeGeometryRenderer::Render(maze);
+		}
+
+		if (snapshot.generated and !firstPerson and !overview)
+			player.Render();
+
+		if (snapshot.won)
+		{
+			// Interpolate between the last two ticks, one tick behind the simulation
+			double alpha = (now - currentArrival) / simulation.GetStep();
+			if (alpha > 1.0)
+				alpha = 1.0;
+			glClear(GL_DEPTH_BUFFER_BIT);
+			Cube3D::Render((float)(previousTime + (currentTime - previousTime) * alpha));
 		}
 
 		glfwSwapBuffers(pWindow);
 		glfwPollEvents();
+		if (telemetry.GetData() != nullptr)
+		{
+			telemetry.GetData()->RecordFrame(drawCallCount, frameTime);
+			drawCallCount = 0;
+		}
 	}
 	
+	simulation.Stop();
+	if (visibilityThread.joinable())
+		visibilityThread.join();
+	if (recordPath != nullptr and !recorder.Save(recordPath))
+		std::cerr << "Cannot write replay " << recordPath << std::endl;
+	MazeFirstPersonRenderer::Cleanup();
+	MazeOverviewRenderer::Cleanup();
+	MazeTextureRenderer::Cleanup();
 	Shader::Cleanup();
 	Cube3D::Cleanup();
 	glfwDestroyWindow(pWindow);
 	glfwTerminate();
 	return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -0,0 +1,266 @@
+#include "Cube3D.h"
+
+GLuint Cube3D::s_vbo = 0U;
+GLuint Cube3D::s_vao = 0U;
+GLuint Cube3D::s_ebo = 0U;
+GLuint Cube3D::s_diffuseTexture = 0U;
+GLuint Cube3D::s_specularTexture = 0U;
+GLuint Cube3D::s_shaderProgram = 0U;
+GLint Cube3D::s_projUniform = 0;
+GLint Cube3D::s_viewUniform = 0;
+GLint Cube3D::s_worldUniform = 0;
+GLint Cube3D::s_diffuseUniform = 0;
+GLint Cube3D::s_specularUniform = 0;
+glm::mat4 Cube3D::s_worldMat = glm::mat4(1.0f);
+
+// Shared with MazeFirstPersonRenderer; position and normal come in view space, lit from a fixed
+// direction
+static const GLchar* FS_SOURCE = R"(
+#version 330 core
+
+in vec3 v_out_pos;
+in vec3 v_out_nor;
+in vec2 v_out_uv;
+
+out vec4 f_color;
+
+uniform sampler2D u_diffuse;
+uniform sampler2D u_specular;
+
+void main()
+{
+    vec3 lightDir = normalize(vec3(0.3, 0.3, 1.0));
+
+    // Texture
+    vec3 diffColor = vec3(texture(u_diffuse, v_out_uv));
+    vec3 specColor = vec3(texture(u_specular, v_out_uv));
+
+    // Ambient lighting
+    float ambient = 0.15;
+
+    // Diffuse lighting
+    float diffuse = max(dot(v_out_nor, lightDir), 0.0);
+
+    // Specular highlight
+    vec3 viewDir = normalize(-v_out_pos);
+    vec3 reflectDir = reflect(-lightDir, v_out_nor);
+vec3 specular = vec3(0.9) * pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
+    
+f_color = vec4((ambient + diffuse) * diffColor + (specular * specColor), 1.0);
+}
+)";
+
+void Cube3D::Init()
+{
+	const Vertex cube[]
+	{
+		// Front face
+		{  1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 0.0f },
+		{  1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f },
+		{ -1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 1.0f },
+		{ -1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f },
+		// Right face
+		{  1.0f, -1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 0.0f },
+		{  1.0f,  1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 1.0f },
+		{  1.0f,  1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 1.0f },
+		{  1.0f, -1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 0.0f },
+		// Back face
+		{ -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 0.0f },
+		{ -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 1.0f },
+		{  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 1.0f },
+		{  1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 0.0f },
+		// Left face
+		{ -1.0f, -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 0.0f },
+		{ -1.0f,  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 1.0f },
+		{ -1.0f,  1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 1.0f },
+		{ -1.0f, -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 0.0f },
+		// Top face
+		{  1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 0.0f },
+		{  1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 1.0f },
+		{ -1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 1.0f },
+		{ -1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 0.0f },
+		// Bottom face
+		{  1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 0.0f },
+		{  1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 1.0f },
+		{ -1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 1.0f },
+		{ -1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 0.0f }
+	};
+
+	const GLubyte indices[]
+	{
+		0, 1, 2,
+		0, 2, 3,
+		4, 5, 6,
+		4, 6, 7,
+		8, 9, 10,
+		8, 10, 11,
+		12, 13, 14,
+		12, 14, 15,
+		16, 17, 18,
+		16, 18, 19,
+		20, 21, 22,
+		20, 22, 23
+	};
+
+	constexpr Color diffusePixels[]
+	{
+		{ 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64},
+		{ 64,  64,  64}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, { 64,  64,  64},
+		{ 64,  64,  64}, {  0,   0,   0}, {255, 216,   0}, {255, 216,   0}, {255, 216,   0}, {255, 216,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, { 64,  64,  64},
+		{ 64,  64,  64}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, { 64,  64,  64},
+		{ 64,  64,  64}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {255, 216,   0}, {  0,   0,   0}, { 64,  64,  64},
+		{ 64,  64,  64}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, { 64,  64,  64},
+		{ 64,  64,  64}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 216,   0}, {  0,   0,   0}, { 64,  64,  64},
+		{ 64,  64,  64}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, { 64,  64,  64},
+		{ 64,  64,  64}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, { 64,  64,  64},
+		{ 64,  64,  64}, {  0,   0,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 106,   0}, {255, 106,   0}, {255, 106,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {255, 106,   0}, {255, 106,   0}, {  0,   0,   0}, { 64,  64,  64},
+		{ 64,  64,  64}, {  0,   0,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, { 64,  64,  64},
+		{ 64,  64,  64}, {  0,   0,   0}, {255, 106,   0}, {255, 106,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, { 64,  64,  64},
+		{ 64,  64,  64}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, { 64,  64,  64},
+		{ 64,  64,  64}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {255, 106,   0}, {255, 106,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, {255, 106,   0}, {  0,   0,   0}, { 64,  64,  64},
+		{ 64,  64,  64}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, { 64,  64,  64},
+		{ 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}, { 64,  64,  64}
+	};
+
+	constexpr Color specularPixels[]
+	{
+		{255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255},
+		{255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255},
+		{255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
+		{255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
+		{255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
+		{255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
+		{255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
+		{255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255},
+		{255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255},
+		{255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
+		{255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
+		{255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
+		{255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
+		{255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255}, {  0,   0,   0}, {255, 255, 255},
+		{255, 255, 255}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0}, {255, 255, 255},
+		{255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}
+	};
+
+	glGenBuffers(1, &s_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, s_vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(cube), cube, GL_STATIC_DRAW);
+	
+	glGenVertexArrays(1, &s_vao);
+	glBindVertexArray(s_vao);
+	glVertexAttribPointer(0U, 3, GL_FLOAT, GL_FALSE, 32, (void*)0);
+	glVertexAttribPointer(1U, 3, GL_FLOAT, GL_FALSE, 32, (void*)12);
+	glVertexAttribPointer(2U, 2, GL_FLOAT, GL_FALSE, 32, (void*)24);
+	glEnableVertexAttribArray(0U);
+	glEnableVertexAttribArray(1U);
+	glEnableVertexAttribArray(2U);
+
+	glGenBuffers(1, &s_ebo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s_ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+	glGenTextures(1, &s_diffuseTexture);
+	glBindTexture(GL_TEXTURE_2D, s_diffuseTexture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 16, 16, 0, GL_RGB, GL_UNSIGNED_BYTE, diffusePixels);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	glGenTextures(1, &s_specularTexture);
+	glBindTexture(GL_TEXTURE_2D, s_specularTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 16, 16, 0, GL_RGB, GL_UNSIGNED_BYTE, specularPixels);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	const GLchar* vs_source = R"(
+#version 330 core
+
+layout(location = 0) in vec3 v_in_pos;
+layout(location = 1) in vec3 v_in_nor;
+layout(location = 2) in vec2 v_in_uv;
+
+uniform mat4 u_projection;
+uniform mat4 u_view;
+uniform mat4 u_world;
+
+out vec3 v_out_pos;
+out vec3 v_out_nor;
+out vec2 v_out_uv;
+
+void main()
+{
+    gl_Position = u_projection * u_view * u_world * vec4(v_in_pos, 1.0);
+    v_out_pos = vec3(u_world * vec4(v_in_pos, 1.0));
+    v_out_nor = mat3(transpose(inverse(u_world))) * v_in_nor;
+    v_out_uv  = v_in_uv;
+}
+)";
+
+	s_shaderProgram = glCreateProgram();
+	GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+	GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(vs, 1, &vs_source, 0);
+	glShaderSource(fs, 1, &FS_SOURCE, 0);
+	glCompileShader(vs);
+	glCompileShader(fs);
+	glAttachShader(s_shaderProgram, vs);
+	glAttachShader(s_shaderProgram, fs);
+	glLinkProgram(s_shaderProgram);
+
+	s_projUniform = glGetUniformLocation(s_shaderProgram, "u_projection");
+	s_viewUniform =	glGetUniformLocation(s_shaderProgram, "u_view");
+	s_worldUniform = glGetUniformLocation(s_shaderProgram, "u_world");
+	s_diffuseUniform = glGetUniformLocation(s_shaderProgram, "u_diffuse");
+	s_specularUniform = glGetUniformLocation(s_shaderProgram, "u_specular");
+
+	glm::mat4 projMat = glm::perspective(glm::radians(80.0f), 4.0f / 3.0f, 0.1f, 10.0f);
+	glm::mat4 viewMat(1.0f);
+
+	glUseProgram(s_shaderProgram);
+
+	glUniformMatrix4fv(s_projUniform, 1, GL_FALSE, &projMat[0][0]);
+	glUniformMatrix4fv(s_viewUniform, 1, GL_FALSE, &viewMat[0][0]);
+	glUniform1i(s_diffuseUniform, 0);
+	glUniform1i(s_specularUniform, 1);
+}
+
+// The animation is a function of simulated time only, so the render thread can interpolate it
+void Cube3D::Render(float time)
+{
+	float angleY = 0.6f * time;
+	float angleX = 0.18f * time;
+	glm::mat4 pos = glm::translate(glm::mat4(1.0f), glm::vec3(cosf(time) * 2.0f, -1.5f * sinf(time), 3.0f * sinf(time * 0.3f) - 6.0f));
+	glm::mat4 rotY = glm::rotate(glm::mat4(1.0f), angleY, glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 rotX = glm::rotate(glm::mat4(1.0f), angleX, glm::vec3(1.0f, 0.0f, 0.0f));
+	s_worldMat = pos * rotY * rotX;
+	glUseProgram(s_shaderProgram);
+	glUniformMatrix4fv(s_worldUniform, 1, GL_FALSE, &s_worldMat[0][0]);
+	glBindVertexArray(s_vao);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s_ebo);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, s_diffuseTexture);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, s_specularTexture);
+	glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_BYTE, (void*)0);
+}
+
+void Cube3D::Cleanup()
+{
+	glDeleteBuffers(1, &s_vbo);
+	glDeleteVertexArrays(1, &s_vao);
+	glDeleteBuffers(1, &s_ebo);
+	glDeleteTextures(1, &s_diffuseTexture);
+	glDeleteTextures(1, &s_specularTexture);
+	glDeleteProgram(s_shaderProgram);
+}
+
+const GLchar* Cube3D::GetFragmentSource()
+{
+	return FS_SOURCE;
+}
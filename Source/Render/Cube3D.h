@@ -0,0 +1,54 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../Core/Maze.h"
+
+// Lit, textured cube from -1 to 1: the rotating "YOU WIN" box. MazeFirstPersonRenderer draws the
+// maze walls as instances of the same mesh through the same lighting shader.
+class Cube3D
+{
+private:
+	static GLuint s_vbo;
+	static GLuint s_vao;
+	static GLuint s_ebo;
+	static GLuint s_diffuseTexture;
+	static GLuint s_specularTexture;
+	static GLuint s_shaderProgram;
+	static GLint s_projUniform;
+	static GLint s_viewUniform;
+	static GLint s_worldUniform;
+	static GLint s_diffuseUniform;
+	static GLint s_specularUniform;
+	static glm::mat4 s_worldMat;
+
+	struct Vertex
+	{
+		float  x,  y,  z;
+		float nx, ny, nz;
+		float  u,  v;
+	};
+
+	struct Color
+	{
+		byte r, g, b;
+	};
+public:
+	static void Init();
+	static void Render(float time);
+	static void Cleanup();
+
+	// 24 Vertex entries (position, normal, uv; 32 bytes each)
+	static GLuint GetVertexBuffer()
+	{
+		return s_vbo;
+	}
+
+	// 36 GL_UNSIGNED_BYTE indices
+	static GLuint GetIndexBuffer()
+	{
+		return s_ebo;
+	}
+
+	// Expects v_out_pos and v_out_nor in view space and v_out_uv, samples u_diffuse and u_specular
+	static const GLchar* GetFragmentSource();
+};
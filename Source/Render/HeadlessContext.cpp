@@ -0,0 +1,42 @@
+#include "HeadlessContext.h"
+#include <EGL/eglext.h>
+
+HeadlessContext::HeadlessContext()
+	:m_display(EGL_NO_DISPLAY), m_context(EGL_NO_CONTEXT)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+	if (m_display == EGL_NO_DISPLAY)
+		return;
+	eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (m_context != EGL_NO_CONTEXT)
+		eglDestroyContext(m_display, m_context);
+	eglTerminate(m_display);
+}
+
+bool HeadlessContext::Create()
+{
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	m_display = getPlatformDisplay != nullptr
+		? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr)
+		: eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	if (m_display == EGL_NO_DISPLAY or !eglInitialize(m_display, nullptr, nullptr))
+	{
+		m_display = EGL_NO_DISPLAY;
+		return false;
+	}
+	eglBindAPI(EGL_OPENGL_API);
+
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	m_context = eglCreateContext(m_display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttributes);
+	if (m_context == EGL_NO_CONTEXT or !eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_context))
+		return false;
+	return gladLoadGLLoader((GLADloadproc)eglGetProcAddress) != 0;
+}
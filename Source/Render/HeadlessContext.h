@@ -0,0 +1,22 @@
+#pragma once
+#include <glad/glad.h>
+#include <EGL/egl.h>
+
+// OpenGL 3.3 core context without a window or display, on EGL's surfaceless platform, for tools
+// that render offscreen. Mesa falls back to llvmpipe without a GPU. Draw into a framebuffer object;
+// there is no default framebuffer.
+class HeadlessContext
+{
+private:
+	EGLDisplay m_display;
+	EGLContext m_context;
+public:
+	HeadlessContext();
+	~HeadlessContext();
+
+	HeadlessContext(const HeadlessContext&) = delete;
+	HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+	// Creates the context, makes it current on this thread and loads the GL functions
+	bool Create();
+};
@@ -0,0 +1,1269 @@
+#include "MazeRenderer.h"
+#include "Cube3D.h"
+#include <algorithm>
+#include <cmath>
+
+GLuint Shader::s_vbo = 0U;
+GLuint Shader::s_vao = 0U;
+GLuint Shader::s_shaderProgram = 0U;
+GLint  Shader::s_posUniform = 0;
+GLint  Shader::s_colUniform = 0;
+
+void Shader::Init(int mazeWidth, int mazeHeight)
+{
+	float data[8];
+
+	data[0] = 1.0f / (float)mazeWidth;
+	data[1] = 0.0f;
+
+	data[2] = 1.0f / (float)mazeWidth;
+	data[3] = 1.0f / (float)mazeHeight;
+
+	data[4] = 0.0f;
+	data[5] = 1.0f / (float)mazeHeight;
+
+	data[6] = 0.0f;
+	data[7] = 0.0f;
+
+	glGenBuffers(1, &s_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, s_vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
+
+	glGenVertexArrays(1, &s_vao);
+	glBindVertexArray(s_vao);
+	glVertexAttribPointer(0U, 2, GL_FLOAT, GL_FALSE, 8, (void*)0);
+	glEnableVertexAttribArray(0U);
+
+	const GLchar* vs_source = R"(
+#version 330 core
+
+layout(location = 0) in vec2 v_pos;
+
+uniform vec2 u_pos;
+
+void main()
+{
+	gl_Position = vec4(((v_pos.x + u_pos.x) * 2.0) - 1.0, ((v_pos.y + u_pos.y) * 2.0) - 1.0, 0.0, 1.0);
+}
+)";
+	const GLchar* fs_source = R"(
+#version 330 core
+
+uniform vec3 u_col;
+
+out vec4 f_color;
+
+void main()
+{
+	f_color = vec4(u_col.r, u_col.g, u_col.b, 1.0);
+}
+)";
+
+	s_shaderProgram = glCreateProgram();
+	GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+	GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(vs, 1, &vs_source, 0);
+	glShaderSource(fs, 1, &fs_source, 0);
+	glCompileShader(vs);
+	glCompileShader(fs);
+	glAttachShader(s_shaderProgram, vs);
+	glAttachShader(s_shaderProgram, fs);
+	glLinkProgram(s_shaderProgram);
+	glDeleteShader(vs);
+	glDeleteShader(fs);
+
+	s_posUniform = glGetUniformLocation(s_shaderProgram, "u_pos");
+	s_colUniform = glGetUniformLocation(s_shaderProgram, "u_col");
+}
+
+void Shader::Cleanup()
+{
+	glDeleteBuffers(1, &s_vbo);
+	glDeleteVertexArrays(1, &s_vao);
+	glDeleteProgram(s_shaderProgram);
+}
+
+void MazeGeometryRenderer::RenderCell(const Maze& maze, int x, int y)
+{
+	int64_t index = maze.GetIndex(x, y);
+	byte walls = maze.GetWalls(index);
+	glUniform2f(Shader::GetPosUniform(), (float)x / maze.GetWidth(), (float)y / maze.GetHeight());
+	switch (maze.GetState(index))
+	{
+	case CELL_VISITED:
+		glUniform3f(Shader::GetColUniform(), 0.1f, 0.8f, 0.5f);
+		break;
+	case CELL_BACKTRACKED:
+		glUniform3f(Shader::GetColUniform(), 0.1f, 0.6f, 0.8f);
+		break;
+	case CELL_GOAL:
+		glUniform3f(Shader::GetColUniform(), 1.0f, 0.9f, 0.75f);
+		break;
+	default:
+		if ((x + y) % 2 == 0)
+			glUniform3f(Shader::GetColUniform(), 0.1f, 0.7f, 0.6f);
+		else
+			glUniform3f(Shader::GetColUniform(), 0.1f, 0.7f, 0.65f);
+		break;
+	}
+	Shader::BindCell();
+	glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+	glUniform3f(Shader::GetColUniform(), 0.0f, 0.0f, 0.0f);
+	glDepthFunc(GL_ALWAYS);
+	if (walls & WALL_UP) // Top wall
+		glDrawArrays(GL_LINES, 1, 2);
+	if (walls & WALL_DOWN) // Bottom wall
+		glDrawArrays(GL_LINES, 3, 2);
+	if (walls & WALL_LEFT) // Left wall
+		glDrawArrays(GL_LINES, 2, 2);
+	if (walls & WALL_RIGHT) // Right wall
+		glDrawArrays(GL_LINES, 0, 2);
+	glDepthFunc(GL_LESS);
+}
+
+void MazeGeometryRenderer::Render(const Maze& maze)
+{
+	for (int i = 0; i < maze.GetWidth(); i++)
+	{
+		for (int j = 0; j < maze.GetHeight(); j++)
+		{
+			RenderCell(maze, i, j);
+		}
+	}
+}
+
+// A batch of changed cells goes up as the one rectangle around them while that is at most this
+// many texels per cell, and texel by texel when the cells are too scattered
+#define BATCH_TEXELS_PER_CELL 64
+
+// Copies the given cells of the maze into the R8UI texture, which is laid out like the maze, and
+// returns the rectangle around them. cells must not be empty.
+static void UploadCells(GLuint texture, const Maze& maze, const std::vector<int64_t>& cells, int& left, int& right, int& bottom, int& top)
+{
+	maze.GetPosition(cells[0], left, bottom);
+	right = left;
+	top = bottom;
+	for (int64_t index : cells)
+	{
+		int x, y;
+		maze.GetPosition(index, x, y);
+		left = std::min(left, x);
+		right = std::max(right, x);
+		bottom = std::min(bottom, y);
+		top = std::max(top, y);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	int64_t area = (int64_t)(right - left + 1) * (top - bottom + 1);
+	if (area <= (int64_t)cells.size() * BATCH_TEXELS_PER_CELL)
+	{
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, maze.GetWidth());
+		glTexSubImage2D(GL_TEXTURE_2D, 0, left, bottom, right - left + 1, top - bottom + 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE,
+			maze.GetData() + maze.GetIndex(left, bottom));
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	}
+	else
+	{
+		for (int64_t index : cells)
+		{
+			int x, y;
+			maze.GetPosition(index, x, y);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, maze.GetData() + index);
+		}
+	}
+}
+
+GLuint MazeTextureRenderer::s_vao = 0U;
+GLuint MazeTextureRenderer::s_texture = 0U;
+GLuint MazeTextureRenderer::s_shaderProgram = 0U;
+GLint  MazeTextureRenderer::s_cellsUniform = 0;
+
+void MazeTextureRenderer::Init(int mazeWidth, int mazeHeight)
+{
+	// Attribute-less full-screen triangle, but core profile still wants a VAO bound
+	glGenVertexArrays(1, &s_vao);
+
+	glGenTextures(1, &s_texture);
+	glBindTexture(GL_TEXTURE_2D, s_texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, mazeWidth, mazeHeight, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+	const GLchar* vs_source = R"(
+#version 330 core
+
+out vec2 v_uv;
+
+void main()
+{
+	vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	v_uv = pos;
+	gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+	const GLchar* fs_source = R"(
+#version 330 core
+
+in vec2 v_uv;
+
+uniform usampler2D u_cells;
+
+out vec4 f_color;
+
+void main()
+{
+	ivec2 size = textureSize(u_cells, 0);
+	vec2 pos = v_uv * vec2(size);
+	ivec2 cell = clamp(ivec2(floor(pos)), ivec2(0), size - 1);
+	uint texel = texelFetch(u_cells, cell, 0).r;
+
+	vec3 color;
+	uint state = texel & 0x30u;
+	if (state == 0x10u)
+		color = vec3(0.1, 0.8, 0.5);
+	else if (state == 0x20u)
+		color = vec3(0.1, 0.6, 0.8);
+	else if (state == 0x30u)
+		color = vec3(1.0, 0.9, 0.75);
+	else if ((cell.x + cell.y) % 2 == 0)
+		color = vec3(0.1, 0.7, 0.6);
+	else
+		color = vec3(0.1, 0.7, 0.65);
+
+	// Distance in pixels to the nearest edge of this cell that still has a wall.
+	// Each side of a shared wall draws half of it, so the full wall ends up ~2px wide.
+	vec2 local = pos - vec2(cell);
+	vec2 cellsPerPixel = fwidth(pos);
+	float dist = 1e6;
+	if ((texel & 0x01u) != 0u) dist = min(dist, (1.0 - local.y) / cellsPerPixel.y);
+	if ((texel & 0x02u) != 0u) dist = min(dist, local.y / cellsPerPixel.y);
+	if ((texel & 0x04u) != 0u) dist = min(dist, local.x / cellsPerPixel.x);
+	if ((texel & 0x08u) != 0u) dist = min(dist, (1.0 - local.x) / cellsPerPixel.x);
+
+	float wall = 1.0 - smoothstep(0.5, 1.5, dist);
+	f_color = vec4(mix(color, vec3(0.0), wall), 1.0);
+}
+)";
+
+	s_shaderProgram = glCreateProgram();
+	GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+	GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(vs, 1, &vs_source, 0);
+	glShaderSource(fs, 1, &fs_source, 0);
+	glCompileShader(vs);
+	glCompileShader(fs);
+	glAttachShader(s_shaderProgram, vs);
+	glAttachShader(s_shaderProgram, fs);
+	glLinkProgram(s_shaderProgram);
+	glDeleteShader(vs);
+	glDeleteShader(fs);
+
+	s_cellsUniform = glGetUniformLocation(s_shaderProgram, "u_cells");
+	glUseProgram(s_shaderProgram);
+	glUniform1i(s_cellsUniform, 0);
+}
+
+void MazeTextureRenderer::Upload(const Maze& maze)
+{
+	glBindTexture(GL_TEXTURE_2D, s_texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, maze.GetWidth(), maze.GetHeight(), GL_RED_INTEGER, GL_UNSIGNED_BYTE, maze.GetData());
+}
+
+void MazeTextureRenderer::UpdateCell(const Maze& maze, int64_t index)
+{
+	int x, y;
+	maze.GetPosition(index, x, y);
+	byte texel = maze.GetCell(index);
+	glBindTexture(GL_TEXTURE_2D, s_texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, &texel);
+}
+
+void MazeTextureRenderer::UpdateCells(const Maze& maze, const std::vector<int64_t>& cells)
+{
+	if (cells.empty())
+		return;
+	int left, right, bottom, top;
+	UploadCells(s_texture, maze, cells, left, right, bottom, top);
+}
+
+void MazeTextureRenderer::Render()
+{
+	glUseProgram(s_shaderProgram);
+	glBindVertexArray(s_vao);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, s_texture);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+void MazeTextureRenderer::Cleanup()
+{
+	glDeleteVertexArrays(1, &s_vao);
+	glDeleteTextures(1, &s_texture);
+	glDeleteProgram(s_shaderProgram);
+}
+
+GLuint MazeOverviewRenderer::s_vao = 0U;
+GLuint MazeOverviewRenderer::s_cellTexture = 0U;
+GLuint MazeOverviewRenderer::s_summaryTexture = 0U;
+GLuint MazeOverviewRenderer::s_framebuffer = 0U;
+GLuint MazeOverviewRenderer::s_shaderProgram = 0U;
+GLuint MazeOverviewRenderer::s_reduceProgram = 0U;
+GLint  MazeOverviewRenderer::s_centerUniform = 0;
+GLint  MazeOverviewRenderer::s_scaleUniform = 0;
+GLint  MazeOverviewRenderer::s_viewportUniform = 0;
+GLint  MazeOverviewRenderer::s_markerUniform = 0;
+GLint  MazeOverviewRenderer::s_fromCellsUniform = 0;
+GLint  MazeOverviewRenderer::s_targetSizeUniform = 0;
+int    MazeOverviewRenderer::s_width = 0;
+int    MazeOverviewRenderer::s_height = 0;
+std::vector<std::pair<int, int>> MazeOverviewRenderer::s_levelSizes;
+int    MazeOverviewRenderer::s_dirtyLeft = 0;
+int    MazeOverviewRenderer::s_dirtyRight = -1;
+int    MazeOverviewRenderer::s_dirtyBottom = 0;
+int    MazeOverviewRenderer::s_dirtyTop = -1;
+
+void MazeOverviewRenderer::Init(int mazeWidth, int mazeHeight)
+{
+	s_width = mazeWidth;
+	s_height = mazeHeight;
+	glGenVertexArrays(1, &s_vao);
+
+	glGenTextures(1, &s_cellTexture);
+	glBindTexture(GL_TEXTURE_2D, s_cellTexture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, mazeWidth, mazeHeight, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+	// Level 0 halves the maze rounding up, so no cell is left out; the levels after it halve
+	// rounding down like any mip chain, and their last row and column take in the odd one left over
+	s_levelSizes.clear();
+	int levelWidth = (mazeWidth + 1) / 2;
+	int levelHeight = (mazeHeight + 1) / 2;
+	while (true)
+	{
+		s_levelSizes.push_back(std::make_pair(levelWidth, levelHeight));
+		if (levelWidth == 1 and levelHeight == 1)
+			break;
+		levelWidth = std::max(levelWidth / 2, 1);
+		levelHeight = std::max(levelHeight / 2, 1);
+	}
+	glGenTextures(1, &s_summaryTexture);
+	glBindTexture(GL_TEXTURE_2D, s_summaryTexture);
+	for (int level = 0; level < (int)s_levelSizes.size(); level++)
+	{
+		glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, s_levelSizes[level].first, s_levelSizes[level].second, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)s_levelSizes.size() - 1);
+	glGenFramebuffers(1, &s_framebuffer);
+
+	const GLchar* vs_source = R"(
+#version 330 core
+
+void main()
+{
+	vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+	// One summary texel from the cells or from the level below, which is the only level the
+	// summary sampler can see while this one is being written
+	const GLchar* reduce_source = R"(
+#version 330 core
+
+uniform usampler2D u_cells;
+uniform sampler2D u_summary;
+uniform bool u_fromCells;
+uniform ivec2 u_targetSize;
+
+out vec4 f_summary;
+
+vec4 Summarize(uint texel)
+{
+	uint walls = texel & 0x0fu;
+	float sides = float((walls & 1u) + ((walls >> 1) & 1u) + ((walls >> 2) & 1u) + (walls >> 3)) * 0.25;
+	uint state = texel & 0x30u;
+	return vec4(sides, state == 0x10u ? 1.0 : 0.0, state == 0x20u ? 1.0 : 0.0, state == 0x30u ? 1.0 : 0.0);
+}
+
+void main()
+{
+	ivec2 target = ivec2(gl_FragCoord.xy);
+	ivec2 size = u_fromCells ? textureSize(u_cells, 0) : textureSize(u_summary, 0);
+	ivec2 first = target * 2;
+	ivec2 last = min(first + 1 + ivec2(equal(target, u_targetSize - 1)), size - 1);
+
+	vec4 sum = vec4(0.0);
+	for (int y = first.y; y <= last.y; y++)
+	{
+		for (int x = first.x; x <= last.x; x++)
+		{
+			sum += u_fromCells ? Summarize(texelFetch(u_cells, ivec2(x, y), 0).r) : texelFetch(u_summary, ivec2(x, y), 0);
+		}
+	}
+	ivec2 count = last - first + 1;
+	f_summary = sum / float(count.x * count.y);
+}
+)";
+
+	// Close up, cells and walls are drawn exactly like MazeTextureRenderer does; further out than
+	// two pixels a cell, the summary of a pixel's worth of cells is blended trilinearly
+	const GLchar* fs_source = R"(
+#version 330 core
+
+uniform usampler2D u_cells;
+uniform sampler2D u_summary;
+uniform vec2 u_center;
+uniform float u_cellsPerPixel;
+uniform vec4 u_viewport;
+uniform ivec2 u_marker;
+
+out vec4 f_color;
+
+void main()
+{
+	vec2 pos = u_center + (gl_FragCoord.xy - u_viewport.xy - u_viewport.zw * 0.5) * u_cellsPerPixel;
+	ivec2 size = textureSize(u_cells, 0);
+	if (any(lessThan(pos, vec2(0.0))) || any(greaterThanEqual(pos, vec2(size))))
+	{
+		f_color = vec4(0.05, 0.05, 0.05, 1.0);
+		return;
+	}
+	if (distance(pos, vec2(u_marker) + 0.5) < max(0.3, 3.0 * u_cellsPerPixel))
+	{
+		f_color = vec4(0.9, 0.25, 0.0, 1.0);
+		return;
+	}
+
+	vec3 color;
+	if (u_cellsPerPixel < 0.5)
+	{
+		ivec2 cell = ivec2(floor(pos));
+		uint texel = texelFetch(u_cells, cell, 0).r;
+		uint state = texel & 0x30u;
+		if (state == 0x10u)
+			color = vec3(0.1, 0.8, 0.5);
+		else if (state == 0x20u)
+			color = vec3(0.1, 0.6, 0.8);
+		else if (state == 0x30u)
+			color = vec3(1.0, 0.9, 0.75);
+		else if ((cell.x + cell.y) % 2 == 0)
+			color = vec3(0.1, 0.7, 0.6);
+		else
+			color = vec3(0.1, 0.7, 0.65);
+
+		vec2 local = pos - vec2(cell);
+		float dist = 1e6;
+		if ((texel & 0x01u) != 0u) dist = min(dist, 1.0 - local.y);
+		if ((texel & 0x02u) != 0u) dist = min(dist, local.y);
+		if ((texel & 0x04u) != 0u) dist = min(dist, local.x);
+		if ((texel & 0x08u) != 0u) dist = min(dist, 1.0 - local.x);
+		float wall = 1.0 - smoothstep(0.5, 1.5, dist / u_cellsPerPixel);
+		color = mix(color, vec3(0.0), wall);
+	}
+	else
+	{
+		// Level 0 texels are two cells wide
+		vec2 uv = pos / (2.0 * vec2(textureSize(u_summary, 0)));
+		vec4 summary = textureLod(u_summary, uv, log2(u_cellsPerPixel) - 1.0);
+		color = vec3(0.1, 0.7, 0.625);
+		color = mix(color, vec3(0.1, 0.8, 0.5), summary.g);
+		color = mix(color, vec3(0.1, 0.6, 0.8), summary.b);
+		color = mix(color, vec3(1.0, 0.9, 0.75), summary.a);
+		color *= 1.0 - 0.7 * summary.r;
+	}
+	f_color = vec4(color, 1.0);
+}
+)";
+
+	s_reduceProgram = glCreateProgram();
+	GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+	GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(vs, 1, &vs_source, 0);
+	glShaderSource(fs, 1, &reduce_source, 0);
+	glCompileShader(vs);
+	glCompileShader(fs);
+	glAttachShader(s_reduceProgram, vs);
+	glAttachShader(s_reduceProgram, fs);
+	glLinkProgram(s_reduceProgram);
+	glDeleteShader(fs);
+
+	s_shaderProgram = glCreateProgram();
+	fs = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(fs, 1, &fs_source, 0);
+	glCompileShader(fs);
+	glAttachShader(s_shaderProgram, vs);
+	glAttachShader(s_shaderProgram, fs);
+	glLinkProgram(s_shaderProgram);
+	glDeleteShader(vs);
+	glDeleteShader(fs);
+
+	s_fromCellsUniform = glGetUniformLocation(s_reduceProgram, "u_fromCells");
+	s_targetSizeUniform = glGetUniformLocation(s_reduceProgram, "u_targetSize");
+	glUseProgram(s_reduceProgram);
+	glUniform1i(glGetUniformLocation(s_reduceProgram, "u_cells"), 0);
+	glUniform1i(glGetUniformLocation(s_reduceProgram, "u_summary"), 1);
+
+	s_centerUniform = glGetUniformLocation(s_shaderProgram, "u_center");
+	s_scaleUniform = glGetUniformLocation(s_shaderProgram, "u_cellsPerPixel");
+	s_viewportUniform = glGetUniformLocation(s_shaderProgram, "u_viewport");
+	s_markerUniform = glGetUniformLocation(s_shaderProgram, "u_marker");
+	glUseProgram(s_shaderProgram);
+	glUniform1i(glGetUniformLocation(s_shaderProgram, "u_cells"), 0);
+	glUniform1i(glGetUniformLocation(s_shaderProgram, "u_summary"), 1);
+
+	s_dirtyLeft = 0;
+	s_dirtyRight = -1;
+	s_dirtyBottom = 0;
+	s_dirtyTop = -1;
+}
+
+void MazeOverviewRenderer::Upload(const Maze& maze)
+{
+	glBindTexture(GL_TEXTURE_2D, s_cellTexture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, maze.GetWidth(), maze.GetHeight(), GL_RED_INTEGER, GL_UNSIGNED_BYTE, maze.GetData());
+	s_dirtyLeft = 0;
+	s_dirtyRight = s_width - 1;
+	s_dirtyBottom = 0;
+	s_dirtyTop = s_height - 1;
+}
+
+void MazeOverviewRenderer::UpdateCell(const Maze& maze, int64_t index)
+{
+	int x, y;
+	maze.GetPosition(index, x, y);
+	byte texel = maze.GetCell(index);
+	glBindTexture(GL_TEXTURE_2D, s_cellTexture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, &texel);
+	MarkDirty(x, x, y, y);
+}
+
+void MazeOverviewRenderer::UpdateCells(const Maze& maze, const std::vector<int64_t>& cells)
+{
+	if (cells.empty())
+		return;
+	int left, right, bottom, top;
+	UploadCells(s_cellTexture, maze, cells, left, right, bottom, top);
+	MarkDirty(left, right, bottom, top);
+}
+
+void MazeOverviewRenderer::MarkDirty(int left, int right, int bottom, int top)
+{
+	if (s_dirtyLeft > s_dirtyRight)
+	{
+		s_dirtyLeft = left;
+		s_dirtyRight = right;
+		s_dirtyBottom = bottom;
+		s_dirtyTop = top;
+	}
+	else
+	{
+		s_dirtyLeft = std::min(s_dirtyLeft, left);
+		s_dirtyRight = std::max(s_dirtyRight, right);
+		s_dirtyBottom = std::min(s_dirtyBottom, bottom);
+		s_dirtyTop = std::max(s_dirtyTop, top);
+	}
+}
+
+// Redraws the changed rectangle of every level from the one below it. A texel of level n covers
+// the texels 2t and 2t + 1 of the level below, and the last one also 2t + 2 when that is left over.
+void MazeOverviewRenderer::Reduce()
+{
+	GLint previousFramebuffer;
+	GLint viewport[4];
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+	glDisable(GL_DEPTH_TEST);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, s_framebuffer);
+	glUseProgram(s_reduceProgram);
+	glBindVertexArray(s_vao);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, s_cellTexture);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, 0U);
+
+	int left = s_dirtyLeft;
+	int right = s_dirtyRight;
+	int bottom = s_dirtyBottom;
+	int top = s_dirtyTop;
+	for (int level = 0; level < (int)s_levelSizes.size(); level++)
+	{
+		int levelWidth = s_levelSizes[level].first;
+		int levelHeight = s_levelSizes[level].second;
+		left = std::min(left / 2, levelWidth - 1);
+		right = std::min(right / 2, levelWidth - 1);
+		bottom = std::min(bottom / 2, levelHeight - 1);
+		top = std::min(top / 2, levelHeight - 1);
+
+		// Level 0 is made from the cells alone, and the summary isn't bound while it is written
+		if (level == 1)
+		{
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, s_summaryTexture);
+		}
+		if (level > 0)
+		{
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level - 1);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level - 1);
+		}
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, s_summaryTexture, level);
+		glUniform1i(s_fromCellsUniform, level == 0);
+		glUniform2i(s_targetSizeUniform, levelWidth, levelHeight);
+		glViewport(left, bottom, right - left + 1, top - bottom + 1);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)s_levelSizes.size() - 1);
+	glActiveTexture(GL_TEXTURE0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	if (depthTest)
+		glEnable(GL_DEPTH_TEST);
+	s_dirtyLeft = 0;
+	s_dirtyRight = -1;
+}
+
+void MazeOverviewRenderer::Render(float centerX, float centerY, float cellsPerPixel, int markerX, int markerY)
+{
+	if (s_dirtyLeft <= s_dirtyRight)
+		Reduce();
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glUseProgram(s_shaderProgram);
+	glUniform2f(s_centerUniform, centerX, centerY);
+	glUniform1f(s_scaleUniform, cellsPerPixel);
+	glUniform4f(s_viewportUniform, (float)viewport[0], (float)viewport[1], (float)viewport[2], (float)viewport[3]);
+	glUniform2i(s_markerUniform, markerX, markerY);
+	glBindVertexArray(s_vao);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, s_cellTexture);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, s_summaryTexture);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void MazeOverviewRenderer::Cleanup()
+{
+	glDeleteVertexArrays(1, &s_vao);
+	glDeleteTextures(1, &s_cellTexture);
+	glDeleteTextures(1, &s_summaryTexture);
+	glDeleteFramebuffers(1, &s_framebuffer);
+	glDeleteProgram(s_shaderProgram);
+	glDeleteProgram(s_reduceProgram);
+	s_levelSizes.clear();
+}
+
+GLuint MazeAtlasRenderer::s_vao = 0U;
+GLuint MazeAtlasRenderer::s_cellTexture = 0U;
+GLuint MazeAtlasRenderer::s_colorTexture = 0U;
+GLuint MazeAtlasRenderer::s_framebuffer = 0U;
+GLuint MazeAtlasRenderer::s_pixelBuffers[2] = { 0U, 0U };
+GLuint MazeAtlasRenderer::s_shaderProgram = 0U;
+int    MazeAtlasRenderer::s_mazeWidth = 0;
+int    MazeAtlasRenderer::s_mazeHeight = 0;
+int    MazeAtlasRenderer::s_tileSize = 0;
+int    MazeAtlasRenderer::s_columns = 0;
+int    MazeAtlasRenderer::s_rows = 0;
+
+void MazeAtlasRenderer::Init(int mazeWidth, int mazeHeight, int tileSize, int columns, int rows)
+{
+	s_mazeWidth = mazeWidth;
+	s_mazeHeight = mazeHeight;
+	s_tileSize = tileSize;
+	s_columns = columns;
+	s_rows = rows;
+
+	glGenVertexArrays(1, &s_vao);
+
+	glGenTextures(1, &s_cellTexture);
+	glBindTexture(GL_TEXTURE_2D, s_cellTexture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, mazeWidth * columns, mazeHeight * rows, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+	glGenTextures(1, &s_colorTexture);
+	glBindTexture(GL_TEXTURE_2D, s_colorTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, GetAtlasWidth(), GetAtlasHeight(), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+	GLint previousFramebuffer;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+	glGenFramebuffers(1, &s_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, s_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, s_colorTexture, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+	glGenBuffers(2, s_pixelBuffers);
+	for (GLuint buffer : s_pixelBuffers)
+	{
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+		glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)GetAtlasWidth() * GetAtlasHeight() * 3, nullptr, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	const GLchar* vs_source = R"(
+#version 330 core
+
+void main()
+{
+	vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+	const GLchar* fs_source = R"(
+#version 330 core
+
+uniform usampler2D u_cells;
+uniform ivec2 u_mazeSize;
+uniform int u_tileSize;
+uniform vec2 u_margin;          // Pixels between a tile's corner and its maze
+uniform float u_cellsPerPixel;
+
+out vec4 f_color;
+
+void main()
+{
+	ivec2 tile = ivec2(gl_FragCoord.xy) / u_tileSize;
+	vec2 pos = (gl_FragCoord.xy - vec2(tile * u_tileSize) - u_margin) * u_cellsPerPixel;
+	if (any(lessThan(pos, vec2(0.0))) || any(greaterThanEqual(pos, vec2(u_mazeSize))))
+	{
+		f_color = vec4(1.0);
+		return;
+	}
+	ivec2 cell = ivec2(floor(pos));
+	uint texel = texelFetch(u_cells, tile * u_mazeSize + cell, 0).r;
+
+	// Same colours as MazeTextureRenderer
+	vec3 color;
+	uint state = texel & 0x30u;
+	if (state == 0x10u)
+		color = vec3(0.1, 0.8, 0.5);
+	else if (state == 0x20u)
+		color = vec3(0.1, 0.6, 0.8);
+	else if (state == 0x30u)
+		color = vec3(1.0, 0.9, 0.75);
+	else
+		color = vec3(0.1, 0.7, 0.6);
+
+	// Walls about a pixel wide, however small the cells
+	vec2 local = pos - vec2(cell);
+	float dist = 1e6;
+	if ((texel & 0x01u) != 0u) dist = min(dist, 1.0 - local.y);
+	if ((texel & 0x02u) != 0u) dist = min(dist, local.y);
+	if ((texel & 0x04u) != 0u) dist = min(dist, local.x);
+	if ((texel & 0x08u) != 0u) dist = min(dist, 1.0 - local.x);
+	float wall = 1.0 - smoothstep(0.25, 0.75, dist / u_cellsPerPixel);
+	f_color = vec4(mix(color, vec3(0.0), wall), 1.0);
+}
+)";
+
+	s_shaderProgram = glCreateProgram();
+	GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+	GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(vs, 1, &vs_source, 0);
+	glShaderSource(fs, 1, &fs_source, 0);
+	glCompileShader(vs);
+	glCompileShader(fs);
+	glAttachShader(s_shaderProgram, vs);
+	glAttachShader(s_shaderProgram, fs);
+	glLinkProgram(s_shaderProgram);
+	glDeleteShader(vs);
+	glDeleteShader(fs);
+
+	// The maze is centred in its tile with at least a pixel of border
+	float cellsPerPixel = std::max(mazeWidth, mazeHeight) / (float)std::max(tileSize - 2, 1);
+	glUseProgram(s_shaderProgram);
+	glUniform1i(glGetUniformLocation(s_shaderProgram, "u_cells"), 0);
+	glUniform2i(glGetUniformLocation(s_shaderProgram, "u_mazeSize"), mazeWidth, mazeHeight);
+	glUniform1i(glGetUniformLocation(s_shaderProgram, "u_tileSize"), tileSize);
+	glUniform2f(glGetUniformLocation(s_shaderProgram, "u_margin"), (tileSize - mazeWidth / cellsPerPixel) * 0.5f,
+		(tileSize - mazeHeight / cellsPerPixel) * 0.5f);
+	glUniform1f(glGetUniformLocation(s_shaderProgram, "u_cellsPerPixel"), cellsPerPixel);
+}
+
+void MazeAtlasRenderer::UploadTile(int tile, const Maze& maze)
+{
+	glBindTexture(GL_TEXTURE_2D, s_cellTexture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, (tile % s_columns) * s_mazeWidth, (tile / s_columns) * s_mazeHeight, s_mazeWidth, s_mazeHeight,
+		GL_RED_INTEGER, GL_UNSIGNED_BYTE, maze.GetData());
+}
+
+void MazeAtlasRenderer::Render(int buffer)
+{
+	GLint previousFramebuffer;
+	GLint viewport[4];
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+	glDisable(GL_DEPTH_TEST);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, s_framebuffer);
+	glViewport(0, 0, GetAtlasWidth(), GetAtlasHeight());
+	glUseProgram(s_shaderProgram);
+	glBindVertexArray(s_vao);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, s_cellTexture);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	// Into the pixel buffer, so the call returns before the copy is done
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, s_pixelBuffers[buffer]);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, GetAtlasWidth(), GetAtlasHeight(), GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	if (depthTest)
+		glEnable(GL_DEPTH_TEST);
+}
+
+const byte* MazeAtlasRenderer::MapPixels(int buffer)
+{
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, s_pixelBuffers[buffer]);
+	const byte* pPixels = (const byte*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)GetAtlasWidth() * GetAtlasHeight() * 3, GL_MAP_READ_BIT);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	return pPixels;
+}
+
+void MazeAtlasRenderer::UnmapPixels(int buffer)
+{
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, s_pixelBuffers[buffer]);
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void MazeAtlasRenderer::Cleanup()
+{
+	glDeleteVertexArrays(1, &s_vao);
+	glDeleteTextures(1, &s_cellTexture);
+	glDeleteTextures(1, &s_colorTexture);
+	glDeleteFramebuffers(1, &s_framebuffer);
+	glDeleteBuffers(2, s_pixelBuffers);
+	glDeleteProgram(s_shaderProgram);
+}
+
+std::vector<MazeFirstPersonRenderer::Chunk> MazeFirstPersonRenderer::s_chunks;
+std::vector<byte> MazeFirstPersonRenderer::s_instanceData;
+std::vector<std::pair<float, int>> MazeFirstPersonRenderer::s_visibleChunks;
+std::vector<int64_t> MazeFirstPersonRenderer::s_drawnCells;
+int    MazeFirstPersonRenderer::s_chunksX = 0;
+int    MazeFirstPersonRenderer::s_chunksY = 0;
+int    MazeFirstPersonRenderer::s_drawnWalls = 0;
+const MazeVisibility* MazeFirstPersonRenderer::s_pVisibility = nullptr;
+GLuint MazeFirstPersonRenderer::s_visibleVao = 0U;
+GLuint MazeFirstPersonRenderer::s_visibleInstances = 0U;
+GLuint MazeFirstPersonRenderer::s_diffuseTexture = 0U;
+GLuint MazeFirstPersonRenderer::s_specularTexture = 0U;
+GLuint MazeFirstPersonRenderer::s_shaderProgram = 0U;
+GLint  MazeFirstPersonRenderer::s_projUniform = 0;
+GLint  MazeFirstPersonRenderer::s_viewUniform = 0;
+GLint  MazeFirstPersonRenderer::s_chunkUniform = 0;
+
+// Kinds of instance; each is four bytes: x and y of the cell inside the chunk, kind, unused.
+// Every wall belongs to one cell only: up and right walls to the cell they bound, down and left
+// walls only along the maze border.
+#define INSTANCE_WALL_UP    0
+#define INSTANCE_WALL_RIGHT 1
+#define INSTANCE_WALL_DOWN  2
+#define INSTANCE_WALL_LEFT  3
+
+// Cube3D's indices list the four side faces first. The eye never rises above a wall or sinks
+// below one, so the top and bottom faces are never seen and aren't drawn.
+#define WALL_INDEX_COUNT 24
+
+// A box is outside the frustum when it lies wholly behind one plane, tested at the box corner
+// furthest along that plane's normal
+static bool IsBoxInFrustum(const glm::vec4 planes[6], const glm::vec3& boxMin, const glm::vec3& boxMax)
+{
+	for (int i = 0; i < 6; i++)
+	{
+		glm::vec3 corner(planes[i].x >= 0.0f ? boxMax.x : boxMin.x, planes[i].y >= 0.0f ? boxMax.y : boxMin.y, planes[i].z >= 0.0f ? boxMax.z : boxMin.z);
+		if (glm::dot(glm::vec3(planes[i]), corner) + planes[i].w < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+// Cube3D's mesh plus an instance buffer, advanced once per instance
+void MazeFirstPersonRenderer::CreateWallArray(GLuint& vao, GLuint& instances)
+{
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, Cube3D::GetVertexBuffer());
+	glVertexAttribPointer(0U, 3, GL_FLOAT, GL_FALSE, 32, (void*)0);
+	glVertexAttribPointer(1U, 3, GL_FLOAT, GL_FALSE, 32, (void*)12);
+	glVertexAttribPointer(2U, 2, GL_FLOAT, GL_FALSE, 32, (void*)24);
+	glEnableVertexAttribArray(0U);
+	glEnableVertexAttribArray(1U);
+	glEnableVertexAttribArray(2U);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Cube3D::GetIndexBuffer());
+
+	glGenBuffers(1, &instances);
+	glBindBuffer(GL_ARRAY_BUFFER, instances);
+	glVertexAttribIPointer(3U, 4, GL_UNSIGNED_BYTE, 4, (void*)0);
+	glVertexAttribDivisor(3U, 1U);
+	glEnableVertexAttribArray(3U);
+}
+
+void MazeFirstPersonRenderer::Init(int mazeWidth, int mazeHeight)
+{
+	// Bricks of 8x4 texels in offset rows with dark mortar, one texture repeat per cell
+	byte diffusePixels[16 * 16 * 3];
+	for (int y = 0; y < 16; y++)
+	{
+		for (int x = 0; x < 16; x++)
+		{
+			int row = y / 4;
+			int shiftedX = (x + (row % 2) * 4) % 16;
+			bool mortar = y % 4 == 0 or shiftedX % 8 == 0;
+			byte shade = (byte)(((row * 5 + shiftedX / 8 * 3) % 4) * 10);
+			byte* pixel = &diffusePixels[(y * 16 + x) * 3];
+			pixel[0] = mortar ? 60 : 150 + shade;
+			pixel[1] = mortar ? 56 : 90 + shade;
+			pixel[2] = mortar ? 52 : 70 + shade;
+		}
+	}
+	const byte specularPixel[3] = { 40, 40, 40 };
+
+	glGenTextures(1, &s_diffuseTexture);
+	glBindTexture(GL_TEXTURE_2D, s_diffuseTexture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 16, 16, 0, GL_RGB, GL_UNSIGNED_BYTE, diffusePixels);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	glGenTextures(1, &s_specularTexture);
+	glBindTexture(GL_TEXTURE_2D, s_specularTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, specularPixel);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	// Maze x and y map to world x and -z, so the mesh is only ever scaled by positive factors and
+	// keeps its winding and normals
+	const GLchar* vs_source = R"(
+#version 330 core
+
+layout(location = 0) in vec3 v_in_pos;
+layout(location = 1) in vec3 v_in_nor;
+layout(location = 2) in vec2 v_in_uv;
+layout(location = 3) in uvec4 v_in_wall;
+
+uniform mat4 u_projection;
+uniform mat4 u_view;
+uniform vec2 u_chunk;
+
+out vec3 v_out_pos;
+out vec3 v_out_nor;
+out vec2 v_out_uv;
+
+const float HALF_THICKNESS = 0.06;
+
+void main()
+{
+	vec2 cell = vec2(v_in_wall.xy);
+	vec3 center;   // Maze x, height, maze y
+	vec3 halfSize; // World x, y, z
+	if (v_in_wall.z == 0u)
+	{
+		center = vec3(cell.x + 0.5, 0.5, cell.y + 1.0);
+		halfSize = vec3(0.5 + HALF_THICKNESS, 0.5, HALF_THICKNESS);
+	}
+	else if (v_in_wall.z == 1u)
+	{
+		center = vec3(cell.x + 1.0, 0.5, cell.y + 0.5);
+		halfSize = vec3(HALF_THICKNESS, 0.5, 0.5 + HALF_THICKNESS);
+	}
+	else if (v_in_wall.z == 2u)
+	{
+		center = vec3(cell.x + 0.5, 0.5, cell.y);
+		halfSize = vec3(0.5 + HALF_THICKNESS, 0.5, HALF_THICKNESS);
+	}
+	else
+	{
+		center = vec3(cell.x, 0.5, cell.y + 0.5);
+		halfSize = vec3(HALF_THICKNESS, 0.5, 0.5 + HALF_THICKNESS);
+	}
+	center.xz += u_chunk;
+
+	vec4 world = vec4(vec3(center.x, center.y, -center.z) + v_in_pos * halfSize, 1.0);
+	vec4 view = u_view * world;
+	gl_Position = u_projection * view;
+	v_out_pos = vec3(view);
+	v_out_nor = mat3(u_view) * v_in_nor;
+	v_out_uv  = v_in_uv;
+}
+)";
+	const GLchar* fs_source = Cube3D::GetFragmentSource();
+
+	s_shaderProgram = glCreateProgram();
+	GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+	GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(vs, 1, &vs_source, 0);
+	glShaderSource(fs, 1, &fs_source, 0);
+	glCompileShader(vs);
+	glCompileShader(fs);
+	glAttachShader(s_shaderProgram, vs);
+	glAttachShader(s_shaderProgram, fs);
+	glLinkProgram(s_shaderProgram);
+	glDeleteShader(vs);
+	glDeleteShader(fs);
+
+	s_projUniform = glGetUniformLocation(s_shaderProgram, "u_projection");
+	s_viewUniform = glGetUniformLocation(s_shaderProgram, "u_view");
+	s_chunkUniform = glGetUniformLocation(s_shaderProgram, "u_chunk");
+	glUseProgram(s_shaderProgram);
+	glUniform1i(glGetUniformLocation(s_shaderProgram, "u_diffuse"), 0);
+	glUniform1i(glGetUniformLocation(s_shaderProgram, "u_specular"), 1);
+
+	s_chunksX = (mazeWidth + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	s_chunksY = (mazeHeight + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	s_chunks.assign((size_t)s_chunksX * s_chunksY, Chunk{ 0U, 0U, 0, true });
+	CreateWallArray(s_visibleVao, s_visibleInstances);
+	s_pVisibility = nullptr;
+	glBindVertexArray(0U);
+}
+
+void MazeFirstPersonRenderer::BuildChunk(const Maze& maze, int chunk)
+{
+	const int chunkX = chunk % s_chunksX;
+	const int chunkY = chunk / s_chunksX;
+	const int left = chunkX * CHUNK_SIZE;
+	const int bottom = chunkY * CHUNK_SIZE;
+	const int width = std::min(CHUNK_SIZE, maze.GetWidth() - left);
+	const int height = std::min(CHUNK_SIZE, maze.GetHeight() - bottom);
+
+	s_instanceData.clear();
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			byte walls = maze.GetWalls(left + x, bottom + y);
+			const byte candidates[4][2] = {
+				{ WALL_UP, INSTANCE_WALL_UP },
+				{ WALL_RIGHT, INSTANCE_WALL_RIGHT },
+				{ (byte)(bottom + y == 0 ? WALL_DOWN : 0), INSTANCE_WALL_DOWN },
+				{ (byte)(left + x == 0 ? WALL_LEFT : 0), INSTANCE_WALL_LEFT }
+			};
+			for (int i = 0; i < 4; i++)
+			{
+				if (walls & candidates[i][0])
+				{
+					const byte instance[4] = { (byte)x, (byte)y, candidates[i][1], 0U };
+					s_instanceData.insert(s_instanceData.end(), instance, instance + 4);
+				}
+			}
+		}
+	}
+
+	Chunk& target = s_chunks[chunk];
+	if (target.vao == 0U)
+	{
+		CreateWallArray(target.vao, target.instances);
+		glBindVertexArray(0U);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, target.instances);
+	glBufferData(GL_ARRAY_BUFFER, s_instanceData.size(), s_instanceData.data(), GL_STATIC_DRAW);
+	target.count = (GLsizei)(s_instanceData.size() / 4);
+	target.dirty = false;
+}
+
+void MazeFirstPersonRenderer::Upload(const Maze&)
+{
+	for (Chunk& chunk : s_chunks)
+	{
+		chunk.dirty = true;
+	}
+	s_pVisibility = nullptr;
+}
+
+void MazeFirstPersonRenderer::UpdateCell(const Maze& maze, int64_t index)
+{
+	int x, y;
+	maze.GetPosition(index, x, y);
+	s_chunks[(y / CHUNK_SIZE) * s_chunksX + x / CHUNK_SIZE].dirty = true;
+}
+
+void MazeFirstPersonRenderer::Render(const Maze& maze, float eyeX, float eyeY, float yaw, float aspect)
+{
+	glm::vec3 eye(eyeX, 0.5f, -eyeY);
+	glm::vec3 forward(sinf(yaw), 0.0f, -cosf(yaw));
+	glm::mat4 viewMat = glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projMat = glm::perspective(glm::radians(75.0f), aspect, 0.05f, VIEW_DISTANCE);
+
+	// Frustum planes (normal pointing inwards, offset) from the rows of the combined matrix
+	glm::mat4 clip = projMat * viewMat;
+	glm::vec4 planes[6];
+	for (int i = 0; i < 3; i++)
+	{
+		glm::vec4 row(clip[0][i], clip[1][i], clip[2][i], clip[3][i]);
+		glm::vec4 w(clip[0][3], clip[1][3], clip[2][3], clip[3][3]);
+		planes[i * 2] = w + row;
+		planes[i * 2 + 1] = w - row;
+	}
+
+	s_visibleChunks.clear();
+	s_instanceData.clear();
+	s_drawnWalls = 0;
+	const int eyeCellX = std::min(std::max((int)eyeX, 0), maze.GetWidth() - 1);
+	const int eyeCellY = std::min(std::max((int)eyeY, 0), maze.GetHeight() - 1);
+	const int originX = eyeCellX - 128;
+	const int originY = eyeCellY - 128;
+	if (s_pVisibility != nullptr)
+	{
+		// Only the runs of cells visible from the eye's cell that pass the frustum test, each cell
+		// with all of its walls. Down and left walls go in as the up and right walls of the cells
+		// beyond, and only when that cell isn't drawn too, so a wall seen from both sides is one
+		// instance. Runs come in row-major order, so the row below is already in s_drawnCells.
+		// Everything is within VISIBILITY_RANGE of the eye, so offsets from a point 128 cells down
+		// and left of it fit in a byte.
+		s_drawnCells.clear();
+		s_pVisibility->ForEachRun(maze.GetIndex(eyeCellX, eyeCellY), [&](int64_t start, int64_t length)
+		{
+			int x, y;
+			maze.GetPosition(start, x, y);
+			glm::vec3 boxMin(x - 0.1f, 0.0f, -(y + 1) - 0.1f);
+			glm::vec3 boxMax(x + length + 0.1f, 1.0f, -y + 0.1f);
+			if (!IsBoxInFrustum(planes, boxMin, boxMax))
+				return;
+
+			byte cellY = (byte)(y - originY);
+			for (int i = 0; i < (int)length; i++)
+			{
+				byte walls = maze.GetWalls(start + i);
+				byte cellX = (byte)(x + i - originX);
+				bool belowDrawn = y > 0 and std::binary_search(s_drawnCells.begin(), s_drawnCells.end(), start + i - maze.GetWidth());
+				const byte candidates[4][4] = {
+					{ WALL_UP, cellX, cellY, INSTANCE_WALL_UP },
+					{ WALL_RIGHT, cellX, cellY, INSTANCE_WALL_RIGHT },
+					{ (byte)(belowDrawn ? 0 : WALL_DOWN), cellX, (byte)(cellY - 1), INSTANCE_WALL_UP },
+					{ (byte)(i == 0 ? WALL_LEFT : 0), (byte)(cellX - 1), cellY, INSTANCE_WALL_RIGHT }
+				};
+				for (int j = 0; j < 4; j++)
+				{
+					if (walls & candidates[j][0])
+					{
+						const byte instance[4] = { candidates[j][1], candidates[j][2], candidates[j][3], 0U };
+						s_instanceData.insert(s_instanceData.end(), instance, instance + 4);
+					}
+				}
+				s_drawnCells.push_back(start + i);
+			}
+		});
+		s_drawnWalls = (int)(s_instanceData.size() / 4);
+	}
+	else
+	{
+		// Only chunks within VIEW_DISTANCE of the eye can be in the frustum, so the cost of culling
+		// doesn't grow with the maze, and those are the only ones ever built
+		const int reach = (int)VIEW_DISTANCE / CHUNK_SIZE + 1;
+		const int eyeChunkX = eyeCellX / CHUNK_SIZE;
+		const int eyeChunkY = eyeCellY / CHUNK_SIZE;
+		for (int chunkY = std::max(eyeChunkY - reach, 0); chunkY <= std::min(eyeChunkY + reach, s_chunksY - 1); chunkY++)
+		{
+			for (int chunkX = std::max(eyeChunkX - reach, 0); chunkX <= std::min(eyeChunkX + reach, s_chunksX - 1); chunkX++)
+			{
+				float left = (float)(chunkX * CHUNK_SIZE);
+				float bottom = (float)(chunkY * CHUNK_SIZE);
+				float right = std::min(left + CHUNK_SIZE, (float)maze.GetWidth());
+				float top = std::min(bottom + CHUNK_SIZE, (float)maze.GetHeight());
+				// Walls stick out of their chunk by half their thickness
+				glm::vec3 boxMin(left - 0.1f, 0.0f, -top - 0.1f);
+				glm::vec3 boxMax(right + 0.1f, 1.0f, -bottom + 0.1f);
+				if (IsBoxInFrustum(planes, boxMin, boxMax))
+				{
+					int chunk = chunkY * s_chunksX + chunkX;
+					if (s_chunks[chunk].dirty)
+						BuildChunk(maze, chunk);
+					glm::vec3 offset = (boxMin + boxMax) * 0.5f - eye;
+					s_visibleChunks.push_back(std::make_pair(glm::dot(offset, offset), chunk));
+					s_drawnWalls += s_chunks[chunk].count;
+				}
+			}
+		}
+		std::sort(s_visibleChunks.begin(), s_visibleChunks.end());
+	}
+
+	// The camera never pitches, so the horizon is always halfway up: floor and sky are two clears
+	GLint viewport[4];
+	GLfloat clearColor[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(viewport[0], viewport[1], viewport[2], viewport[3] / 2);
+	glClearColor(0.25f, 0.22f, 0.2f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glScissor(viewport[0], viewport[1] + viewport[3] / 2, viewport[2], viewport[3] - viewport[3] / 2);
+	glClearColor(0.45f, 0.6f, 0.8f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glDisable(GL_SCISSOR_TEST);
+	glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+
+	glUseProgram(s_shaderProgram);
+	glUniformMatrix4fv(s_projUniform, 1, GL_FALSE, &projMat[0][0]);
+	glUniformMatrix4fv(s_viewUniform, 1, GL_FALSE, &viewMat[0][0]);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, s_diffuseTexture);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, s_specularTexture);
+	if (s_pVisibility != nullptr)
+	{
+		glUniform2f(s_chunkUniform, (float)originX, (float)originY);
+		glBindVertexArray(s_visibleVao);
+		glBindBuffer(GL_ARRAY_BUFFER, s_visibleInstances);
+		glBufferData(GL_ARRAY_BUFFER, s_instanceData.size(), s_instanceData.data(), GL_STREAM_DRAW);
+		glDrawElementsInstanced(GL_TRIANGLES, WALL_INDEX_COUNT, GL_UNSIGNED_BYTE, (void*)0, s_drawnWalls);
+	}
+	for (const std::pair<float, int>& visible : s_visibleChunks)
+	{
+		int chunk = visible.second;
+		glUniform2f(s_chunkUniform, (float)(chunk % s_chunksX * CHUNK_SIZE), (float)(chunk / s_chunksX * CHUNK_SIZE));
+		glBindVertexArray(s_chunks[chunk].vao);
+		glDrawElementsInstanced(GL_TRIANGLES, WALL_INDEX_COUNT, GL_UNSIGNED_BYTE, (void*)0, s_chunks[chunk].count);
+	}
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void MazeFirstPersonRenderer::Cleanup()
+{
+	for (Chunk& chunk : s_chunks)
+	{
+		if (chunk.vao != 0U)
+		{
+			glDeleteVertexArrays(1, &chunk.vao);
+			glDeleteBuffers(1, &chunk.instances);
+		}
+	}
+	s_chunks.clear();
+	glDeleteVertexArrays(1, &s_visibleVao);
+	glDeleteBuffers(1, &s_visibleInstances);
+	s_pVisibility = nullptr;
+	glDeleteTextures(1, &s_diffuseTexture);
+	glDeleteTextures(1, &s_specularTexture);
+	glDeleteProgram(s_shaderProgram);
+}
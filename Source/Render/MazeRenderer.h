@@ -0,0 +1,246 @@
+#pragma once
+#include <glad/glad.h>
+#include "../Core/Maze.h"
+#include "../Core/MazeVisibility.h"
+#include <utility>
+#include <vector>
+
+// Unit quad one cell in size, with a solid color shader. Used by the per-cell renderer and the player.
+class Shader
+{
+private:
+	static GLuint s_vbo;
+	static GLuint s_vao;
+	static GLuint s_shaderProgram;
+	static GLint s_posUniform;
+	static GLint s_colUniform;
+public:
+	static void Init(int mazeWidth, int mazeHeight);
+	static void Cleanup();
+
+	static void Use()
+	{
+		glUseProgram(s_shaderProgram);
+	}
+
+	static void BindCell()
+	{
+		glBindVertexArray(s_vao);
+	}
+
+	static GLint GetPosUniform()
+	{
+		return s_posUniform;
+	}
+
+	static GLint GetColUniform()
+	{
+		return s_colUniform;
+	}
+};
+
+// The old per-cell path: one quad plus up to four line draws per cell
+class MazeGeometryRenderer
+{
+public:
+	static void RenderCell(const Maze& maze, int x, int y);
+	static void Render(const Maze& maze);
+};
+
+// The whole maze in one full-screen pass, reading walls and states from an integer texture
+class MazeTextureRenderer
+{
+private:
+	static GLuint s_vao;
+	static GLuint s_texture;
+	static GLuint s_shaderProgram;
+	static GLint s_cellsUniform;
+public:
+	static void Init(int mazeWidth, int mazeHeight);
+
+	// The packed maze is already laid out like the texture, so it goes up as-is
+	static void Upload(const Maze& maze);
+	static void UpdateCell(const Maze& maze, int64_t index);
+
+	// One upload for a frame's worth of changed cells, however many the generator carved
+	static void UpdateCells(const Maze& maze, const std::vector<int64_t>& cells);
+
+	static void Render();
+	static void Cleanup();
+};
+
+// Zoomable map for mazes far bigger than the screen. Besides the cell texture it keeps a pyramid
+// of summaries, level n holding one texel per 2^(n+1) x 2^(n+1) cells: the share of cell sides
+// that are walls and the shares of visited, backtracked and goal cells. Each pixel reads the level
+// whose texels are closest to its own size, so a frame costs the same at any zoom. The pyramid is
+// reduced on the GPU, level by level, over the cells changed since the last frame only.
+class MazeOverviewRenderer
+{
+private:
+	static GLuint s_vao;
+	static GLuint s_cellTexture;
+	static GLuint s_summaryTexture;
+	static GLuint s_framebuffer;
+	static GLuint s_shaderProgram;
+	static GLuint s_reduceProgram;
+	static GLint s_centerUniform;
+	static GLint s_scaleUniform;
+	static GLint s_viewportUniform;
+	static GLint s_markerUniform;
+	static GLint s_fromCellsUniform;
+	static GLint s_targetSizeUniform;
+	static int s_width;
+	static int s_height;
+	static std::vector<std::pair<int, int>> s_levelSizes;
+	static int s_dirtyLeft;   // Cells changed since the last Reduce(), inclusive; empty if left > right
+	static int s_dirtyRight;
+	static int s_dirtyBottom;
+	static int s_dirtyTop;
+
+	static void MarkDirty(int left, int right, int bottom, int top);
+	static void Reduce();
+public:
+	static void Init(int mazeWidth, int mazeHeight);
+
+	static void Upload(const Maze& maze);
+	static void UpdateCell(const Maze& maze, int64_t index);
+	static void UpdateCells(const Maze& maze, const std::vector<int64_t>& cells);
+
+	// Fills the viewport with the maze around (centerX, centerY), in cells, at cellsPerPixel. The
+	// marker cell is drawn as a dot that stays a few pixels wide however far out the view is.
+	static void Render(float centerX, float centerY, float cellsPerPixel, int markerX, int markerY);
+
+	static int GetLevelCount()
+	{
+		return (int)s_levelSizes.size();
+	}
+
+	static void Cleanup();
+};
+
+// Thumbnails of many mazes of one size, drawn in one pass. Each maze goes into its tile of a cell
+// atlas, and a single full-screen pass draws every tile into an atlas framebuffer, tileSize pixels
+// a tile, columns x rows tiles. The atlas is read back through two pixel buffers in turn: Render()
+// starts the copy and returns, and the pixels are only mapped after the next batch has been
+// queued, so the GPU draws one batch while the CPU works on the one before.
+class MazeAtlasRenderer
+{
+private:
+	static GLuint s_vao;
+	static GLuint s_cellTexture;
+	static GLuint s_colorTexture;
+	static GLuint s_framebuffer;
+	static GLuint s_pixelBuffers[2];
+	static GLuint s_shaderProgram;
+	static int s_mazeWidth;
+	static int s_mazeHeight;
+	static int s_tileSize;
+	static int s_columns;
+	static int s_rows;
+public:
+	// The cell atlas is columns * mazeWidth x rows * mazeHeight and must fit GL_MAX_TEXTURE_SIZE
+	static void Init(int mazeWidth, int mazeHeight, int tileSize, int columns, int rows);
+
+	// Tiles are numbered row by row from the bottom left
+	static void UploadTile(int tile, const Maze& maze);
+
+	// Draws every tile and starts copying the atlas into pixel buffer 0 or 1
+	static void Render(int buffer);
+
+	// The atlas the last Render(buffer) drew, as tightly packed RGB rows from the bottom up. Waits
+	// for the copy if it isn't done; the pointer is valid until UnmapPixels(buffer).
+	static const byte* MapPixels(int buffer);
+	static void UnmapPixels(int buffer);
+
+	static int GetAtlasWidth()
+	{
+		return s_columns * s_tileSize;
+	}
+
+	static int GetAtlasHeight()
+	{
+		return s_rows * s_tileSize;
+	}
+
+	static void Cleanup();
+};
+
+// First-person view from inside the maze. Every wall is an instance of Cube3D's mesh squashed into a
+// slab and lit by Cube3D's shader. Instances are grouped by CHUNK_SIZE x CHUNK_SIZE cells, each
+// group in its own static buffer, created the first time the chunk is drawn and rebuilt only when
+// one of its cells has changed since. Chunks whose bounds fall outside the view frustum (which ends
+// at VIEW_DISTANCE) are skipped on the CPU and the rest are drawn nearest first, so the depth test
+// throws away most hidden walls before shading. Only chunks that come into view cost anything, so a
+// new maze, however big, is ready at once.
+class MazeFirstPersonRenderer
+{
+private:
+	struct Chunk
+	{
+		GLuint vao;         // 0 until the chunk is first drawn
+		GLuint instances;
+		GLsizei count;
+		bool dirty;
+	};
+
+	static std::vector<Chunk> s_chunks;
+	static std::vector<byte> s_instanceData;
+	static std::vector<std::pair<float, int>> s_visibleChunks; // Squared distance, chunk
+	static std::vector<int64_t> s_drawnCells; // Visible cells that passed the frustum, ascending
+	static int s_chunksX;
+	static int s_chunksY;
+	static int s_drawnWalls;
+	static const MazeVisibility* s_pVisibility;
+	static GLuint s_visibleVao;       // Instances picked from the eye cell's visible set, refilled every frame
+	static GLuint s_visibleInstances;
+	static GLuint s_diffuseTexture;
+	static GLuint s_specularTexture;
+	static GLuint s_shaderProgram;
+	static GLint s_projUniform;
+	static GLint s_viewUniform;
+	static GLint s_chunkUniform;
+
+	static void CreateWallArray(GLuint& vao, GLuint& instances);
+	static void BuildChunk(const Maze& maze, int chunk);
+public:
+	static const int CHUNK_SIZE = 16;
+	static constexpr float VIEW_DISTANCE = 32.0f;
+
+	// Range to build the MazeVisibility with: the corners of the far plane are within this many
+	// cells of the eye for aspect ratios up to 2:1
+	static const int VISIBILITY_RANGE = 64;
+
+	// Past this many cells a visible set takes too long and too much memory to build, and the
+	// chunks are drawn instead
+	static const int64_t VISIBILITY_MAX_CELLS = 4 * 1024 * 1024;
+
+	// Cube3D::Init() must have run first; the mesh is shared
+	static void Init(int mazeWidth, int mazeHeight);
+
+	// Only marks every chunk; each is rebuilt when Render() next draws it. Also drops the visible
+	// set, which belongs to the previous maze.
+	static void Upload(const Maze& maze);
+
+	// Draws only what can be seen from the eye's cell instead of every chunk in the frustum. The
+	// set must have been built from the maze that is rendered, with VISIBILITY_RANGE, and stays
+	// in use until the next Upload(); nullptr goes back to the chunks.
+	static void SetVisibility(const MazeVisibility* pVisibility)
+	{
+		s_pVisibility = pVisibility;
+	}
+
+	// Only marks the cell's chunk; it is rebuilt once by the next Render() that draws it
+	static void UpdateCell(const Maze& maze, int64_t index);
+
+	// Eye at (eyeX, eyeY) in cells, half a wall high. yaw is a compass heading in radians: 0 looks
+	// towards WALL_UP, pi / 2 towards WALL_RIGHT.
+	static void Render(const Maze& maze, float eyeX, float eyeY, float yaw, float aspect);
+
+	// Wall instances drawn by the last Render()
+	static int GetDrawnWallCount()
+	{
+		return s_drawnWalls;
+	}
+
+	static void Cleanup();
+};
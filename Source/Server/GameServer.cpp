@@ -0,0 +1,476 @@
+#include "GameServer.h"
+#include "Protocol.h"
+#include "Socket.h"
+#include "../Core/MazeCodec.h"
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+static const uint64_t LISTEN_EVENT = ~0ULL;
+static const int MAX_MAZE_SIDE = 4096;
+
+// Bytes a client may leave unread before it is dropped; a single message always fits
+#define SERVER_OUTPUT_LIMIT (4 << 20)
+
+GameServer::GameServer(const GameServerConfig& config)
+	:m_config(config), m_pool(config.threads), m_slots(), m_freeSlots(), m_clients(), m_freeClients(), m_closedClients(), m_listenFd(-1), m_epollFd(-1),
+	m_tick(0), m_seedCounter((uint64_t)time(NULL)), m_nextSessionId(1), m_activeSessions(0), m_completedMutex(), m_completed(),
+	m_generatorPool(config.generatorThreads), m_workNanoseconds(0), m_statsTicks(0), m_statsSessionTicks(0),
+	m_statsTickSeconds(0.0), m_statsStart(std::chrono::steady_clock::now())
+{
+	Random random(config.width * 31 + config.height);
+	for (int i = 0; i < config.bots; i++)
+	{
+		CreateSession(config.width, config.height, random.Next64(), -1, true);
+	}
+}
+
+GameServer::~GameServer()
+{
+	for (size_t i = 0; i < m_clients.size(); i++)
+	{
+		if (m_clients[i].fd >= 0)
+			CloseSocket(m_clients[i].fd);
+	}
+	if (m_listenFd >= 0)
+		CloseSocket(m_listenFd);
+	if (m_epollFd >= 0)
+		close(m_epollFd);
+}
+
+bool GameServer::Listen(const char* address)
+{
+	SocketAddress parsed;
+	if (!ParseSocketAddress(address, parsed))
+	{
+		fprintf(stderr, "Bad listen address '%s'\n", address);
+		return false;
+	}
+	m_listenFd = ListenSocket(parsed);
+	if (m_listenFd < 0 or !SetNonBlocking(m_listenFd))
+		return false;
+
+	m_epollFd = epoll_create1(0);
+	epoll_event event = {};
+	event.events = EPOLLIN;
+	event.data.u64 = LISTEN_EVENT;
+	if (m_epollFd < 0 or epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenFd, &event) != 0)
+	{
+		perror("epoll");
+		return false;
+	}
+	printf("Listening on %s\n", address);
+	return true;
+}
+
+int GameServer::CreateSession(int width, int height, uint64_t seed, int client, bool bot)
+{
+	int slot;
+	if (!m_freeSlots.empty())
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		slot = (int)m_slots.size();
+		m_slots.emplace_back();
+	}
+	Slot& s = m_slots[slot];
+	// The slot stays empty, and out of the ticks, until the generator pool hands the session back
+	s.session.reset();
+	s.client = client;
+	s.pendingMoves = 0U;
+	s.bot = bot;
+	s.mazeReady = false;
+	s.dirty = false;
+	s.lastPlayer = -1;
+	s.random.Seed(seed);
+	s.id = m_nextSessionId++;
+	s.mazeMessage.clear();
+	GameSession* pSession = new GameSession(width, height, seed);
+	uint64_t id = s.id;
+	m_generatorPool.Submit([this, slot, id, pSession, bot]() { Generate(slot, id, pSession, !bot); });
+	return slot;
+}
+
+void GameServer::DestroySession(int slot)
+{
+	Slot& s = m_slots[slot];
+	if (s.session)
+		m_activeSessions--;
+	s.session.reset();
+	s.client = -1;
+	s.id = 0;
+	std::vector<byte>().swap(s.mazeMessage);
+	m_freeSlots.push_back(slot);
+}
+
+// Generator pool: carves the maze and, for a client, encodes its MSG_MAZE
+void GameServer::Generate(int slot, uint64_t id, GameSession* pSession, bool encode)
+{
+	std::unique_ptr<GameSession> session(pSession);
+	session->Generate();
+	std::vector<byte> message;
+	if (encode)
+	{
+		const Maze& maze = session->GetMaze();
+		message.push_back(MSG_MAZE);
+		PutU32(message, (uint32_t)slot);
+		PutU16(message, maze.GetWidth());
+		PutU16(message, maze.GetHeight());
+		PutU32(message, (uint32_t)session->GetPlayer());
+		PutU32(message, (uint32_t)session->GetGoal());
+		PutU32(message, 0);
+		MazeCodec::Encode(maze, message);
+		uint32_t size = (uint32_t)(message.size() - MSG_MAZE_HEADER_SIZE);
+		for (int i = 0; i < 4; i++)
+		{
+			message[MSG_MAZE_HEADER_SIZE - 4 + i] = (byte)(size >> (i * 8));
+		}
+	}
+	std::lock_guard<std::mutex> lock(m_completedMutex);
+	m_completed.push_back(Completion{ slot, id, std::move(session), std::move(message) });
+}
+
+// Puts the sessions finished since the last tick into their slots, unless they were dropped meanwhile
+void GameServer::DrainCompleted()
+{
+	std::vector<Completion> completed;
+	{
+		std::lock_guard<std::mutex> lock(m_completedMutex);
+		completed.swap(m_completed);
+	}
+	for (Completion& completion : completed)
+	{
+		Slot& s = m_slots[completion.slot];
+		if (s.id != completion.id)
+			continue;
+		s.session = std::move(completion.session);
+		s.mazeMessage = std::move(completion.message);
+		s.mazeReady = true;
+		s.lastPlayer = s.session->GetPlayer();
+		m_activeSessions++;
+	}
+}
+
+void GameServer::TickBatch(size_t begin, size_t end)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (size_t i = begin; i < end; i++)
+	{
+		Slot& slot = m_slots[i];
+		if (!slot.session)
+			continue;
+		GameSession& session = *slot.session;
+
+		byte moves = slot.pendingMoves;
+		slot.pendingMoves = 0U;
+		if (slot.bot)
+		{
+			// Stand-in for a player: one random step through an open wall
+			byte open = ~session.GetMaze().GetWalls(session.GetPlayer()) & WALL_ALL;
+			moves = 0U;
+			while (open != 0U and (moves & open) == 0U)
+			{
+				moves = 0x01 << slot.random.Next(4);
+			}
+		}
+
+		session.Tick(moves);
+		if (session.GetPlayer() != slot.lastPlayer)
+		{
+			slot.lastPlayer = session.GetPlayer();
+			slot.dirty = true;
+		}
+	}
+	std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+	m_workNanoseconds.fetch_add((uint64_t)elapsed.count(), std::memory_order_relaxed);
+}
+
+void GameServer::TickSessions()
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	m_pool.ParallelFor(m_slots.size(), (size_t)m_config.batchSize, [this](size_t begin, size_t end) { TickBatch(begin, end); });
+	m_tick++;
+
+	m_statsTicks++;
+	m_statsSessionTicks += m_activeSessions;
+	m_statsTickSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void GameServer::SendUpdates()
+{
+	std::vector<byte> message;
+	for (size_t i = 0; i < m_slots.size(); i++)
+	{
+		Slot& slot = m_slots[i];
+		if (!slot.session or slot.client < 0)
+			continue;
+		const GameSession& session = *slot.session;
+		if (slot.mazeReady)
+		{
+			slot.mazeReady = false;
+			// A client that falls too far behind loses its session here
+			if (!Send(slot.client, slot.mazeMessage))
+				continue;
+			std::vector<byte>().swap(slot.mazeMessage);
+		}
+		if (slot.dirty)
+		{
+			message.clear();
+			message.push_back(MSG_STATE);
+			PutU32(message, (uint32_t)m_tick);
+			PutU32(message, (uint32_t)session.GetPlayer());
+			message.push_back(session.IsWon() ? 1 : 0);
+			slot.dirty = false;
+			Send(slot.client, message);
+		}
+	}
+	for (size_t i = 0; i < m_clients.size(); i++)
+	{
+		if (m_clients[i].fd >= 0 and !m_clients[i].out.empty() and !m_clients[i].writeBlocked)
+			Flush((int)i);
+	}
+}
+
+void GameServer::Accept()
+{
+	while (true)
+	{
+		int fd = accept(m_listenFd, nullptr, nullptr);
+		if (fd < 0)
+		{
+			if (errno != EAGAIN and errno != EWOULDBLOCK)
+				perror("accept");
+			return;
+		}
+		SetNonBlocking(fd);
+
+		int client;
+		if (!m_freeClients.empty())
+		{
+			client = m_freeClients.back();
+			m_freeClients.pop_back();
+		}
+		else
+		{
+			client = (int)m_clients.size();
+			m_clients.emplace_back();
+		}
+		Client& c = m_clients[client];
+		c.fd = fd;
+		c.slot = -1;
+		c.in.clear();
+		c.out.clear();
+		c.writeBlocked = false;
+
+		epoll_event event = {};
+		event.events = EPOLLIN;
+		event.data.u64 = (uint64_t)client;
+		epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event);
+	}
+}
+
+void GameServer::Receive(int client)
+{
+	Client& c = m_clients[client];
+	byte buffer[4096];
+	while (true)
+	{
+		ssize_t count = recv(c.fd, buffer, sizeof(buffer), 0);
+		if (count > 0)
+		{
+			c.in.insert(c.in.end(), buffer, buffer + count);
+			continue;
+		}
+		if (count == 0 or (errno != EAGAIN and errno != EWOULDBLOCK))
+		{
+			Disconnect(client);
+			return;
+		}
+		break;
+	}
+
+	size_t offset = 0;
+	while (offset < c.in.size())
+	{
+		const byte* message = c.in.data() + offset;
+		size_t available = c.in.size() - offset;
+		if (message[0] == MSG_JOIN)
+		{
+			if (available < MSG_JOIN_SIZE)
+				break;
+			int width = (int)GetU16(message + 1);
+			int height = (int)GetU16(message + 3);
+			uint64_t seed = GetU64(message + 5);
+			if (width < 1 or height < 1 or width > MAX_MAZE_SIDE or height > MAX_MAZE_SIDE or (int64_t)width * height > m_config.maxCells)
+			{
+				Disconnect(client);
+				return;
+			}
+			if (seed == 0U)
+				seed = Random(m_seedCounter++).Next64();
+			if (c.slot < 0)
+				c.slot = CreateSession(width, height, seed, client, false);
+			offset += MSG_JOIN_SIZE;
+		}
+		else if (message[0] == MSG_INPUT)
+		{
+			if (available < MSG_INPUT_SIZE)
+				break;
+			if (c.slot >= 0)
+				m_slots[c.slot].pendingMoves |= message[1] & WALL_ALL;
+			offset += MSG_INPUT_SIZE;
+		}
+		else
+		{
+			Disconnect(client);
+			return;
+		}
+	}
+	c.in.erase(c.in.begin(), c.in.begin() + offset);
+}
+
+bool GameServer::Send(int client, const std::vector<byte>& message)
+{
+	Client& c = m_clients[client];
+	if (!c.out.empty() and c.out.size() + message.size() > SERVER_OUTPUT_LIMIT)
+	{
+		Disconnect(client);
+		return false;
+	}
+	c.out.insert(c.out.end(), message.begin(), message.end());
+	return true;
+}
+
+void GameServer::Flush(int client)
+{
+	Client& c = m_clients[client];
+	size_t sent = 0;
+	while (sent < c.out.size())
+	{
+		ssize_t count = send(c.fd, c.out.data() + sent, c.out.size() - sent, MSG_NOSIGNAL);
+		if (count < 0)
+		{
+			if (errno == EAGAIN or errno == EWOULDBLOCK)
+				break;
+			Disconnect(client);
+			return;
+		}
+		sent += (size_t)count;
+	}
+	c.out.erase(c.out.begin(), c.out.begin() + sent);
+
+	bool blocked = !c.out.empty();
+	if (blocked != c.writeBlocked)
+	{
+		c.writeBlocked = blocked;
+		UpdatePollEvents(client);
+	}
+}
+
+void GameServer::UpdatePollEvents(int client)
+{
+	epoll_event event = {};
+	event.events = EPOLLIN | (m_clients[client].writeBlocked ? (uint32_t)EPOLLOUT : 0U);
+	event.data.u64 = (uint64_t)client;
+	epoll_ctl(m_epollFd, EPOLL_CTL_MOD, m_clients[client].fd, &event);
+}
+
+void GameServer::Disconnect(int client)
+{
+	Client& c = m_clients[client];
+	if (c.fd < 0)
+		return;
+	CloseSocket(c.fd);
+	c.fd = -1;
+	if (c.slot >= 0)
+		DestroySession(c.slot);
+	c.slot = -1;
+	c.in.clear();
+	c.out.clear();
+	// Not reusable until the current batch of poll events has been handled
+	m_closedClients.push_back(client);
+}
+
+void GameServer::ReportStats(bool force)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double elapsed = std::chrono::duration<double>(now - m_statsStart).count();
+	if (!force and elapsed < m_config.statsInterval)
+		return;
+	if (m_statsTicks == 0)
+		return;
+
+	double workSeconds = m_workNanoseconds.exchange(0) * 1e-9;
+	printf("tick %llu: %d sessions, %.3f ms/tick, %.0f session-ticks/s, %.0f session-ticks per core-second (%d threads)\n",
+		(unsigned long long)m_tick, m_activeSessions, m_statsTickSeconds * 1000.0 / m_statsTicks,
+		m_statsSessionTicks / elapsed, workSeconds > 0.0 ? m_statsSessionTicks / workSeconds : 0.0, m_pool.GetThreadCount());
+	fflush(stdout);
+
+	m_statsTicks = 0;
+	m_statsSessionTicks = 0;
+	m_statsTickSeconds = 0.0;
+	m_statsStart = now;
+}
+
+void GameServer::Run()
+{
+	typedef std::chrono::steady_clock Clock;
+	const Clock::duration period = m_config.tickRate > 0 ? Clock::duration(std::chrono::nanoseconds(1000000000LL / m_config.tickRate)) : Clock::duration::zero();
+	Clock::time_point nextTick = Clock::now();
+	m_statsStart = nextTick;
+
+	std::vector<epoll_event> events(256);
+	while (m_config.ticks == 0 or m_tick < m_config.ticks)
+	{
+		if (m_epollFd >= 0)
+		{
+			int timeout = 0;
+			Clock::duration wait = nextTick - Clock::now();
+			if (wait > Clock::duration::zero())
+				timeout = (int)std::chrono::duration_cast<std::chrono::milliseconds>(wait).count() + 1;
+			int count = epoll_wait(m_epollFd, events.data(), (int)events.size(), timeout);
+			for (int i = 0; i < count; i++)
+			{
+				if (events[i].data.u64 == LISTEN_EVENT)
+				{
+					Accept();
+					continue;
+				}
+				int client = (int)events[i].data.u64;
+				if (m_clients[client].fd < 0)
+					continue;
+				if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+					Receive(client);
+				if (m_clients[client].fd >= 0 and (events[i].events & EPOLLOUT))
+					Flush(client);
+			}
+			m_freeClients.insert(m_freeClients.end(), m_closedClients.begin(), m_closedClients.end());
+			m_closedClients.clear();
+		}
+		else if (period > Clock::duration::zero())
+		{
+			std::this_thread::sleep_until(nextTick);
+		}
+
+		Clock::time_point now = Clock::now();
+		if (now >= nextTick)
+		{
+			DrainCompleted();
+			TickSessions();
+			SendUpdates();
+			ReportStats(false);
+			// Drop ticks instead of spiralling when the server falls behind
+			nextTick += period;
+			if (nextTick + period < now)
+				nextTick = now;
+		}
+	}
+	ReportStats(true);
+}
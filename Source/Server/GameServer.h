@@ -0,0 +1,117 @@
+#pragma once
+#include "../Core/GameSession.h"
+#include "../Core/Random.h"
+#include "../Core/ThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct GameServerConfig
+{
+	int threads = 0;          // 0 = one per core
+	int tickRate = 60;        // Ticks per second, 0 = as fast as possible
+	int batchSize = 256;      // Sessions per thread pool task
+	int bots = 0;             // In-process sessions driven by random input
+	int width = 20;           // Maze size for bots
+	int height = 15;
+	uint64_t ticks = 0;       // Stop after this many ticks, 0 = run forever
+	double statsInterval = 5.0;
+	int64_t maxCells = 1 << 20;  // Largest maze a client may join
+	int generatorThreads = 1;    // Threads generating and encoding new mazes, apart from the ticks
+};
+
+// Authoritative host for many independent GameSessions. Network I/O runs on the calling thread;
+// once per tick every session is advanced in batches on the thread pool. The two phases never
+// overlap, so sessions need no locking.
+//
+// A new session's maze is generated and encoded on a pool of its own, so a big one doesn't hold up
+// the ticks of the others; the finished session is handed back through a queue and joins the
+// ticks from then on.
+class GameServer
+{
+private:
+	struct Slot
+	{
+		std::unique_ptr<GameSession> session;
+		int client;          // Index into m_clients, -1 for bots and free slots
+		byte pendingMoves;
+		bool bot;
+		bool mazeReady;      // Generated, MSG_MAZE not sent yet
+		bool dirty;          // Player moved or won, MSG_STATE not sent yet
+		int64_t lastPlayer;
+		Random random;
+		uint64_t id;         // Tells a finished generation for this slot from one for a session since dropped
+		std::vector<byte> mazeMessage;
+	};
+
+	// A session generated on m_generatorPool, with its MSG_MAZE for a client
+	struct Completion
+	{
+		int slot;
+		uint64_t id;
+		std::unique_ptr<GameSession> session;
+		std::vector<byte> message;
+	};
+
+	struct Client
+	{
+		int fd;
+		int slot;
+		std::vector<byte> in;
+		std::vector<byte> out;
+		bool writeBlocked;
+	};
+
+	GameServerConfig m_config;
+	ThreadPool m_pool;
+	std::vector<Slot> m_slots;
+	std::vector<int> m_freeSlots;
+	std::vector<Client> m_clients;
+	std::vector<int> m_freeClients;
+	std::vector<int> m_closedClients;
+	int m_listenFd;
+	int m_epollFd;
+	uint64_t m_tick;
+	uint64_t m_seedCounter;
+	uint64_t m_nextSessionId;
+	int m_activeSessions;       // Generated and ticking
+	std::mutex m_completedMutex;
+	std::vector<Completion> m_completed;
+	ThreadPool m_generatorPool; // After the queue it fills, so it is stopped first
+
+	// Stats since the last report
+	std::atomic<uint64_t> m_workNanoseconds;
+	uint64_t m_statsTicks;
+	uint64_t m_statsSessionTicks;
+	double m_statsTickSeconds;
+	std::chrono::steady_clock::time_point m_statsStart;
+
+	int CreateSession(int width, int height, uint64_t seed, int client, bool bot);
+	void DestroySession(int slot);
+	void Generate(int slot, uint64_t id, GameSession* pSession, bool encode);
+	void DrainCompleted();
+	void TickSessions();
+	void TickBatch(size_t begin, size_t end);
+	void SendUpdates();
+
+	void Accept();
+	void Receive(int client);
+	void Flush(int client);
+	void Disconnect(int client);
+	// Queues the message; false if the client had too much unread and was disconnected instead
+	bool Send(int client, const std::vector<byte>& message);
+	void UpdatePollEvents(int client);
+
+	void ReportStats(bool force);
+public:
+	GameServer(const GameServerConfig& config);
+	~GameServer();
+
+	// Starts accepting clients; without a listener only the bots are simulated
+	bool Listen(const char* address);
+
+	// Runs until the configured tick count is reached, forever otherwise
+	void Run();
+};
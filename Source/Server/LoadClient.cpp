@@ -0,0 +1,239 @@
+// Stand-in clients for MazeServer: opens many connections, joins a session on each and
+// walks the maze with random moves, measuring input-to-state latency.
+#include "Protocol.h"
+#include "Socket.h"
+#include "../Core/MazeCodec.h"
+#include "../Core/Random.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+struct Connection
+{
+	int fd;                  // -1 once the server has closed it
+	std::vector<byte> in;
+	std::vector<byte> walls;
+	int width;
+	int player;
+	bool waiting;            // Sent a move, no state yet
+	Clock::time_point sentAt;
+};
+
+static bool SendAll(int fd, const std::vector<byte>& message)
+{
+	size_t sent = 0;
+	while (sent < message.size())
+	{
+		ssize_t count = send(fd, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+		if (count < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno != EAGAIN and errno != EWOULDBLOCK)
+				return false;
+			// Sleep until the socket buffer has room instead of spinning on send
+			pollfd writable = { fd, POLLOUT, 0 };
+			if (poll(&writable, 1, -1) < 0 and errno != EINTR)
+				return false;
+			continue;
+		}
+		sent += (size_t)count;
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	const char* address = nullptr;
+	int clients = 100;
+	int width = 20, height = 15;
+	double duration = 10.0;
+	double moveRate = 10.0;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--connect") == 0)
+			address = argv[i + 1];
+		else if (strcmp(argv[i], "--clients") == 0)
+			clients = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--size") == 0)
+		{
+			if (sscanf(argv[i + 1], "%dx%d", &width, &height) != 2 or width < 1 or height < 1)
+			{
+				fprintf(stderr, "Bad size '%s'\n", argv[i + 1]);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--duration") == 0)
+			duration = atof(argv[i + 1]);
+		else if (strcmp(argv[i], "--rate") == 0)
+		{
+			// Also the move period's divisor, so it has to be a positive number
+			moveRate = atof(argv[i + 1]);
+			if (!(moveRate > 0.0))
+			{
+				fprintf(stderr, "Bad rate '%s'\n", argv[i + 1]);
+				return 1;
+			}
+		}
+	}
+	SocketAddress parsed;
+	if (address == nullptr or !ParseSocketAddress(address, parsed))
+	{
+		printf("Usage: MazeLoadClient --connect ADDR [--clients N] [--size WxH] [--duration SECONDS] [--rate MOVES_PER_SECOND]\n");
+		return 1;
+	}
+
+	int epollFd = epoll_create1(0);
+	std::vector<Connection> connections;
+	Random random(12345U);
+	for (int i = 0; i < clients; i++)
+	{
+		int fd = ConnectSocket(parsed);
+		if (fd < 0)
+			break;
+		std::vector<byte> join;
+		join.push_back(MSG_JOIN);
+		PutU16(join, width);
+		PutU16(join, height);
+		PutU64(join, random.Next64());
+		SendAll(fd, join);
+		SetNonBlocking(fd);
+
+		epoll_event event = {};
+		event.events = EPOLLIN;
+		event.data.u64 = connections.size();
+		epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+		connections.push_back(Connection{ fd, {}, {}, 0, -1, false, Clock::now() });
+	}
+	printf("%zu clients connected\n", connections.size());
+
+	std::vector<double> latencies;
+	size_t mazesReceived = 0;
+	size_t disconnected = 0;
+	auto disconnect = [&](Connection& c)
+		{
+			epoll_ctl(epollFd, EPOLL_CTL_DEL, c.fd, nullptr);
+			CloseSocket(c.fd);
+			c.fd = -1;
+			disconnected++;
+		};
+	Clock::time_point start = Clock::now();
+	Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(duration));
+	Clock::duration movePeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / moveRate));
+	Clock::time_point nextMove = start;
+	std::vector<epoll_event> events(256);
+
+	while (Clock::now() < end and disconnected < connections.size())
+	{
+		int timeout = (int)std::max<long long>(0, std::chrono::duration_cast<std::chrono::milliseconds>(nextMove - Clock::now()).count());
+		int count = epoll_wait(epollFd, events.data(), (int)events.size(), timeout);
+		for (int e = 0; e < count; e++)
+		{
+			Connection& c = connections[events[e].data.u64];
+			byte buffer[65536];
+			ssize_t received;
+			while ((received = recv(c.fd, buffer, sizeof(buffer), 0)) > 0)
+			{
+				c.in.insert(c.in.end(), buffer, buffer + received);
+			}
+			// The messages that did arrive are still read below
+			if (received == 0 or (errno != EAGAIN and errno != EWOULDBLOCK and errno != EINTR))
+				disconnect(c);
+
+			size_t offset = 0;
+			while (offset < c.in.size())
+			{
+				const byte* message = c.in.data() + offset;
+				size_t available = c.in.size() - offset;
+				if (message[0] == MSG_MAZE)
+				{
+					if (available < MSG_MAZE_HEADER_SIZE)
+						break;
+					size_t size = GetU32(message + 17);
+					if (available < MSG_MAZE_HEADER_SIZE + size)
+						break;
+					Maze maze((int)GetU16(message + 5), (int)GetU16(message + 7));
+					if (!MazeCodec::Decode(message + MSG_MAZE_HEADER_SIZE, size, maze))
+					{
+						fprintf(stderr, "Bad maze data\n");
+						return 1;
+					}
+					c.width = maze.GetWidth();
+					c.player = (int)GetU32(message + 9);
+					c.walls.assign(maze.GetData(), maze.GetData() + maze.GetCellCount());
+					mazesReceived++;
+					offset += MSG_MAZE_HEADER_SIZE + size;
+				}
+				else if (message[0] == MSG_STATE)
+				{
+					if (available < MSG_STATE_SIZE)
+						break;
+					c.player = (int)GetU32(message + 5);
+					if (c.waiting)
+					{
+						latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - c.sentAt).count());
+						c.waiting = false;
+					}
+					offset += MSG_STATE_SIZE;
+				}
+				else
+				{
+					fprintf(stderr, "Unexpected message type %d\n", message[0]);
+					return 1;
+				}
+			}
+			c.in.erase(c.in.begin(), c.in.begin() + offset);
+		}
+
+		if (Clock::now() >= nextMove)
+		{
+			nextMove += movePeriod;
+			for (Connection& c : connections)
+			{
+				if (c.fd < 0 or c.walls.empty() or c.waiting)
+					continue;
+				byte open = ~c.walls[c.player] & WALL_ALL;
+				byte move = 0U;
+				while (open != 0U and (move & open) == 0U)
+				{
+					move = 0x01 << random.Next(4);
+				}
+				std::vector<byte> input;
+				input.push_back(MSG_INPUT);
+				input.push_back(move);
+				c.waiting = true;
+				c.sentAt = Clock::now();
+				if (!SendAll(c.fd, input))
+					disconnect(c);
+			}
+		}
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+	double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+	printf("%zu mazes, %zu moves in %.1f s (%.0f moves/s), %zu clients disconnected\n", mazesReceived, latencies.size(), elapsed,
+		latencies.size() / elapsed, disconnected);
+	if (!latencies.empty())
+	{
+		printf("latency ms: p50 %.2f  p90 %.2f  p99 %.2f  max %.2f\n", latencies[latencies.size() / 2],
+			latencies[latencies.size() * 9 / 10], latencies[latencies.size() * 99 / 100], latencies.back());
+	}
+	for (Connection& c : connections)
+	{
+		if (c.fd >= 0)
+			CloseSocket(c.fd);
+	}
+	close(epollFd);
+	return 0;
+}
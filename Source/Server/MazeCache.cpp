@@ -0,0 +1,56 @@
+#include "MazeCache.h"
+
+MazeCache::MazeCache(size_t capacityBytes, int shardCount)
+	:m_shards(new Shard[shardCount > 0 ? shardCount : 1]), m_shardCount(shardCount > 0 ? shardCount : 1), m_shardCapacity(0), m_hits(0),
+	m_misses(0), m_evictions(0)
+{
+	m_shardCapacity = capacityBytes / m_shardCount;
+}
+
+MazeBlob MazeCache::Find(const MazeKey& key)
+{
+	Shard& shard = GetShard(key);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto found = shard.index.find(key);
+	if (found == shard.index.end())
+	{
+		m_misses.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+	m_hits.fetch_add(1, std::memory_order_relaxed);
+	shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+	return found->second->blob;
+}
+
+void MazeCache::Insert(const MazeKey& key, const MazeBlob& blob)
+{
+	size_t size = blob->size();
+	if (size > m_shardCapacity)
+		return;
+	Shard& shard = GetShard(key);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	if (shard.index.find(key) != shard.index.end())
+		return;
+	while (shard.bytes + size > m_shardCapacity)
+	{
+		Entry& last = shard.entries.back();
+		shard.bytes -= last.blob->size();
+		shard.index.erase(last.key);
+		shard.entries.pop_back();
+		m_evictions.fetch_add(1, std::memory_order_relaxed);
+	}
+	shard.entries.push_front(Entry{ key, blob });
+	shard.index[key] = shard.entries.begin();
+	shard.bytes += size;
+}
+
+size_t MazeCache::GetBytes()
+{
+	size_t bytes = 0;
+	for (int i = 0; i < m_shardCount; i++)
+	{
+		std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+		bytes += m_shards[i].bytes;
+	}
+	return bytes;
+}
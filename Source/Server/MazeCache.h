@@ -0,0 +1,101 @@
+#pragma once
+#include "../Core/Maze.h"
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// What a generated maze is looked up by
+struct MazeKey
+{
+	int algorithm;
+	int format;
+	int width;
+	int height;
+	uint64_t seed;
+
+	bool operator==(const MazeKey& other) const
+	{
+		return algorithm == other.algorithm and format == other.format and width == other.width and height == other.height
+			and seed == other.seed;
+	}
+};
+
+struct MazeKeyHash
+{
+	size_t operator()(const MazeKey& key) const
+	{
+		// SplitMix64's finalizer over the fields
+		uint64_t h = key.seed ^ ((uint64_t)key.width << 32 | (uint32_t)key.height) * 0x9E3779B97F4A7C15ULL;
+		h ^= (uint64_t)(key.algorithm << 8 | key.format) * 0xBF58476D1CE4E5B9ULL;
+		h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+		return (size_t)(h ^ (h >> 31));
+	}
+};
+
+// An encoded maze, shared between the cache and the responses still being sent
+typedef std::shared_ptr<const std::vector<byte>> MazeBlob;
+
+// Least-recently-used cache of encoded mazes, bounded in bytes. Keys are spread over shards, each
+// with its own lock, list and map, so lookups and inserts from many threads rarely meet.
+class MazeCache
+{
+private:
+	struct Entry
+	{
+		MazeKey key;
+		MazeBlob blob;
+	};
+
+	struct Shard
+	{
+		std::mutex mutex;
+		std::list<Entry> entries; // Most recently used first
+		std::unordered_map<MazeKey, std::list<Entry>::iterator, MazeKeyHash> index;
+		size_t bytes = 0;
+	};
+
+	std::unique_ptr<Shard[]> m_shards;
+	int m_shardCount;
+	size_t m_shardCapacity;
+	std::atomic<uint64_t> m_hits;
+	std::atomic<uint64_t> m_misses;
+	std::atomic<uint64_t> m_evictions;
+
+	Shard& GetShard(const MazeKey& key)
+	{
+		// The high bits, so shards don't correlate with the maps' buckets
+		return m_shards[(MazeKeyHash()(key) >> 40) % m_shardCount];
+	}
+public:
+	MazeCache(size_t capacityBytes, int shardCount);
+
+	MazeCache(const MazeCache&) = delete;
+	MazeCache& operator=(const MazeCache&) = delete;
+
+	// nullptr on a miss
+	MazeBlob Find(const MazeKey& key);
+
+	// Mazes bigger than a whole shard aren't kept
+	void Insert(const MazeKey& key, const MazeBlob& blob);
+
+	uint64_t GetHits() const
+	{
+		return m_hits;
+	}
+
+	uint64_t GetMisses() const
+	{
+		return m_misses;
+	}
+
+	uint64_t GetEvictions() const
+	{
+		return m_evictions;
+	}
+
+	size_t GetBytes();
+};
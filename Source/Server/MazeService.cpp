@@ -0,0 +1,446 @@
+#include "MazeService.h"
+#include "Socket.h"
+#include "../Core/EllerMazeGenerator.h"
+#include "../Core/MazeCatalog.h"
+#include "../Core/MazeCodec.h"
+#include "../Core/MazeSerializer.h"
+#include "../Core/RandomMazeGenerator.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+typedef std::chrono::steady_clock Clock;
+
+// Output a client may have queued before its requests are left unread until it catches up
+#define SERVICE_OUTPUT_LIMIT (4 << 20)
+
+// Responses handed to one sendmsg
+#define SERVICE_WRITE_PARTS 64
+
+static const uint64_t LISTEN_EVENT = ~0ULL;
+static const uint64_t WAKE_EVENT = ~0ULL - 1;
+
+MazeService::MazeService(const MazeServiceConfig& config)
+	:m_config(config), m_cache(config.cacheBytes, config.cacheShards), m_pool(config.threads), m_clients(), m_freeClients(), m_closedClients(),
+	m_listenFd(-1), m_epollFd(-1), m_wakeFd(-1), m_pending(), m_completedMutex(), m_completed(), m_statsRequests(0), m_statsGenerated(0),
+	m_statsLatencies(), m_statsStart(Clock::now())
+{
+}
+
+MazeService::~MazeService()
+{
+	// Workers still generating would signal the eventfd
+	m_pool.Wait();
+	for (size_t i = 0; i < m_clients.size(); i++)
+	{
+		if (m_clients[i].fd >= 0)
+			CloseSocket(m_clients[i].fd);
+	}
+	if (m_listenFd >= 0)
+		CloseSocket(m_listenFd);
+	if (m_wakeFd >= 0)
+		close(m_wakeFd);
+	if (m_epollFd >= 0)
+		close(m_epollFd);
+}
+
+bool MazeService::Listen(const char* address)
+{
+	SocketAddress parsed;
+	if (!ParseSocketAddress(address, parsed))
+	{
+		fprintf(stderr, "Bad listen address '%s'\n", address);
+		return false;
+	}
+	m_listenFd = ListenSocket(parsed);
+	if (m_listenFd < 0 or !SetNonBlocking(m_listenFd))
+		return false;
+
+	m_epollFd = epoll_create1(0);
+	m_wakeFd = eventfd(0, EFD_NONBLOCK);
+	epoll_event event = {};
+	event.events = EPOLLIN;
+	event.data.u64 = LISTEN_EVENT;
+	epoll_event wake = {};
+	wake.events = EPOLLIN;
+	wake.data.u64 = WAKE_EVENT;
+	if (m_epollFd < 0 or m_wakeFd < 0 or epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenFd, &event) != 0
+		or epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &wake) != 0)
+	{
+		perror("epoll");
+		return false;
+	}
+	printf("Listening on %s, %d threads, %zu MB cache in %d shards\n", address, m_pool.GetThreadCount(), m_config.cacheBytes >> 20,
+		m_config.cacheShards);
+	return true;
+}
+
+// On a worker: generates and encodes one maze, caches it and queues it for the I/O thread
+void MazeService::Generate(const MazeKey& key)
+{
+	Maze maze(key.width, key.height);
+	if (key.algorithm == MAZE_ALGORITHM_ELLER)
+	{
+		EllerMazeGenerator generator(key.width, key.height, key.seed);
+		generator.Generate(maze);
+	}
+	else
+	{
+		RandomMazeGenerator generator(maze, key.seed);
+		generator.Generate();
+	}
+	std::shared_ptr<std::vector<byte>> data = std::make_shared<std::vector<byte>>();
+	if (key.format == SVC_FORMAT_CODEC)
+		MazeCodec::Encode(maze, *data);
+	else
+		MazeSerializer::Write(maze, *data);
+	MazeBlob blob = data;
+	m_cache.Insert(key, blob);
+
+	{
+		std::lock_guard<std::mutex> lock(m_completedMutex);
+		m_completed.push_back(Completion{ key, blob });
+	}
+	uint64_t one = 1;
+	if (write(m_wakeFd, &one, sizeof(one)) < 0)
+		perror("eventfd");
+}
+
+void MazeService::HandleRequest(int client, const byte* message)
+{
+	Clock::time_point received = Clock::now();
+	uint32_t id = GetU32(message + 1);
+	MazeKey key;
+	key.algorithm = message[5];
+	key.format = message[6];
+	key.width = (int)GetU32(message + 7);
+	key.height = (int)GetU32(message + 11);
+	key.seed = GetU64(message + 15);
+	m_statsRequests++;
+
+	if ((key.algorithm != MAZE_ALGORITHM_BACKTRACKER and key.algorithm != MAZE_ALGORITHM_ELLER)
+		or (key.format != SVC_FORMAT_SERIALIZED and key.format != SVC_FORMAT_CODEC) or key.width < 1 or key.height < 1)
+	{
+		Respond(client, id, SVC_STATUS_BAD_REQUEST, nullptr, received);
+		return;
+	}
+	if ((int64_t)key.width * key.height > m_config.maxCells)
+	{
+		Respond(client, id, SVC_STATUS_TOO_BIG, nullptr, received);
+		return;
+	}
+
+	MazeBlob blob = m_cache.Find(key);
+	if (blob)
+	{
+		Respond(client, id, SVC_STATUS_OK, blob, received);
+		return;
+	}
+	std::vector<Waiter>& waiters = m_pending[key];
+	waiters.push_back(Waiter{ client, m_clients[client].generation, id, received });
+	if (waiters.size() == 1)
+		m_pool.Submit([this, key]() { Generate(key); });
+}
+
+void MazeService::DrainCompleted()
+{
+	uint64_t count;
+	if (read(m_wakeFd, &count, sizeof(count)) < 0 and errno != EAGAIN)
+		perror("eventfd");
+	std::vector<Completion> completed;
+	{
+		std::lock_guard<std::mutex> lock(m_completedMutex);
+		completed.swap(m_completed);
+	}
+	for (const Completion& completion : completed)
+	{
+		m_statsGenerated++;
+		auto found = m_pending.find(completion.key);
+		if (found == m_pending.end())
+			continue;
+		for (const Waiter& waiter : found->second)
+		{
+			// The client may have gone, and its slot been taken by another, since it asked
+			const Client& c = m_clients[waiter.client];
+			if (c.fd >= 0 and c.generation == waiter.generation)
+				Respond(waiter.client, waiter.id, SVC_STATUS_OK, completion.blob, waiter.received);
+		}
+		m_pending.erase(found);
+	}
+}
+
+void MazeService::Respond(int client, uint32_t id, byte status, const MazeBlob& blob, Clock::time_point received)
+{
+	Client& c = m_clients[client];
+	size_t size = blob ? blob->size() : 0;
+	std::vector<byte> header;
+	header.push_back(SVC_RESPONSE);
+	PutU32(header, id);
+	header.push_back(status);
+	PutU32(header, (uint32_t)size);
+	// The maze itself is shared with the cache, not copied
+	c.out.emplace_back();
+	Response& response = c.out.back();
+	std::copy(header.begin(), header.end(), response.header);
+	response.blob = blob;
+	response.sent = 0;
+	c.outBytes += SVC_RESPONSE_HEADER_SIZE + size;
+	m_statsLatencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - received).count());
+}
+
+void MazeService::Accept()
+{
+	while (true)
+	{
+		int fd = accept(m_listenFd, nullptr, nullptr);
+		if (fd < 0)
+		{
+			if (errno != EAGAIN and errno != EWOULDBLOCK)
+				perror("accept");
+			return;
+		}
+		SetNonBlocking(fd);
+
+		int client;
+		if (!m_freeClients.empty())
+		{
+			client = m_freeClients.back();
+			m_freeClients.pop_back();
+		}
+		else
+		{
+			client = (int)m_clients.size();
+			m_clients.emplace_back();
+			m_clients[client].generation = 0;
+		}
+		Client& c = m_clients[client];
+		c.fd = fd;
+		c.generation++;
+		c.in.clear();
+		c.out.clear();
+		c.outBytes = 0;
+		c.writeBlocked = false;
+		c.readPaused = false;
+
+		epoll_event event = {};
+		event.events = EPOLLIN;
+		event.data.u64 = (uint64_t)client;
+		epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event);
+	}
+}
+
+void MazeService::Receive(int client)
+{
+	Client& c = m_clients[client];
+	byte buffer[4096];
+	while (true)
+	{
+		ssize_t count = recv(c.fd, buffer, sizeof(buffer), 0);
+		if (count > 0)
+		{
+			c.in.insert(c.in.end(), buffer, buffer + count);
+			continue;
+		}
+		if (count == 0 or (errno != EAGAIN and errno != EWOULDBLOCK))
+		{
+			Disconnect(client);
+			return;
+		}
+		break;
+	}
+	HandleRequests(client);
+}
+
+// Answers the complete requests buffered from the client, until its output is over the limit
+void MazeService::HandleRequests(int client)
+{
+	Client& c = m_clients[client];
+	size_t offset = 0;
+	while (offset < c.in.size() and c.outBytes < SERVICE_OUTPUT_LIMIT)
+	{
+		const byte* message = c.in.data() + offset;
+		size_t available = c.in.size() - offset;
+		if (message[0] != SVC_REQUEST)
+		{
+			Disconnect(client);
+			return;
+		}
+		if (available < SVC_REQUEST_SIZE)
+			break;
+		HandleRequest(client, message);
+		offset += SVC_REQUEST_SIZE;
+	}
+	c.in.erase(c.in.begin(), c.in.begin() + offset);
+
+	// Stop reading, so a client that doesn't read its answers is held back by its socket buffers
+	bool paused = c.outBytes >= SERVICE_OUTPUT_LIMIT;
+	if (paused != c.readPaused)
+	{
+		c.readPaused = paused;
+		UpdatePollEvents(client);
+	}
+}
+
+void MazeService::Flush(int client)
+{
+	Client& c = m_clients[client];
+	while (!c.out.empty())
+	{
+		iovec parts[SERVICE_WRITE_PARTS * 2];
+		int partCount = 0;
+		for (size_t i = 0; i < c.out.size() and i < SERVICE_WRITE_PARTS; i++)
+		{
+			const Response& response = c.out[i];
+			size_t skip = response.sent;
+			if (skip < SVC_RESPONSE_HEADER_SIZE)
+			{
+				parts[partCount].iov_base = (void*)(response.header + skip);
+				parts[partCount].iov_len = SVC_RESPONSE_HEADER_SIZE - skip;
+				partCount++;
+				skip = 0;
+			}
+			else
+				skip -= SVC_RESPONSE_HEADER_SIZE;
+			if (response.blob and skip < response.blob->size())
+			{
+				parts[partCount].iov_base = (void*)(response.blob->data() + skip);
+				parts[partCount].iov_len = response.blob->size() - skip;
+				partCount++;
+			}
+		}
+
+		msghdr message = {};
+		message.msg_iov = parts;
+		message.msg_iovlen = (size_t)partCount;
+		ssize_t count = sendmsg(c.fd, &message, MSG_NOSIGNAL);
+		if (count < 0)
+		{
+			if (errno == EAGAIN or errno == EWOULDBLOCK)
+				break;
+			Disconnect(client);
+			return;
+		}
+
+		size_t written = (size_t)count;
+		c.outBytes -= written;
+		while (written > 0)
+		{
+			Response& response = c.out.front();
+			size_t left = SVC_RESPONSE_HEADER_SIZE + (response.blob ? response.blob->size() : 0) - response.sent;
+			if (written < left)
+			{
+				response.sent += written;
+				break;
+			}
+			written -= left;
+			c.out.pop_front();
+		}
+
+		// Caught up enough to take the requests held back
+		if (c.readPaused and c.outBytes < SERVICE_OUTPUT_LIMIT)
+		{
+			HandleRequests(client);
+			if (c.fd < 0)
+				return;
+		}
+	}
+
+	bool blocked = !c.out.empty();
+	if (blocked != c.writeBlocked)
+	{
+		c.writeBlocked = blocked;
+		UpdatePollEvents(client);
+	}
+}
+
+void MazeService::UpdatePollEvents(int client)
+{
+	epoll_event event = {};
+	event.events = (m_clients[client].readPaused ? 0U : (uint32_t)EPOLLIN) | (m_clients[client].writeBlocked ? (uint32_t)EPOLLOUT : 0U);
+	event.data.u64 = (uint64_t)client;
+	epoll_ctl(m_epollFd, EPOLL_CTL_MOD, m_clients[client].fd, &event);
+}
+
+void MazeService::Disconnect(int client)
+{
+	Client& c = m_clients[client];
+	if (c.fd < 0)
+		return;
+	CloseSocket(c.fd);
+	c.fd = -1;
+	c.in.clear();
+	c.out.clear();
+	c.outBytes = 0;
+	// Not reusable until the current batch of poll events has been handled
+	m_closedClients.push_back(client);
+}
+
+void MazeService::ReportStats(bool force)
+{
+	Clock::time_point now = Clock::now();
+	double elapsed = std::chrono::duration<double>(now - m_statsStart).count();
+	if (!force and elapsed < m_config.statsInterval)
+		return;
+	if (m_statsRequests == 0)
+		return;
+
+	std::sort(m_statsLatencies.begin(), m_statsLatencies.end());
+	size_t answered = m_statsLatencies.size();
+	uint64_t hits = m_cache.GetHits();
+	uint64_t lookups = hits + m_cache.GetMisses();
+	printf("%.0f requests/s, %.0f generated/s, cache %.1f%% hits (all time), %.1f MB, %llu evictions; service ms: p50 %.3f  p99 %.3f  max %.3f\n",
+		m_statsRequests / elapsed, m_statsGenerated / elapsed, lookups > 0 ? hits * 100.0 / lookups : 0.0, m_cache.GetBytes() / 1048576.0,
+		(unsigned long long)m_cache.GetEvictions(), answered > 0 ? m_statsLatencies[answered / 2] : 0.0,
+		answered > 0 ? m_statsLatencies[answered * 99 / 100] : 0.0, answered > 0 ? m_statsLatencies.back() : 0.0);
+	fflush(stdout);
+
+	m_statsRequests = 0;
+	m_statsGenerated = 0;
+	m_statsLatencies.clear();
+	m_statsStart = now;
+}
+
+void MazeService::Run()
+{
+	std::vector<epoll_event> events(256);
+	while (true)
+	{
+		int timeout = (int)(m_config.statsInterval * 1000.0);
+		int count = epoll_wait(m_epollFd, events.data(), (int)events.size(), timeout);
+		for (int i = 0; i < count; i++)
+		{
+			if (events[i].data.u64 == LISTEN_EVENT)
+			{
+				Accept();
+				continue;
+			}
+			if (events[i].data.u64 == WAKE_EVENT)
+			{
+				DrainCompleted();
+				continue;
+			}
+			int client = (int)events[i].data.u64;
+			if (m_clients[client].fd < 0)
+				continue;
+			if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+				Receive(client);
+			if (m_clients[client].fd >= 0 and (events[i].events & EPOLLOUT))
+				Flush(client);
+		}
+
+		// Answers queued while handling the events go out in one send per client
+		for (size_t i = 0; i < m_clients.size(); i++)
+		{
+			if (m_clients[i].fd >= 0 and !m_clients[i].out.empty() and !m_clients[i].writeBlocked)
+				Flush((int)i);
+		}
+		m_freeClients.insert(m_freeClients.end(), m_closedClients.begin(), m_closedClients.end());
+		m_closedClients.clear();
+		ReportStats(false);
+	}
+}
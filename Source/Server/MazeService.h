@@ -0,0 +1,102 @@
+#pragma once
+#include "MazeCache.h"
+#include "ServiceProtocol.h"
+#include "../Core/ThreadPool.h"
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct MazeServiceConfig
+{
+	int threads = 0;                        // Generating threads, 0 = one per core
+	size_t cacheBytes = (size_t)256 << 20;  // Encoded mazes kept, over all shards
+	int cacheShards = 16;
+	int64_t maxCells = (int64_t)16 << 20;   // Largest maze a request may ask for
+	double statsInterval = 5.0;
+};
+
+// Generates mazes on request (see ServiceProtocol.h) for other local services. Network I/O runs on
+// the calling thread, which answers cached mazes straight away; misses are generated and encoded
+// on the thread pool, which hands them back through a queue and an eventfd. Requests for a maze
+// that is already being generated wait for that one instead of starting another.
+class MazeService
+{
+private:
+	// An answer waiting to be sent: its header, then the maze it shares with the cache
+	struct Response
+	{
+		byte header[SVC_RESPONSE_HEADER_SIZE];
+		MazeBlob blob;
+		size_t sent;          // Bytes of header and blob already written
+	};
+
+	struct Client
+	{
+		int fd;
+		uint32_t generation;  // Bumped whenever the slot is reused, so late answers can tell
+		std::vector<byte> in;
+		std::deque<Response> out;
+		size_t outBytes;      // Still to send over all of out
+		bool writeBlocked;
+		bool readPaused;      // Too much output queued; requests wait until it drains
+	};
+
+	// A request waiting for a maze being generated
+	struct Waiter
+	{
+		int client;
+		uint32_t generation;
+		uint32_t id;
+		std::chrono::steady_clock::time_point received;
+	};
+
+	struct Completion
+	{
+		MazeKey key;
+		MazeBlob blob;
+	};
+
+	MazeServiceConfig m_config;
+	MazeCache m_cache;
+	ThreadPool m_pool;
+	std::vector<Client> m_clients;
+	std::vector<int> m_freeClients;
+	std::vector<int> m_closedClients;
+	int m_listenFd;
+	int m_epollFd;
+	int m_wakeFd;
+	std::unordered_map<MazeKey, std::vector<Waiter>, MazeKeyHash> m_pending;
+
+	std::mutex m_completedMutex;
+	std::vector<Completion> m_completed;
+
+	// Stats since the last report
+	uint64_t m_statsRequests;
+	uint64_t m_statsGenerated;
+	std::vector<double> m_statsLatencies; // Milliseconds from receiving a request to queueing its answer
+	std::chrono::steady_clock::time_point m_statsStart;
+
+	void Generate(const MazeKey& key);
+	void HandleRequest(int client, const byte* message);
+	void HandleRequests(int client);
+	void DrainCompleted();
+	void Respond(int client, uint32_t id, byte status, const MazeBlob& blob, std::chrono::steady_clock::time_point received);
+
+	void Accept();
+	void Receive(int client);
+	void Flush(int client);
+	void Disconnect(int client);
+	void UpdatePollEvents(int client);
+
+	void ReportStats(bool force);
+public:
+	MazeService(const MazeServiceConfig& config);
+	~MazeService();
+
+	bool Listen(const char* address);
+
+	// Serves until the process is stopped
+	void Run();
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include "../Core/Maze.h"
+#include <cstdint>
+#include <vector>
+
+// Wire format between MazeServer and its clients. Every message starts with its type byte,
+// integers are little-endian.
+//
+// Client -> server
+//   MSG_JOIN  u16 width, u16 height, u64 seed (0 lets the server pick one)
+//   MSG_INPUT u8 moves (WALL_* bits, one per key pressed since the last input)
+// Server -> client
+//   MSG_MAZE  u32 session, u16 width, u16 height, u32 player cell, u32 goal cell, u32 size, then the
+//             walls as size bytes of MazeCodec data
+//   MSG_STATE u32 tick, u32 player cell, u8 won
+#define MSG_JOIN  'J'
+#define MSG_INPUT 'I'
+#define MSG_MAZE  'M'
+#define MSG_STATE 'S'
+
+const size_t MSG_JOIN_SIZE = 13;
+const size_t MSG_INPUT_SIZE = 2;
+const size_t MSG_MAZE_HEADER_SIZE = 21;
+const size_t MSG_STATE_SIZE = 10;
+
+inline void PutU16(std::vector<byte>& out, uint32_t value)
+{
+	out.push_back((byte)value);
+	out.push_back((byte)(value >> 8));
+}
+
+inline void PutU32(std::vector<byte>& out, uint32_t value)
+{
+	PutU16(out, value & 0xffff);
+	PutU16(out, value >> 16);
+}
+
+inline void PutU64(std::vector<byte>& out, uint64_t value)
+{
+	PutU32(out, (uint32_t)value);
+	PutU32(out, (uint32_t)(value >> 32));
+}
+
+inline uint32_t GetU16(const byte* in)
+{
+	return (uint32_t)in[0] | ((uint32_t)in[1] << 8);
+}
+
+inline uint32_t GetU32(const byte* in)
+{
+	return GetU16(in) | (GetU16(in + 2) << 16);
+}
+
+inline uint64_t GetU64(const byte* in)
+{
+	return (uint64_t)GetU32(in) | ((uint64_t)GetU32(in + 4) << 32);
+}
@@ -0,0 +1,81 @@
+#include "GameServer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static void PrintUsage()
+{
+	printf(
+		"Usage: MazeServer [options]\n"
+		"  --listen ADDR      port, host:port or a Unix socket path\n"
+		"  --bots N           in-process sessions driven by random input\n"
+		"  --size WxH         maze size for bots (default 20x15)\n"
+		"  --threads N        worker threads (default: one per core)\n"
+		"  --gen-threads N    threads generating new mazes, apart from the ticks (default 1)\n"
+		"  --max-cells N      largest maze a client may join, in cells (default 1048576)\n"
+		"  --tick-rate HZ     simulation rate, 0 runs flat out (default 60)\n"
+		"  --batch N          sessions per worker task (default 256)\n"
+		"  --ticks N          stop after N ticks (default: run forever)\n"
+		"  --stats SECONDS    report interval (default 5)\n");
+}
+
+int main(int argc, char** argv)
+{
+	GameServerConfig config;
+	const char* listenAddress = nullptr;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (value == nullptr or strcmp(arg, "--help") == 0)
+		{
+			PrintUsage();
+			return value == nullptr and strcmp(arg, "--help") != 0 ? 1 : 0;
+		}
+		i++;
+		if (strcmp(arg, "--listen") == 0)
+			listenAddress = value;
+		else if (strcmp(arg, "--bots") == 0)
+			config.bots = atoi(value);
+		else if (strcmp(arg, "--size") == 0)
+		{
+			if (sscanf(value, "%dx%d", &config.width, &config.height) != 2 or config.width < 1 or config.height < 1)
+			{
+				fprintf(stderr, "Bad size '%s'\n", value);
+				return 1;
+			}
+		}
+		else if (strcmp(arg, "--threads") == 0)
+			config.threads = atoi(value);
+		else if (strcmp(arg, "--gen-threads") == 0)
+			config.generatorThreads = atoi(value);
+		else if (strcmp(arg, "--max-cells") == 0)
+			config.maxCells = strtoll(value, nullptr, 10);
+		else if (strcmp(arg, "--tick-rate") == 0)
+			config.tickRate = atoi(value);
+		else if (strcmp(arg, "--batch") == 0)
+			config.batchSize = atoi(value);
+		else if (strcmp(arg, "--ticks") == 0)
+			config.ticks = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--stats") == 0)
+			config.statsInterval = atof(value);
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (listenAddress == nullptr and config.bots == 0)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	GameServer server(config);
+	if (listenAddress != nullptr and !server.Listen(listenAddress))
+		return 1;
+	server.Run();
+	return 0;
+}
@@ -0,0 +1,307 @@
+// Load generator for MazeService: keeps a number of requests in flight on each of many
+// connections, with seeds drawn from a fixed range so its size sets the cache hit rate, and
+// reports throughput and latency percentiles.
+#include "ServiceProtocol.h"
+#include "Socket.h"
+#include "../Core/EllerMazeGenerator.h"
+#include "../Core/MazeCatalog.h"
+#include "../Core/MazeCodec.h"
+#include "../Core/MazeSerializer.h"
+#include "../Core/Random.h"
+#include "../Core/RandomMazeGenerator.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+struct Request
+{
+	uint64_t seed;
+	Clock::time_point sentAt;
+};
+
+struct Connection
+{
+	int fd;
+	std::vector<byte> in;
+	std::vector<byte> out;
+	std::unordered_map<uint32_t, Request> inFlight;
+	uint32_t nextId;
+};
+
+static void PrintUsage()
+{
+	printf(
+		"Usage: MazeServiceLoad --connect ADDR [options]    load MazeService and measure its latency\n"
+		"  --clients N        connections (default 16)\n"
+		"  --depth N          requests in flight per connection (default 4)\n"
+		"  --size WxH         maze size (default 64x64)\n"
+		"  --seeds N          seeds are drawn from 1 to N, 0 for all different (default 1000)\n"
+		"  --algorithm NAME   backtracker or eller (default backtracker)\n"
+		"  --format NAME      serialized or codec (default codec)\n"
+		"  --duration SECONDS (default 10)\n"
+		"  --verify           decode every maze and check it against one generated here\n");
+}
+
+// Whether the response is the maze the request asked for
+static bool VerifyMaze(const byte* data, size_t size, int algorithm, int format, int width, int height, uint64_t seed)
+{
+	Maze received(width, height);
+	if (format == SVC_FORMAT_CODEC ? !MazeCodec::Decode(data, size, received) : !MazeSerializer::Read(data, size, received))
+		return false;
+	Maze expected(width, height);
+	if (algorithm == MAZE_ALGORITHM_ELLER)
+	{
+		EllerMazeGenerator generator(width, height, seed);
+		generator.Generate(expected);
+	}
+	else
+	{
+		RandomMazeGenerator generator(expected, seed);
+		generator.Generate();
+	}
+	for (int64_t i = 0; i < expected.GetCellCount(); i++)
+	{
+		if (received.GetWalls(i) != expected.GetWalls(i))
+			return false;
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	const char* address = nullptr;
+	int clients = 16;
+	int depth = 4;
+	int width = 64, height = 64;
+	uint64_t seeds = 1000;
+	int algorithm = MAZE_ALGORITHM_BACKTRACKER;
+	int format = SVC_FORMAT_CODEC;
+	double duration = 10.0;
+	bool verify = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		if (strcmp(arg, "--verify") == 0)
+		{
+			verify = true;
+			continue;
+		}
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (value == nullptr or strcmp(arg, "--help") == 0)
+		{
+			PrintUsage();
+			return value == nullptr and strcmp(arg, "--help") != 0 ? 1 : 0;
+		}
+		i++;
+		if (strcmp(arg, "--connect") == 0)
+			address = value;
+		else if (strcmp(arg, "--clients") == 0)
+			clients = atoi(value);
+		else if (strcmp(arg, "--depth") == 0)
+			depth = atoi(value);
+		else if (strcmp(arg, "--size") == 0)
+		{
+			if (sscanf(value, "%dx%d", &width, &height) != 2 or width < 1 or height < 1)
+			{
+				fprintf(stderr, "Bad size '%s'\n", value);
+				return 1;
+			}
+		}
+		else if (strcmp(arg, "--seeds") == 0)
+			seeds = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--algorithm") == 0)
+		{
+			if (strcmp(value, "backtracker") == 0)
+				algorithm = MAZE_ALGORITHM_BACKTRACKER;
+			else if (strcmp(value, "eller") == 0)
+				algorithm = MAZE_ALGORITHM_ELLER;
+			else
+			{
+				fprintf(stderr, "Unknown algorithm '%s'\n", value);
+				return 1;
+			}
+		}
+		else if (strcmp(arg, "--format") == 0)
+		{
+			if (strcmp(value, "serialized") == 0)
+				format = SVC_FORMAT_SERIALIZED;
+			else if (strcmp(value, "codec") == 0)
+				format = SVC_FORMAT_CODEC;
+			else
+			{
+				fprintf(stderr, "Unknown format '%s'\n", value);
+				return 1;
+			}
+		}
+		else if (strcmp(arg, "--duration") == 0)
+			duration = atof(value);
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+	SocketAddress parsed;
+	if (address == nullptr or !ParseSocketAddress(address, parsed) or clients < 1 or depth < 1)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	int epollFd = epoll_create1(0);
+	std::vector<Connection> connections;
+	for (int i = 0; i < clients; i++)
+	{
+		int fd = ConnectSocket(parsed);
+		if (fd < 0)
+			break;
+		SetNonBlocking(fd);
+		epoll_event event = {};
+		event.events = EPOLLIN;
+		event.data.u64 = connections.size();
+		epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+		connections.push_back(Connection{ fd, {}, {}, {}, 0 });
+	}
+	if (connections.empty())
+		return 1;
+	printf("%zu connections, %d requests in flight each\n", connections.size(), depth);
+
+	Random random(12345U);
+	uint64_t nextSeed = 1;
+	auto sendRequest = [&](Connection& c)
+		{
+			uint64_t seed = seeds > 0 ? 1 + random.Next64() % seeds : nextSeed++;
+			uint32_t id = c.nextId++;
+			c.out.push_back(SVC_REQUEST);
+			PutU32(c.out, id);
+			c.out.push_back((byte)algorithm);
+			c.out.push_back((byte)format);
+			PutU32(c.out, (uint32_t)width);
+			PutU32(c.out, (uint32_t)height);
+			PutU64(c.out, seed);
+			c.inFlight[id] = Request{ seed, Clock::now() };
+		};
+	auto flush = [](Connection& c)
+		{
+			size_t sent = 0;
+			while (sent < c.out.size())
+			{
+				ssize_t count = send(c.fd, c.out.data() + sent, c.out.size() - sent, MSG_NOSIGNAL);
+				if (count < 0)
+				{
+					if (errno == EAGAIN or errno == EWOULDBLOCK)
+						break;
+					return false;
+				}
+				sent += (size_t)count;
+			}
+			c.out.erase(c.out.begin(), c.out.begin() + sent);
+			return true;
+		};
+
+	for (Connection& c : connections)
+	{
+		for (int i = 0; i < depth; i++)
+		{
+			sendRequest(c);
+		}
+		flush(c);
+	}
+
+	std::vector<double> latencies;
+	uint64_t bytesReceived = 0;
+	uint64_t errors = 0;
+	Clock::time_point start = Clock::now();
+	Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(duration));
+	std::vector<epoll_event> events(256);
+
+	while (Clock::now() < end)
+	{
+		int count = epoll_wait(epollFd, events.data(), (int)events.size(), 10);
+		for (int e = 0; e < count; e++)
+		{
+			Connection& c = connections[events[e].data.u64];
+			byte buffer[65536];
+			ssize_t received;
+			while ((received = recv(c.fd, buffer, sizeof(buffer), 0)) > 0)
+			{
+				c.in.insert(c.in.end(), buffer, buffer + received);
+			}
+			if (received == 0)
+			{
+				fprintf(stderr, "Service closed the connection\n");
+				return 1;
+			}
+
+			size_t offset = 0;
+			while (offset < c.in.size())
+			{
+				const byte* message = c.in.data() + offset;
+				size_t available = c.in.size() - offset;
+				if (message[0] != SVC_RESPONSE)
+				{
+					fprintf(stderr, "Unexpected message type %d\n", message[0]);
+					return 1;
+				}
+				if (available < SVC_RESPONSE_HEADER_SIZE)
+					break;
+				size_t size = GetU32(message + 6);
+				if (available < SVC_RESPONSE_HEADER_SIZE + size)
+					break;
+
+				auto found = c.inFlight.find(GetU32(message + 1));
+				if (found == c.inFlight.end())
+				{
+					fprintf(stderr, "Response to an unknown request\n");
+					return 1;
+				}
+				latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - found->second.sentAt).count());
+				bytesReceived += size;
+				if (message[5] != SVC_STATUS_OK)
+					errors++;
+				else if (verify and !VerifyMaze(message + SVC_RESPONSE_HEADER_SIZE, size, algorithm, format, width, height, found->second.seed))
+				{
+					fprintf(stderr, "Wrong maze for seed %llu\n", (unsigned long long)found->second.seed);
+					return 1;
+				}
+				c.inFlight.erase(found);
+				offset += SVC_RESPONSE_HEADER_SIZE + size;
+				sendRequest(c);
+			}
+			c.in.erase(c.in.begin(), c.in.begin() + offset);
+			if (!flush(c))
+			{
+				fprintf(stderr, "Send failed\n");
+				return 1;
+			}
+		}
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+	double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+	printf("%zu responses in %.1f s (%.0f/s, %.1f MB/s), %llu errors\n", latencies.size(), elapsed, latencies.size() / elapsed,
+		bytesReceived / elapsed / 1048576.0, (unsigned long long)errors);
+	if (!latencies.empty())
+	{
+		size_t n = latencies.size();
+		printf("latency ms: p50 %.3f  p90 %.3f  p99 %.3f  p99.9 %.3f  max %.3f\n", latencies[n / 2], latencies[n * 9 / 10],
+			latencies[n * 99 / 100], latencies[n * 999 / 1000], latencies.back());
+	}
+	for (Connection& c : connections)
+	{
+		CloseSocket(c.fd);
+	}
+	close(epollFd);
+	return errors > 0 ? 1 : 0;
+}
@@ -0,0 +1,68 @@
+#include "MazeService.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static void PrintUsage()
+{
+	printf(
+		"Usage: MazeService --listen ADDR [options]    generate mazes on request for local services\n"
+		"  --listen ADDR      port, host:port or a Unix socket path\n"
+		"  --threads N        generating threads (default: one per core)\n"
+		"  --cache-mb N       size of the cache of generated mazes (default 256)\n"
+		"  --shards N         cache shards, each with its own lock (default 16)\n"
+		"  --max-cells N      largest maze a request may ask for (default 16777216)\n"
+		"  --stats SECONDS    report interval (default 5)\n");
+}
+
+int main(int argc, char** argv)
+{
+	MazeServiceConfig config;
+	const char* listenAddress = nullptr;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (value == nullptr or strcmp(arg, "--help") == 0)
+		{
+			PrintUsage();
+			return value == nullptr and strcmp(arg, "--help") != 0 ? 1 : 0;
+		}
+		i++;
+		if (strcmp(arg, "--listen") == 0)
+			listenAddress = value;
+		else if (strcmp(arg, "--threads") == 0)
+			config.threads = atoi(value);
+		else if (strcmp(arg, "--cache-mb") == 0)
+			config.cacheBytes = (size_t)strtoull(value, nullptr, 10) << 20;
+		else if (strcmp(arg, "--shards") == 0)
+			config.cacheShards = atoi(value);
+		else if (strcmp(arg, "--max-cells") == 0)
+			config.maxCells = strtoll(value, nullptr, 10);
+		else if (strcmp(arg, "--stats") == 0)
+			config.statsInterval = atof(value);
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (listenAddress == nullptr)
+	{
+		PrintUsage();
+		return 1;
+	}
+	if (config.cacheShards < 1 or config.statsInterval <= 0.0)
+	{
+		fprintf(stderr, "Bad --shards or --stats\n");
+		return 1;
+	}
+
+	MazeService service(config);
+	if (!service.Listen(listenAddress))
+		return 1;
+	service.Run();
+	return 0;
+}
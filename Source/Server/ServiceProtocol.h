@@ -0,0 +1,25 @@
+#pragma once
+#include "Protocol.h"
+
+// Wire format between MazeService and its clients, in the same style as the game protocol.
+// Requests can be pipelined; responses carry the request's id and may come back in any order,
+// since cached mazes are answered at once while others are still being generated.
+//
+// Client -> service
+//   SVC_REQUEST  u32 id, u8 algorithm (MAZE_ALGORITHM_*), u8 format (SVC_FORMAT_*), u32 width,
+//                u32 height, u64 seed
+// Service -> client
+//   SVC_RESPONSE u32 id, u8 status (SVC_STATUS_*), u32 size, then size bytes of the maze in the
+//                requested format
+#define SVC_REQUEST  'Q'
+#define SVC_RESPONSE 'A'
+
+const size_t SVC_REQUEST_SIZE = 23;
+const size_t SVC_RESPONSE_HEADER_SIZE = 10;
+
+#define SVC_FORMAT_SERIALIZED 0  // MazeSerializer, two bits per cell
+#define SVC_FORMAT_CODEC      1  // MazeCodec
+
+#define SVC_STATUS_OK          0
+#define SVC_STATUS_BAD_REQUEST 1  // Unknown algorithm or format, or an empty maze
+#define SVC_STATUS_TOO_BIG     2  // More cells than the service is configured to generate
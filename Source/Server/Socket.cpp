@@ -0,0 +1,109 @@
+#include "Socket.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+bool ParseSocketAddress(const char* text, SocketAddress& address)
+{
+	address = SocketAddress{ false, "127.0.0.1", 0, "" };
+	if (strchr(text, '/') != nullptr)
+	{
+		address.isUnix = true;
+		address.path = text;
+		return address.path.size() < sizeof(sockaddr_un::sun_path);
+	}
+	const char* colon = strrchr(text, ':');
+	if (colon != nullptr)
+	{
+		address.host.assign(text, colon - text);
+		text = colon + 1;
+	}
+	address.port = atoi(text);
+	return address.port > 0 and address.port < 65536;
+}
+
+static int OpenSocket(const SocketAddress& address, bool listening)
+{
+	int fd = socket(address.isUnix ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
+	if (fd < 0)
+	{
+		perror("socket");
+		return -1;
+	}
+
+	sockaddr_storage storage;
+	memset(&storage, 0, sizeof(storage));
+	socklen_t length = 0;
+	if (address.isUnix)
+	{
+		sockaddr_un* pAddr = (sockaddr_un*)&storage;
+		pAddr->sun_family = AF_UNIX;
+		strncpy(pAddr->sun_path, address.path.c_str(), sizeof(pAddr->sun_path) - 1);
+		length = sizeof(sockaddr_un);
+		if (listening)
+			unlink(address.path.c_str());
+	}
+	else
+	{
+		sockaddr_in* pAddr = (sockaddr_in*)&storage;
+		pAddr->sin_family = AF_INET;
+		pAddr->sin_port = htons((uint16_t)address.port);
+		if (inet_pton(AF_INET, address.host.c_str(), &pAddr->sin_addr) != 1)
+		{
+			fprintf(stderr, "Bad IPv4 address '%s'\n", address.host.c_str());
+			close(fd);
+			return -1;
+		}
+		length = sizeof(sockaddr_in);
+		int one = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		if (listening)
+			setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	}
+
+	if (listening)
+	{
+		if (bind(fd, (sockaddr*)&storage, length) != 0 or listen(fd, SOMAXCONN) != 0)
+		{
+			perror("bind/listen");
+			close(fd);
+			return -1;
+		}
+	}
+	else if (connect(fd, (sockaddr*)&storage, length) != 0)
+	{
+		perror("connect");
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+int ListenSocket(const SocketAddress& address)
+{
+	return OpenSocket(address, true);
+}
+
+int ConnectSocket(const SocketAddress& address)
+{
+	return OpenSocket(address, false);
+}
+
+bool SetNonBlocking(int fd)
+{
+	int flags = fcntl(fd, F_GETFL, 0);
+	return flags >= 0 and fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+void CloseSocket(int fd)
+{
+	close(fd);
+}
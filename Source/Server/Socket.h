@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+
+// Thin POSIX socket helpers. All of them return -1 on failure after printing the reason.
+
+// "port" or "host:port" for TCP, anything containing a '/' for a Unix socket path
+struct SocketAddress
+{
+	bool isUnix;
+	std::string host;
+	int port;
+	std::string path;
+};
+
+bool ParseSocketAddress(const char* text, SocketAddress& address);
+
+int ListenSocket(const SocketAddress& address);
+int ConnectSocket(const SocketAddress& address);
+bool SetNonBlocking(int fd);
+void CloseSocket(int fd);
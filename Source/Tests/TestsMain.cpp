@@ -0,0 +1,494 @@
+#include "../Core/EllerMazeGenerator.h"
+#include "../Core/GameSession.h"
+#include "../Core/MazeCodec.h"
+#include "../Core/MazeVisibility.h"
+#include "../Core/MazeWorld.h"
+#include "../Core/RandomMazeGenerator.h"
+#include "../Core/SimulationThread.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Rays shot from each cell when checking visible sets
+#define VISIBILITY_RAYS 64
+
+static void PrintUsage()
+{
+	printf(
+		"Usage: MazeTests [TEST...]    run the named tests, or all of them\n"
+		"  codec              MazeCodec round trips, whole and row by row, and damaged headers\n"
+		"  eller              EllerMazeGenerator mazes are perfect\n"
+		"  world              MazeWorld chunks agree across their seams and regenerate the same\n"
+		"  visibility         no cell a line of sight reaches is missing from a MazeVisibility set\n"
+		"  simulation         SimulationThread's mirror ends up equal to the maze, rounds cut short\n");
+}
+
+static double RandomUnit(Random& random)
+{
+	return (random.Next() + 0.5) / 4294967296.0;
+}
+
+// Both sides of every inner wall agree and, with closedBorder, the outer walls are all there.
+// Counts the inner openings and whether every cell can be reached through them.
+static bool CheckWalls(const Maze& maze, bool closedBorder, int64_t& openings, bool& connected)
+{
+	int width = maze.GetWidth();
+	int height = maze.GetHeight();
+	openings = 0;
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			byte walls = maze.GetWalls(x, y);
+			if (x + 1 < width)
+			{
+				if (((walls & WALL_RIGHT) != 0) != ((maze.GetWalls(x + 1, y) & WALL_LEFT) != 0))
+				{
+					fprintf(stderr, "Wall between (%d, %d) and the cell to its right differs by side\n", x, y);
+					return false;
+				}
+				openings += (walls & WALL_RIGHT) == 0;
+			}
+			if (y + 1 < height)
+			{
+				if (((walls & WALL_UP) != 0) != ((maze.GetWalls(x, y + 1) & WALL_DOWN) != 0))
+				{
+					fprintf(stderr, "Wall between (%d, %d) and the cell above differs by side\n", x, y);
+					return false;
+				}
+				openings += (walls & WALL_UP) == 0;
+			}
+			if (closedBorder and ((x == 0 and !(walls & WALL_LEFT)) or (x == width - 1 and !(walls & WALL_RIGHT))
+				or (y == 0 and !(walls & WALL_DOWN)) or (y == height - 1 and !(walls & WALL_UP))))
+			{
+				fprintf(stderr, "Border of (%d, %d) is open\n", x, y);
+				return false;
+			}
+		}
+	}
+
+	std::vector<byte> reached((size_t)maze.GetCellCount(), 0);
+	std::vector<int64_t> stack(1, 0);
+	reached[0] = 1;
+	int64_t reachedCount = 1;
+	while (!stack.empty())
+	{
+		int64_t index = stack.back();
+		stack.pop_back();
+		int x, y;
+		maze.GetPosition(index, x, y);
+		byte walls = maze.GetWalls(index);
+		int64_t next[4] = {
+			x + 1 < width and !(walls & WALL_RIGHT) ? index + 1 : -1,
+			x > 0 and !(walls & WALL_LEFT) ? index - 1 : -1,
+			y + 1 < height and !(walls & WALL_UP) ? index + width : -1,
+			y > 0 and !(walls & WALL_DOWN) ? index - width : -1 };
+		for (int i = 0; i < 4; i++)
+		{
+			if (next[i] >= 0 and !reached[next[i]])
+			{
+				reached[next[i]] = 1;
+				reachedCount++;
+				stack.push_back(next[i]);
+			}
+		}
+	}
+	connected = reachedCount == maze.GetCellCount();
+	return true;
+}
+
+static bool CheckPerfect(const Maze& maze, const char* name)
+{
+	int64_t openings;
+	bool connected;
+	if (!CheckWalls(maze, true, openings, connected))
+		return false;
+	if (!connected or openings != maze.GetCellCount() - 1)
+	{
+		fprintf(stderr, "%s %dx%d is not a perfect maze: %lld openings, %s\n", name, maze.GetWidth(), maze.GetHeight(),
+			(long long)openings, connected ? "connected" : "not connected");
+		return false;
+	}
+	return true;
+}
+
+static bool SameWalls(const Maze& a, const Maze& b)
+{
+	for (int64_t i = 0; i < a.GetCellCount(); i++)
+	{
+		if (a.GetWalls(i) != b.GetWalls(i))
+			return false;
+	}
+	return true;
+}
+
+static bool TestCodec()
+{
+	// Odd sizes, a single cell, and sizes over several blocks
+	const int sizes[][2] = { { 1, 1 }, { 7, 5 }, { 1, 300 }, { 333, 1 }, { 301, 517 }, { 1000, 200 } };
+	ThreadPool pool(2);
+	for (const int* size : sizes)
+	{
+		Maze maze(size[0], size[1]);
+		RandomMazeGenerator generator(maze, (uint64_t)size[0] * 31 + size[1]);
+		generator.Generate();
+		std::vector<byte> data;
+		MazeCodec::Encode(maze, data);
+
+		int width, height, rowsPerBlock;
+		size_t blockCount;
+		if (!MazeCodec::ReadHeader(data.data(), data.size(), width, height, rowsPerBlock, blockCount) or width != size[0] or height != size[1])
+		{
+			fprintf(stderr, "Header of a %dx%d maze doesn't read back\n", size[0], size[1]);
+			return false;
+		}
+
+		for (int pass = 0; pass < 2; pass++)
+		{
+			Maze decoded(size[0], size[1]);
+			if (!MazeCodec::Decode(data.data(), data.size(), decoded, pass == 0 ? nullptr : &pool) or !SameWalls(maze, decoded))
+			{
+				fprintf(stderr, "%dx%d maze doesn't decode back%s\n", size[0], size[1], pass == 0 ? "" : " on the pool");
+				return false;
+			}
+		}
+
+		MazeCodecReader reader;
+		std::vector<byte> row((size_t)size[0]);
+		if (!reader.Open(data.data(), data.size()))
+		{
+			fprintf(stderr, "Reader doesn't open a %dx%d maze\n", size[0], size[1]);
+			return false;
+		}
+		for (int y = 0; y < size[1]; y++)
+		{
+			if (!reader.NextRow(row.data()))
+			{
+				fprintf(stderr, "Reader stops at row %d of a %dx%d maze\n", y, size[0], size[1]);
+				return false;
+			}
+			for (int x = 0; x < size[0]; x++)
+			{
+				if ((row[x] & WALL_ALL) != maze.GetWalls(x, y))
+				{
+					fprintf(stderr, "Reader gets (%d, %d) of a %dx%d maze wrong\n", x, y, size[0], size[1]);
+					return false;
+				}
+			}
+		}
+		if (reader.NextRow(row.data()))
+		{
+			fprintf(stderr, "Reader reads past the end of a %dx%d maze\n", size[0], size[1]);
+			return false;
+		}
+	}
+
+	Maze maze(64, 64);
+	RandomMazeGenerator generator(maze, 5);
+	generator.Generate();
+	std::vector<byte> data;
+	MazeCodec::Encode(maze, data);
+	int width, height, rowsPerBlock;
+	size_t blockCount;
+	std::vector<byte> damaged(data);
+	damaged[0] = 'X';
+	if (MazeCodec::ReadHeader(damaged.data(), damaged.size(), width, height, rowsPerBlock, blockCount))
+	{
+		fprintf(stderr, "Header with a bad magic accepted\n");
+		return false;
+	}
+	// Rows per block, the u32 after the version, width and height
+	damaged = data;
+	memset(damaged.data() + 13, 0xff, 4);
+	Maze decoded(64, 64);
+	if (MazeCodec::ReadHeader(damaged.data(), damaged.size(), width, height, rowsPerBlock, blockCount)
+		or MazeCodec::Decode(damaged.data(), damaged.size(), decoded))
+	{
+		fprintf(stderr, "Header with a forged block height accepted\n");
+		return false;
+	}
+	if (MazeCodec::ReadHeader(data.data(), MazeCodec::HEADER_SIZE - 1, width, height, rowsPerBlock, blockCount))
+	{
+		fprintf(stderr, "Truncated header accepted\n");
+		return false;
+	}
+	return true;
+}
+
+static bool TestEller()
+{
+	const int sizes[][2] = { { 1, 1 }, { 1, 50 }, { 50, 1 }, { 2, 2 }, { 17, 33 }, { 256, 256 } };
+	for (const int* size : sizes)
+	{
+		for (uint64_t seed = 1; seed <= 4; seed++)
+		{
+			EllerMazeGenerator generator(size[0], size[1], seed);
+			Maze maze(size[0], size[1]);
+			generator.Generate(maze);
+			if (!CheckPerfect(maze, "Eller maze"))
+				return false;
+		}
+	}
+	return true;
+}
+
+static bool TestWorld()
+{
+	const int chunkSize = 16;
+	MazeWorld world(42, chunkSize, 1);
+
+	// Chunks 0 to 3 make one block two levels up, which on its own is a perfect maze
+	Maze block(4 * chunkSize, 4 * chunkSize);
+	world.CopyRegion(0, 0, block);
+	int64_t openings;
+	bool connected;
+	if (!CheckWalls(block, false, openings, connected))
+		return false;
+	if (!connected or openings != block.GetCellCount() - 1)
+	{
+		fprintf(stderr, "Block of 4x4 chunks is not a perfect maze: %lld openings, %s\n", (long long)openings,
+			connected ? "connected" : "not connected");
+		return false;
+	}
+
+	// A region across the origin, off the chunk grid: every seam has exactly the door it should
+	const int64_t left = -3 * chunkSize - 5;
+	const int64_t bottom = -2 * chunkSize - 9;
+	Maze region(6 * chunkSize, 5 * chunkSize);
+	world.CopyRegion(left, bottom, region);
+	if (!CheckWalls(region, false, openings, connected))
+		return false;
+	for (int32_t chunkY = -3; chunkY <= 2; chunkY++)
+	{
+		for (int32_t chunkX = -4; chunkX <= 2; chunkX++)
+		{
+			int offset;
+			int64_t seamX = (int64_t)(chunkX + 1) * chunkSize - 1;
+			int64_t seamY = (int64_t)(chunkY + 1) * chunkSize - 1;
+			bool east = world.HasEastDoor(chunkX, chunkY, offset);
+			for (int i = 0; i < chunkSize; i++)
+			{
+				bool open = !(world.GetWalls(seamX, (int64_t)chunkY * chunkSize + i) & WALL_RIGHT);
+				if (open != (east and i == offset)
+					or open == ((world.GetWalls(seamX + 1, (int64_t)chunkY * chunkSize + i) & WALL_LEFT) != 0))
+				{
+					fprintf(stderr, "East seam of chunk (%d, %d) is wrong at row %d\n", chunkX, chunkY, i);
+					return false;
+				}
+			}
+			bool north = world.HasNorthDoor(chunkX, chunkY, offset);
+			for (int i = 0; i < chunkSize; i++)
+			{
+				bool open = !(world.GetWalls((int64_t)chunkX * chunkSize + i, seamY) & WALL_UP);
+				if (open != (north and i == offset)
+					or open == ((world.GetWalls((int64_t)chunkX * chunkSize + i, seamY + 1) & WALL_DOWN) != 0))
+				{
+					fprintf(stderr, "North seam of chunk (%d, %d) is wrong at column %d\n", chunkX, chunkY, i);
+					return false;
+				}
+			}
+		}
+	}
+
+	// Walking away drops the chunks; coming back generates them again, the same
+	uint64_t generated = world.GetGeneratedCount();
+	world.Update(1000 * chunkSize, 1000 * chunkSize);
+	world.Update(left, bottom);
+	Maze again(region.GetWidth(), region.GetHeight());
+	world.CopyRegion(left, bottom, again);
+	if (world.GetGeneratedCount() == generated or !SameWalls(region, again))
+	{
+		fprintf(stderr, "Region isn't the same once its chunks are generated again\n");
+		return false;
+	}
+	return true;
+}
+
+static bool TestVisibility()
+{
+	const int size = 48;
+	const int range = 6;
+	Maze maze(size, size);
+	RandomMazeGenerator generator(maze, 9);
+	generator.Generate();
+	MazeVisibility visibility;
+	visibility.Build(maze, range);
+
+	Random random(3);
+	std::vector<byte> visible((size_t)maze.GetCellCount(), 0);
+	std::vector<int64_t> marked;
+	for (int64_t cell = 0; cell < maze.GetCellCount(); cell++)
+	{
+		int sourceX, sourceY;
+		maze.GetPosition(cell, sourceX, sourceY);
+		marked.clear();
+		visibility.ForEachRun(cell, [&](int64_t start, int64_t length)
+		{
+			for (int64_t i = start; i < start + length; i++)
+			{
+				visible[i] = 1;
+				marked.push_back(i);
+			}
+		});
+
+		for (int64_t index : marked)
+		{
+			int x, y;
+			maze.GetPosition(index, x, y);
+			if (std::abs(x - sourceX) > range or std::abs(y - sourceY) > range)
+			{
+				fprintf(stderr, "(%d, %d) sees (%d, %d), out of range\n", sourceX, sourceY, x, y);
+				return false;
+			}
+		}
+
+		// Rays from random points of the cell, walked a cell at a time until they hit a wall
+		for (int ray = 0; ray < VISIBILITY_RAYS; ray++)
+		{
+			double px = sourceX + RandomUnit(random);
+			double py = sourceY + RandomUnit(random);
+			double angle = RandomUnit(random) * 6.283185307179586;
+			double dx = std::cos(angle);
+			double dy = std::sin(angle);
+			int x = sourceX;
+			int y = sourceY;
+			double nextX = dx > 0.0 ? (x + 1 - px) / dx : dx < 0.0 ? (x - px) / dx : INFINITY;
+			double nextY = dy > 0.0 ? (y + 1 - py) / dy : dy < 0.0 ? (y - py) / dy : INFINITY;
+			while (std::abs(x - sourceX) <= range and std::abs(y - sourceY) <= range)
+			{
+				if (!visible[maze.GetIndex(x, y)])
+				{
+					fprintf(stderr, "(%d, %d) doesn't see (%d, %d), which a ray reaches\n", sourceX, sourceY, x, y);
+					return false;
+				}
+				byte walls = maze.GetWalls(x, y);
+				if (nextX < nextY)
+				{
+					if (walls & (dx > 0.0 ? WALL_RIGHT : WALL_LEFT))
+						break;
+					x += dx > 0.0 ? 1 : -1;
+					nextX += std::abs(1.0 / dx);
+				}
+				else
+				{
+					if (walls & (dy > 0.0 ? WALL_UP : WALL_DOWN))
+						break;
+					y += dy > 0.0 ? 1 : -1;
+					nextY += std::abs(1.0 / dy);
+				}
+			}
+		}
+
+		for (int64_t index : marked)
+		{
+			visible[index] = 0;
+		}
+	}
+	return true;
+}
+
+static bool TestSimulation()
+{
+	// Big enough that the ring fills while generating and nothing reads it, so new rounds drop
+	// deltas kept back
+	const int size = 2048;
+	const uint64_t seed = 7;
+	SimulationThread simulation(size, size, seed, 60);
+	simulation.SetGenerationBudget(0.01);
+	simulation.Start();
+
+	Maze mirror(size, size);
+	std::vector<int64_t> changedCells;
+	for (int i = 0; i < 3; i++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(300));
+		simulation.AddInput(INPUT_NEW_MAZE);
+	}
+
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+	bool settled = false;
+	while (!settled and std::chrono::steady_clock::now() < deadline)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		simulation.Sync(mirror, changedCells);
+		changedCells.clear();
+		const SimulationSnapshot& snapshot = simulation.GetSnapshot();
+		settled = snapshot.round == 3 and snapshot.generated and simulation.GetMirrorRound() == 3 and simulation.IsMirrorCurrent();
+	}
+	simulation.Stop();
+	if (!settled)
+	{
+		fprintf(stderr, "Mirror never caught up: snapshot round %d, mirror round %d\n", simulation.GetSnapshot().round,
+			simulation.GetMirrorRound());
+		return false;
+	}
+
+	GameSession session(size, size, seed);
+	for (int i = 0; i < 3; i++)
+	{
+		session.Tick(INPUT_NEW_MAZE);
+	}
+	session.Generate();
+	if (!SameWalls(session.GetMaze(), mirror))
+	{
+		fprintf(stderr, "Mirror differs from the maze\n");
+		return false;
+	}
+	return true;
+}
+
+struct Test
+{
+	const char* name;
+	bool (*pRun)();
+};
+
+static const Test s_tests[] = {
+	{ "codec", TestCodec },
+	{ "eller", TestEller },
+	{ "world", TestWorld },
+	{ "visibility", TestVisibility },
+	{ "simulation", TestSimulation },
+};
+
+int main(int argc, char** argv)
+{
+	std::vector<const Test*> selected;
+	for (int i = 1; i < argc; i++)
+	{
+		const Test* pTest = nullptr;
+		for (const Test& test : s_tests)
+		{
+			if (strcmp(argv[i], test.name) == 0)
+				pTest = &test;
+		}
+		if (pTest == nullptr)
+		{
+			PrintUsage();
+			return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+		}
+		selected.push_back(pTest);
+	}
+	if (selected.empty())
+	{
+		for (const Test& test : s_tests)
+		{
+			selected.push_back(&test);
+		}
+	}
+
+	int failed = 0;
+	for (const Test* pTest : selected)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		bool passed = pTest->pRun();
+		printf("%-12s %s (%.2f s)\n", pTest->name, passed ? "passed" : "FAILED",
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		failed += !passed;
+	}
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+#include "../Core/BatchGenerator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+static void PrintUsage()
+{
+	printf(
+		"Usage: MazeBatch [options]     generate and measure many mazes, printing throughput and averages\n"
+		"  --size WxH         maze size (default 64x64)\n"
+		"  --count N          number of mazes (default 10000)\n"
+		"  --seed N           seed of the first maze, the others follow (default 1)\n"
+		"  --threads N        worker threads (default: one per core)\n"
+		"  --batch N          mazes per task (default 64)\n"
+		"  --dedup MODE       skip repeated mazes: 'plain' (same walls) or 'canonical' (also rotated\n"
+		"                     or mirrored)\n"
+		"  --csv FILE         also write one line of metrics per maze, duplicates left out\n");
+}
+
+// Sums over every maze of the run, for the averages
+struct BatchTotals
+{
+	uint64_t mazes = 0;
+	uint64_t duplicates = 0;
+	int64_t deadEnds = 0;
+	int64_t corridorCells = 0;
+	int64_t junctions = 0;
+	int64_t corridors = 0;
+	int64_t longestCorridor = 0;
+	int64_t solutionLength = 0;
+	int64_t solutionDecisions = 0;
+	double riverFactor = 0.0;
+	int64_t corridorHistogram[MazeMetrics::CORRIDOR_BUCKETS] = {};
+};
+
+static void WriteCsvLine(FILE* pFile, const BatchItem& item)
+{
+	const MazeMetrics& m = item.metrics;
+	fprintf(pFile, "%llu,%016llx%016llx,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%.6f,%lld,%lld\n",
+		(unsigned long long)item.seed, (unsigned long long)item.hash.high, (unsigned long long)item.hash.low, (long long)item.start, (long long)item.goal, (long long)m.deadEnds,
+		(long long)m.corridorCells, (long long)m.junctions3, (long long)m.junctions4, (long long)m.corridors,
+		(long long)m.longestCorridor, m.riverFactor, (long long)m.solutionLength, (long long)m.solutionDecisions);
+}
+
+int main(int argc, char** argv)
+{
+	int width = 64;
+	int height = 64;
+	uint64_t count = 10000;
+	uint64_t firstSeed = 1;
+	int threads = 0;
+	int batchSize = 64;
+	const char* csvPath = nullptr;
+	const char* dedupMode = nullptr;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (value == nullptr or strcmp(arg, "--help") == 0)
+		{
+			PrintUsage();
+			return value == nullptr and strcmp(arg, "--help") != 0 ? 1 : 0;
+		}
+		i++;
+		if (strcmp(arg, "--size") == 0)
+		{
+			if (sscanf(value, "%dx%d", &width, &height) != 2 or width < 1 or height < 1)
+			{
+				fprintf(stderr, "Bad size '%s'\n", value);
+				return 1;
+			}
+		}
+		else if (strcmp(arg, "--count") == 0)
+			count = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--seed") == 0)
+			firstSeed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--threads") == 0)
+			threads = atoi(value);
+		else if (strcmp(arg, "--batch") == 0)
+			batchSize = atoi(value);
+		else if (strcmp(arg, "--csv") == 0)
+			csvPath = value;
+		else if (strcmp(arg, "--dedup") == 0)
+		{
+			if (strcmp(value, "plain") != 0 and strcmp(value, "canonical") != 0)
+			{
+				fprintf(stderr, "Bad dedup mode '%s'\n", value);
+				return 1;
+			}
+			dedupMode = value;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	FILE* pCsv = nullptr;
+	if (csvPath != nullptr)
+	{
+		pCsv = fopen(csvPath, "w");
+		if (pCsv == nullptr)
+		{
+			fprintf(stderr, "Cannot write %s\n", csvPath);
+			return 1;
+		}
+		fprintf(pCsv, "seed,hash,start,goal,dead_ends,corridor_cells,junctions3,junctions4,corridors,longest_corridor,river_factor,solution_length,solution_decisions\n");
+	}
+
+	BatchGenerator generator(width, height, threads);
+	MazeHashSet seen;
+	if (dedupMode != nullptr)
+		generator.SetDedup(&seen, strcmp(dedupMode, "canonical") == 0);
+	printf("%llu mazes of %dx%d from seed %llu on %d threads\n", (unsigned long long)count, width, height,
+		(unsigned long long)firstSeed, generator.GetThreadCount());
+
+	BatchTotals totals;
+	std::mutex totalsMutex;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	generator.Run(firstSeed, count, batchSize > 0 ? (size_t)batchSize : 1, [&](const BatchItem* pItems, size_t itemCount)
+		{
+			std::lock_guard<std::mutex> lock(totalsMutex);
+			for (size_t i = 0; i < itemCount; i++)
+			{
+				const MazeMetrics& m = pItems[i].metrics;
+				if (pItems[i].duplicate)
+				{
+					totals.duplicates++;
+					continue;
+				}
+				totals.mazes++;
+				totals.deadEnds += m.deadEnds;
+				totals.corridorCells += m.corridorCells;
+				totals.junctions += m.junctions3 + m.junctions4;
+				totals.corridors += m.corridors;
+				totals.longestCorridor += m.longestCorridor;
+				totals.solutionLength += m.solutionLength;
+				totals.solutionDecisions += m.solutionDecisions;
+				totals.riverFactor += m.riverFactor;
+				for (int k = 0; k < MazeMetrics::CORRIDOR_BUCKETS; k++)
+				{
+					totals.corridorHistogram[k] += m.corridorHistogram[k];
+				}
+				if (pCsv != nullptr)
+					WriteCsvLine(pCsv, pItems[i]);
+			}
+		});
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (pCsv != nullptr)
+		fclose(pCsv);
+
+	double generated = (double)(totals.mazes + totals.duplicates);
+	double cells = generated * width * height;
+	printf("%.3f s, %.0f mazes/s, %.1f Mcells/s\n", seconds, seconds > 0.0 ? generated / seconds : 0.0,
+		seconds > 0.0 ? cells / seconds / 1e6 : 0.0);
+	if (dedupMode != nullptr)
+	{
+		printf("%s dedup: %llu unique, %llu duplicates (%.2f%%)\n", dedupMode, (unsigned long long)totals.mazes,
+			(unsigned long long)totals.duplicates, generated > 0.0 ? 100.0 * totals.duplicates / generated : 0.0);
+	}
+	if (totals.mazes == 0)
+		return 0;
+	double n = (double)totals.mazes;
+	printf("per maze: dead ends %.1f, junctions %.1f, corridors %.1f, longest corridor %.1f, river factor %.4f\n",
+		totals.deadEnds / n, totals.junctions / n, totals.corridors / n, totals.longestCorridor / n, totals.riverFactor / n);
+	printf("solution: length %.1f, decisions %.2f\n", totals.solutionLength / n, totals.solutionDecisions / n);
+	printf("corridor lengths:");
+	for (int k = 0; k < MazeMetrics::CORRIDOR_BUCKETS; k++)
+	{
+		if (totals.corridorHistogram[k] != 0)
+			printf(" [%lld,%lld) %.1f%%", 1LL << k, 1LL << (k + 1), 100.0 * totals.corridorHistogram[k] / totals.corridors);
+	}
+	printf("\n");
+	return 0;
+}
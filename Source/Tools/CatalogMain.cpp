@@ -0,0 +1,233 @@
+#include "../Core/BatchGenerator.h"
+#include "../Core/MazeCatalog.h"
+#include "../Core/RandomMazeGenerator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+static void PrintUsage()
+{
+	printf(
+		"Usage: MazeCatalog FILE add [options]      generate mazes and append their metrics to FILE\n"
+		"       MazeCatalog FILE index [options]    rebuild the sorted indexes\n"
+		"       MazeCatalog FILE query [options]    list mazes of one size with a metric in a range\n"
+		"       MazeCatalog FILE show [options]     regenerate a maze from its seed and draw it\n"
+		"  --size WxH         maze size (default 64x64)\n"
+		"  --count N          add: number of mazes (default 10000)\n"
+		"  --seed N           add: seed of the first maze, the others follow (default 1); show: the maze\n"
+		"  --threads N        add: worker threads (default: one per core)\n"
+		"  --key NAME         index: only this key (default all); query: key to select on (default solution)\n"
+		"                     seed, solution, decisions, dead-ends, longest-corridor or river\n"
+		"  --min V, --max V   query: inclusive range of the key; river is a share, 0 to 1\n"
+		"  --limit N          query: most mazes to list (default 50)\n");
+}
+
+static void PrintRecord(uint64_t number, const CatalogRecord& record)
+{
+	printf("#%-10llu seed %-12llu solution %-6u decisions %-4u dead ends %-6u junctions %-6u corridors %-6u longest %-5u river %.3f\n",
+		(unsigned long long)number, (unsigned long long)record.seed, record.solutionLength, record.solutionDecisions,
+		record.deadEnds, record.junctions, record.corridors, record.longestCorridor, record.riverFactor / 65535.0);
+}
+
+// Top row first, as the game shows it
+static void PrintMaze(const Maze& maze, int64_t start, int64_t goal)
+{
+	for (int y = maze.GetHeight() - 1; y >= 0; y--)
+	{
+		for (int x = 0; x < maze.GetWidth(); x++)
+		{
+			printf(maze.GetWalls(maze.GetIndex(x, y)) & WALL_UP ? "+--" : "+  ");
+		}
+		printf("+\n");
+		for (int x = 0; x < maze.GetWidth(); x++)
+		{
+			int64_t index = maze.GetIndex(x, y);
+			const char* mark = index == start ? "S " : index == goal ? "G " : "  ";
+			printf("%s%s", maze.GetWalls(index) & WALL_LEFT ? "|" : " ", mark);
+		}
+		printf("|\n");
+	}
+	for (int x = 0; x < maze.GetWidth(); x++)
+	{
+		printf("+--");
+	}
+	printf("+\n");
+}
+
+static int Add(const char* path, int width, int height, uint64_t firstSeed, uint64_t count, int threads)
+{
+	CatalogWriter writer;
+	if (!writer.Open(path))
+	{
+		fprintf(stderr, "Cannot open catalog %s\n", path);
+		return 1;
+	}
+	uint64_t before = writer.GetCount();
+
+	BatchGenerator generator(width, height, threads);
+	std::mutex writerMutex;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	generator.Run(firstSeed, count, 64, [&](const BatchItem* pItems, size_t itemCount)
+		{
+			std::lock_guard<std::mutex> lock(writerMutex);
+			for (size_t i = 0; i < itemCount; i++)
+			{
+				writer.Append(MakeCatalogRecord(MAZE_ALGORITHM_BACKTRACKER, width, height, pItems[i].seed, pItems[i].metrics));
+			}
+		});
+	uint64_t total = writer.GetCount();
+	if (!writer.Close())
+	{
+		fprintf(stderr, "Cannot write catalog %s\n", path);
+		return 1;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("Added %llu mazes of %dx%d in %.3f s, %llu in the catalog; run 'index' to index them\n",
+		(unsigned long long)(total - before), width, height, seconds, (unsigned long long)total);
+	return 0;
+}
+
+static int Index(const char* path, int onlyKey)
+{
+	for (int key = 0; key < CATALOG_KEY_COUNT; key++)
+	{
+		if (onlyKey >= 0 and key != onlyKey)
+			continue;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if (!MazeCatalog::BuildIndex(path, key))
+		{
+			fprintf(stderr, "Cannot index %s by %s\n", path, MazeCatalog::GetKeyName(key));
+			return 1;
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		printf("Indexed by %s in %.3f s\n", MazeCatalog::GetKeyName(key), seconds);
+	}
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3 or strcmp(argv[1], "--help") == 0)
+	{
+		PrintUsage();
+		return argc < 3 ? 1 : 0;
+	}
+	const char* path = argv[1];
+	const char* command = argv[2];
+
+	int width = 64;
+	int height = 64;
+	uint64_t count = 10000;
+	uint64_t seed = 1;
+	int threads = 0;
+	int key = -1;
+	const char* minText = nullptr;
+	const char* maxText = nullptr;
+	size_t limit = 50;
+
+	for (int i = 3; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (value == nullptr or strcmp(arg, "--help") == 0)
+		{
+			PrintUsage();
+			return value == nullptr and strcmp(arg, "--help") != 0 ? 1 : 0;
+		}
+		i++;
+		if (strcmp(arg, "--size") == 0)
+		{
+			if (sscanf(value, "%dx%d", &width, &height) != 2 or width < 1 or height < 1)
+			{
+				fprintf(stderr, "Bad size '%s'\n", value);
+				return 1;
+			}
+		}
+		else if (strcmp(arg, "--count") == 0)
+			count = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--seed") == 0)
+			seed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--threads") == 0)
+			threads = atoi(value);
+		else if (strcmp(arg, "--key") == 0)
+		{
+			key = MazeCatalog::FindKey(value);
+			if (key < 0)
+			{
+				fprintf(stderr, "Unknown key '%s'\n", value);
+				return 1;
+			}
+		}
+		else if (strcmp(arg, "--min") == 0)
+			minText = value;
+		else if (strcmp(arg, "--max") == 0)
+			maxText = value;
+		else if (strcmp(arg, "--limit") == 0)
+			limit = strtoull(value, nullptr, 10);
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (strcmp(command, "add") == 0)
+		return Add(path, width, height, seed, count, threads);
+	if (strcmp(command, "index") == 0)
+		return Index(path, key);
+
+	std::chrono::steady_clock::time_point openStart = std::chrono::steady_clock::now();
+	MazeCatalog catalog;
+	if (!catalog.Open(path))
+	{
+		fprintf(stderr, "Cannot read catalog %s\n", path);
+		return 1;
+	}
+	double openSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - openStart).count();
+
+	if (strcmp(command, "query") == 0)
+	{
+		CatalogQuery query;
+		query.width = width;
+		query.height = height;
+		query.key = key >= 0 ? key : CATALOG_KEY_SOLUTION_LENGTH;
+		query.limit = limit;
+		if (minText != nullptr)
+			query.min = MazeCatalog::ParseKeyValue(query.key, minText);
+		if (maxText != nullptr)
+			query.max = MazeCatalog::ParseKeyValue(query.key, maxText);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		std::vector<uint64_t> records;
+		catalog.Query(query, records);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		for (uint64_t record : records)
+		{
+			PrintRecord(record, catalog.GetRecord(record));
+		}
+		printf("%zu mazes of %dx%d by %s (%llu records, %llu indexed) in %.3f ms, catalog opened in %.3f ms\n", records.size(), width,
+			height, MazeCatalog::GetKeyName(query.key), (unsigned long long)catalog.GetCount(),
+			(unsigned long long)catalog.GetIndexedCount(query.key), seconds * 1000.0, openSeconds * 1000.0);
+		return 0;
+	}
+	if (strcmp(command, "show") == 0)
+	{
+		uint64_t record;
+		if (!catalog.Find(MAZE_ALGORITHM_BACKTRACKER, width, height, seed, record))
+		{
+			fprintf(stderr, "No %dx%d maze with seed %llu in %s\n", width, height, (unsigned long long)seed, path);
+			return 1;
+		}
+		Maze maze(width, height);
+		RandomMazeGenerator generator(maze, seed);
+		generator.Generate();
+		PrintMaze(maze, generator.GetFirstCell(), generator.GetLastCell());
+		PrintRecord(record, catalog.GetRecord(record));
+		return 0;
+	}
+	PrintUsage();
+	return 1;
+}
@@ -0,0 +1,308 @@
+#include "../Core/EllerMazeGenerator.h"
+#include "../Core/MazeRasterizer.h"
+#include "../Core/RandomMazeGenerator.h"
+#include "../Core/ThreadPool.h"
+#ifdef MAZE_EXPORT_PNG
+#include "../Core/PngWriter.h"
+#endif
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Bytes of image drawn and written at a time
+#define EXPORT_BAND_BYTES (64 << 20)
+
+static void PrintUsage()
+{
+	printf(
+		"Usage: MazeExport --out FILE [options]    draw a maze as an image on the CPU\n"
+		"  --size WxH         maze size (default 20x15)\n"
+		"  --seed N           maze seed (default 1)\n"
+		"  --eller            generate with Eller's algorithm a row at a time and draw each row as it\n"
+		"                     comes, so the maze is never held whole; any size fits in memory\n"
+		"  --cell N           cell side in pixels, walls included (default 16)\n"
+		"  --wall N           wall thickness in pixels (default 2)\n"
+		"  --gray             greyscale instead of the game's colours\n"
+		"  --level N          PNG zlib level, 1 to 9 (default 6)\n"
+		"  --threads N        drawing and PNG compression threads (default: one per core)\n"
+		"FILE ending in .ppm or .pgm is written as binary PPM (PGM with --gray), anything else as\n"
+		"PNG; either is written a band of rows at a time.\n");
+}
+
+static bool EndsWith(const char* text, const char* suffix)
+{
+	size_t length = strlen(text);
+	size_t suffixLength = strlen(suffix);
+	return length >= suffixLength and strcmp(text + length - suffixLength, suffix) == 0;
+}
+
+// The file the image goes to, a band of rows at a time. PPM has no alpha, so RGBA rows lose it on
+// the way out.
+class ImageOutput
+{
+private:
+	FILE* m_pFile;
+#ifdef MAZE_EXPORT_PNG
+	PngWriter m_png;
+#endif
+	int m_width;
+	int m_channels;
+	std::vector<byte> m_rgb;
+public:
+	ImageOutput(int level)
+		:m_pFile(nullptr),
+#ifdef MAZE_EXPORT_PNG
+		m_png(level),
+#endif
+		m_width(0), m_channels(0), m_rgb()
+	{
+		(void)level;
+	}
+
+	bool Open(const char* path, bool pnm, int width, int height, int channels)
+	{
+		m_width = width;
+		m_channels = channels;
+		if (!pnm)
+		{
+#ifdef MAZE_EXPORT_PNG
+			return m_png.Open(path, width, height, channels);
+#else
+			return false;
+#endif
+		}
+		m_pFile = fopen(path, "wb");
+		return m_pFile != nullptr and fprintf(m_pFile, "%s\n%d %d\n255\n", channels == 1 ? "P5" : "P6", width, height) > 0;
+	}
+
+	// PNG rows are deflated on the pool; PPM only waits on the disk
+	bool Write(const byte* pRows, int count, size_t stride, ThreadPool& pool)
+	{
+		if (m_pFile == nullptr)
+		{
+#ifdef MAZE_EXPORT_PNG
+			return m_png.WriteRows(pRows, count, (ptrdiff_t)stride, pool);
+#else
+			(void)pool;
+			return false;
+#endif
+		}
+		if (m_channels == 4)
+		{
+			m_rgb.resize((size_t)m_width * 3);
+			for (int y = 0; y < count; y++)
+			{
+				const byte* pRow = pRows + stride * y;
+				for (int x = 0; x < m_width; x++)
+				{
+					memcpy(&m_rgb[(size_t)x * 3], pRow + (size_t)x * 4, 3);
+				}
+				if (fwrite(m_rgb.data(), 1, m_rgb.size(), m_pFile) != m_rgb.size())
+					return false;
+			}
+			return true;
+		}
+		size_t rowBytes = (size_t)m_width * m_channels;
+		for (int y = 0; y < count; y++)
+		{
+			if (fwrite(pRows + stride * y, 1, rowBytes, m_pFile) != rowBytes)
+				return false;
+		}
+		return true;
+	}
+
+	bool Close()
+	{
+		if (m_pFile == nullptr)
+		{
+#ifdef MAZE_EXPORT_PNG
+			return m_png.Close();
+#else
+			return false;
+#endif
+		}
+		bool closed = fclose(m_pFile) == 0;
+		m_pFile = nullptr;
+		return closed;
+	}
+};
+
+// Draws a whole maze in bands, each band split over the pool
+static bool ExportMaze(const MazeRasterizer& rasterizer, ImageOutput& output, ThreadPool& pool)
+{
+	int height = rasterizer.GetImageHeight();
+	size_t stride = (size_t)rasterizer.GetImageWidth() * rasterizer.GetChannels();
+	int bandRows = (int)std::max((size_t)1, std::min((size_t)height, EXPORT_BAND_BYTES / stride));
+	std::vector<byte> band(stride * bandRows);
+	for (int row = 0; row < height; row += bandRows)
+	{
+		int rows = std::min(bandRows, height - row);
+		rasterizer.DrawRows(row, rows, band.data(), stride, pool);
+		if (!output.Write(band.data(), rows, stride, pool))
+			return false;
+	}
+	return true;
+}
+
+// Generates a band's worth of rows of cells at a time and draws them on the pool. A row's wall line
+// needs the row below, so each band keeps the first row of the next one, and the band that holds
+// the top edge has one row of cells less.
+static bool ExportStreamed(EllerMazeGenerator& generator, const MazeRasterizer& rasterizer, int cellSize, ImageOutput& output, ThreadPool& pool)
+{
+	size_t stride = (size_t)rasterizer.GetImageWidth() * rasterizer.GetChannels();
+	size_t width = (size_t)generator.GetWidth();
+	int bandCellRows = (int)std::max((size_t)2, EXPORT_BAND_BYTES / stride / cellSize);
+	std::vector<byte> band(stride * bandCellRows * cellSize);
+	std::vector<byte> cells(width * (bandCellRows + 1));
+
+	int edgeRows = rasterizer.GetImageHeight() - generator.GetHeight() * cellSize;
+	rasterizer.DrawTopEdge(band.data(), stride);
+	generator.NextRow(cells.data());
+	for (int row = 0; row < generator.GetHeight();)
+	{
+		int filled = row == 0 ? edgeRows : 0;
+		int rows = std::min(generator.GetHeight() - row, (int)((band.size() / stride - filled) / cellSize));
+		// cells holds rows [row, row + rows] of cells; the last one is nullptr below the maze
+		bool last = true;
+		for (int i = 1; i <= rows; i++)
+		{
+			last = !generator.NextRow(cells.data() + width * i);
+		}
+		pool.ParallelFor((size_t)rows, (size_t)std::max(1, rows / pool.GetThreadCount() / 4), [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				const byte* pBelow = i + 1 < (size_t)rows or !last ? cells.data() + width * (i + 1) : nullptr;
+				rasterizer.DrawCellRow(cells.data() + width * i, pBelow, band.data() + stride * (filled + cellSize * i), stride);
+			}
+		});
+		if (!output.Write(band.data(), filled + cellSize * rows, stride, pool))
+			return false;
+		memcpy(cells.data(), cells.data() + width * rows, width);
+		row += rows;
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	int width = 20;
+	int height = 15;
+	uint64_t seed = 1;
+	bool eller = false;
+	int cellSize = 16;
+	int wallWidth = 2;
+	int channels = 4;
+	int level = 6;
+	int threads = 0;
+	const char* outPath = nullptr;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		if (strcmp(arg, "--gray") == 0)
+		{
+			channels = 1;
+			continue;
+		}
+		if (strcmp(arg, "--eller") == 0)
+		{
+			eller = true;
+			continue;
+		}
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (value == nullptr or strcmp(arg, "--help") == 0)
+		{
+			PrintUsage();
+			return value == nullptr and strcmp(arg, "--help") != 0 ? 1 : 0;
+		}
+		i++;
+		if (strcmp(arg, "--size") == 0)
+		{
+			if (sscanf(value, "%dx%d", &width, &height) != 2 or width < 1 or height < 1)
+			{
+				fprintf(stderr, "Bad size '%s'\n", value);
+				return 1;
+			}
+		}
+		else if (strcmp(arg, "--seed") == 0)
+			seed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--cell") == 0)
+			cellSize = atoi(value);
+		else if (strcmp(arg, "--wall") == 0)
+			wallWidth = atoi(value);
+		else if (strcmp(arg, "--level") == 0)
+			level = atoi(value);
+		else if (strcmp(arg, "--threads") == 0)
+			threads = atoi(value);
+		else if (strcmp(arg, "--out") == 0)
+			outPath = value;
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+	if (outPath == nullptr)
+	{
+		PrintUsage();
+		return 1;
+	}
+	if (wallWidth < 1 or cellSize <= wallWidth or level < 1 or level > 9)
+	{
+		fprintf(stderr, "--cell must be larger than --wall, which must be at least 1, and --level 1 to 9\n");
+		return 1;
+	}
+	if ((int64_t)width * cellSize + wallWidth > INT_MAX or (int64_t)height * cellSize + wallWidth > INT_MAX)
+	{
+		fprintf(stderr, "Image too big\n");
+		return 1;
+	}
+	bool pnm = EndsWith(outPath, ".ppm") or EndsWith(outPath, ".pgm");
+#ifndef MAZE_EXPORT_PNG
+	if (!pnm)
+	{
+		fprintf(stderr, "Built without zlib, only .ppm can be written\n");
+		return 1;
+	}
+#endif
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	ImageOutput output(level);
+	ThreadPool pool(threads);
+	bool written;
+	int imageWidth;
+	int imageHeight;
+	if (eller)
+	{
+		EllerMazeGenerator generator(width, height, seed);
+		MazeRasterizer rasterizer(width, height, cellSize, wallWidth, channels);
+		imageWidth = rasterizer.GetImageWidth();
+		imageHeight = rasterizer.GetImageHeight();
+		written = output.Open(outPath, pnm, imageWidth, imageHeight, channels) and ExportStreamed(generator, rasterizer, cellSize, output, pool);
+	}
+	else
+	{
+		Maze maze(width, height);
+		RandomMazeGenerator generator(maze, seed);
+		generator.Generate();
+		maze.SetState(generator.GetLastCell(), CELL_GOAL);
+		MazeRasterizer rasterizer(maze, cellSize, wallWidth, channels);
+		imageWidth = rasterizer.GetImageWidth();
+		imageHeight = rasterizer.GetImageHeight();
+		written = output.Open(outPath, pnm, imageWidth, imageHeight, channels) and ExportMaze(rasterizer, output, pool);
+	}
+	if (!output.Close() or !written)
+	{
+		fprintf(stderr, "Cannot write %s\n", outPath);
+		return 1;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("%dx%d maze as a %dx%d image in %.3f s, %.0f megapixels per second\n", width, height, imageWidth, imageHeight, seconds,
+		seconds > 0.0 ? (double)imageWidth * imageHeight / seconds / 1e6 : 0.0);
+	return 0;
+}
@@ -0,0 +1,276 @@
+#include "../Core/GameSession.h"
+#include "../Core/MazePool.h"
+#include "../Core/Random.h"
+#include "../Core/Replay.h"
+#include "../Core/Telemetry.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+static void PrintUsage()
+{
+	printf(
+		"Usage: MazeReplay FILE [options]          play a replay headless, as fast as possible\n"
+		"       MazeReplay --bot FILE [options]    record a random-walk bot into FILE\n"
+		"  --repeat N         play the replay N times and check every run ends the same (default 1)\n"
+		"  --size WxH         bot maze size (default 20x15)\n"
+		"  --seed N           bot maze seed (default 1)\n"
+		"  --ticks N          bot recording length (default 10000)\n"
+		"  --tick-rate HZ     tick rate stored in the bot recording (default 60)\n"
+		"  --gen-steps N      generator steps per tick in the bot recording (default 1)\n"
+		"  --levels SPEC      bot plays level after level from a prefetched pool, MIN-MAX solution\n"
+		"                     lengths per level, comma separated (0-0 for any maze)\n"
+		"  --prefetch N       rounds the pool builds ahead, bot and replay (default 2)\n"
+		"  --telemetry FILE   publish counters while playing, for MazeTelemetry\n");
+}
+
+// FNV-1a over every cell and the player, enough to tell two runs apart
+static uint64_t HashSession(const GameSession& session)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	const Maze& maze = session.GetMaze();
+	for (int64_t i = 0; i < maze.GetCellCount(); i++)
+	{
+		hash = (hash ^ maze.GetCell(i)) * 1099511628211ULL;
+	}
+	hash = (hash ^ (uint64_t)session.GetPlayer()) * 1099511628211ULL;
+	return hash;
+}
+
+struct ReplayResult
+{
+	uint64_t ticks = 0;
+	int64_t generatedTick = -1;
+	int64_t wonTick = -1;
+	int64_t player = -1;
+	int rounds = 0;
+	uint64_t hash = 0;
+	MazePoolStats pool;
+};
+
+// The session's pool when the header has a schedule, none otherwise
+static std::unique_ptr<MazePool> CreatePool(const ReplayHeader& header, int prefetch)
+{
+	if (header.levels.empty())
+		return nullptr;
+	return std::unique_ptr<MazePool>(new MazePool(header.seed, header.levels, prefetch));
+}
+
+static ReplayResult Play(ReplayReader& replay, int prefetch, TelemetryData* pTelemetry)
+{
+	const ReplayHeader& header = replay.GetHeader();
+	std::unique_ptr<MazePool> pPool = CreatePool(header, prefetch);
+	GameSession session(header.width, header.height, header.seed);
+	session.SetGenerationSteps(header.generationSteps);
+	session.SetPool(pPool.get());
+	ReplayResult result;
+
+	replay.Rewind();
+	if (pTelemetry != nullptr)
+		pTelemetry->Reset();
+	uint64_t tick = 0;
+	while (!replay.IsFinished(tick))
+	{
+		byte moves = replay.GetMoves(tick);
+		if (pTelemetry != nullptr)
+		{
+			std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
+			session.Tick(moves);
+			pTelemetry->RecordTick(session, moves, std::chrono::duration<double>(std::chrono::steady_clock::now() - tickStart).count());
+		}
+		else
+			session.Tick(moves);
+		tick++;
+		if (result.generatedTick < 0 and session.IsGenerated())
+			result.generatedTick = (int64_t)tick;
+		if (result.wonTick < 0 and session.IsWon())
+			result.wonTick = (int64_t)tick;
+	}
+	result.ticks = tick;
+	result.player = session.GetPlayer();
+	result.rounds = session.GetRound() + 1;
+	result.hash = HashSession(session);
+	if (pPool != nullptr)
+		result.pool = pPool->GetStats();
+	return result;
+}
+
+static int RecordBot(const char* path, const ReplayHeader& header, uint64_t ticks, int prefetch)
+{
+	std::unique_ptr<MazePool> pPool = CreatePool(header, prefetch);
+	GameSession session(header.width, header.height, header.seed);
+	session.SetGenerationSteps(header.generationSteps);
+	session.SetPool(pPool.get());
+	ReplayWriter recorder(header);
+	Random random(header.seed ^ 0x9e3779b97f4a7c15ULL);
+
+	for (uint64_t tick = 0; tick < ticks; tick++)
+	{
+		// Same stand-in player as the server bots: one random step through an open wall
+		// With a pool it moves on to the next level as soon as it wins
+		byte moves = 0U;
+		if (pPool != nullptr and session.IsWon())
+			moves = INPUT_NEW_MAZE;
+		else if (session.IsGenerated())
+		{
+			byte open = ~session.GetMaze().GetWalls(session.GetPlayer()) & WALL_ALL;
+			while (open != 0U and moves == 0U)
+			{
+				moves = open & (1 << random.Next(4));
+			}
+		}
+		recorder.Record(tick, moves);
+		session.Tick(moves);
+	}
+	recorder.Finish(ticks);
+
+	if (!recorder.Save(path))
+	{
+		fprintf(stderr, "Cannot write %s\n", path);
+		return 1;
+	}
+	printf("Recorded %llu ticks, %d rounds, into %s (%zu bytes)\n", (unsigned long long)ticks, session.GetRound() + 1, path,
+		recorder.GetData().size());
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	const char* replayPath = nullptr;
+	const char* botPath = nullptr;
+	int repeat = 1;
+	ReplayHeader botHeader;
+	botHeader.width = 20;
+	botHeader.height = 15;
+	botHeader.seed = 1;
+	uint64_t botTicks = 10000;
+	int prefetch = 2;
+	const char* telemetryPath = nullptr;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		if (arg[0] != '-')
+		{
+			replayPath = arg;
+			continue;
+		}
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (value == nullptr or strcmp(arg, "--help") == 0)
+		{
+			PrintUsage();
+			return value == nullptr and strcmp(arg, "--help") != 0 ? 1 : 0;
+		}
+		i++;
+		if (strcmp(arg, "--bot") == 0)
+			botPath = value;
+		else if (strcmp(arg, "--repeat") == 0)
+			repeat = atoi(value);
+		else if (strcmp(arg, "--size") == 0)
+		{
+			if (sscanf(value, "%dx%d", &botHeader.width, &botHeader.height) != 2 or botHeader.width < 1 or botHeader.height < 1
+				or botHeader.width > 0xffff or botHeader.height > 0xffff)
+			{
+				fprintf(stderr, "Bad size '%s'\n", value);
+				return 1;
+			}
+		}
+		else if (strcmp(arg, "--seed") == 0)
+			botHeader.seed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--ticks") == 0)
+			botTicks = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--tick-rate") == 0)
+			botHeader.tickRate = atoi(value);
+		else if (strcmp(arg, "--gen-steps") == 0)
+			botHeader.generationSteps = atoi(value);
+		else if (strcmp(arg, "--levels") == 0)
+		{
+			if (!MazePool::ParseSchedule(value, 1, 1, botHeader.levels))
+			{
+				fprintf(stderr, "Bad levels '%s'\n", value);
+				return 1;
+			}
+		}
+		else if (strcmp(arg, "--prefetch") == 0)
+			prefetch = atoi(value);
+		else if (strcmp(arg, "--telemetry") == 0)
+			telemetryPath = value;
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (botPath != nullptr)
+	{
+		if (botHeader.tickRate <= 0 or botHeader.tickRate > 0xffff)
+			botHeader.tickRate = 60;
+		if (botHeader.generationSteps <= 0)
+			botHeader.generationSteps = 1;
+		// Levels were parsed before the size was known
+		for (MazeLevel& level : botHeader.levels)
+		{
+			level.width = botHeader.width;
+			level.height = botHeader.height;
+		}
+		return RecordBot(botPath, botHeader, botTicks, prefetch);
+	}
+	if (replayPath == nullptr)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	ReplayReader replay;
+	if (!replay.Load(replayPath))
+	{
+		fprintf(stderr, "Cannot read replay %s\n", replayPath);
+		return 1;
+	}
+	const ReplayHeader& header = replay.GetHeader();
+	printf("%s: %dx%d maze, seed %llu, %d Hz, %d generator steps per tick, %zu pooled levels\n", replayPath, header.width,
+		header.height, (unsigned long long)header.seed, header.tickRate, header.generationSteps, header.levels.size());
+
+	TelemetryFile telemetry;
+	if (telemetryPath != nullptr and !telemetry.Create(telemetryPath, header.tickRate))
+	{
+		fprintf(stderr, "Cannot create telemetry file %s\n", telemetryPath);
+		return 1;
+	}
+
+	ReplayResult first;
+	uint64_t totalTicks = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int run = 0; run < (repeat > 0 ? repeat : 1); run++)
+	{
+		ReplayResult result = Play(replay, prefetch, telemetry.GetData());
+		totalTicks += result.ticks;
+		if (run == 0)
+			first = result;
+		else if (result.hash != first.hash or result.ticks != first.ticks)
+		{
+			fprintf(stderr, "Run %d diverged: hash %016llx, expected %016llx\n", run,
+				(unsigned long long)result.hash, (unsigned long long)first.hash);
+			return 2;
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	printf("ticks %llu, generated at %lld, won at %lld, player %lld, hash %016llx\n",
+		(unsigned long long)first.ticks, (long long)first.generatedTick, (long long)first.wonTick, (long long)first.player,
+		(unsigned long long)first.hash);
+	if (!header.levels.empty())
+	{
+		printf("%d rounds, pool %llu hits, %llu misses\n", first.rounds, (unsigned long long)first.pool.hits,
+			(unsigned long long)first.pool.misses);
+	}
+	if (seconds > 0.0)
+	{
+		double ticksPerSecond = totalTicks / seconds;
+		printf("%.3f s, %.0f ticks/s, %.0fx real time\n", seconds, ticksPerSecond, ticksPerSecond / header.tickRate);
+	}
+	return 0;
+}
@@ -0,0 +1,161 @@
+#include "../Core/MappedFile.h"
+#include "../Core/Telemetry.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+// A writer whose heartbeat is older than this is reported as stopped
+#define STALE_SECONDS 2.0
+
+static void PrintUsage()
+{
+	printf(
+		"Usage: MazeTelemetry FILE [options]    watch the counters of a game started with --telemetry FILE\n"
+		"  --interval SECONDS time between reports, rates are over the interval (default 1)\n"
+		"  --count N          stop after N reports (default: until the file goes away)\n"
+		"  --once             print every counter once and exit\n");
+}
+
+static double Rate(uint64_t current, uint64_t previous, double seconds)
+{
+	return seconds > 0.0 and current >= previous ? (current - previous) / seconds : 0.0;
+}
+
+static void PrintHistogram(const char* name, const TelemetryHistogram& histogram, const char* unit)
+{
+	uint64_t count = histogram.count.load(std::memory_order_relaxed);
+	printf("%-16s %10llu samples", name, (unsigned long long)count);
+	if (count > 0)
+	{
+		printf("   mean %.1f  p50 <%llu  p99 <%llu  max %llu %s", (double)histogram.sum.load(std::memory_order_relaxed) / count,
+			(unsigned long long)histogram.GetPercentile(0.5), (unsigned long long)histogram.GetPercentile(0.99),
+			(unsigned long long)histogram.max.load(std::memory_order_relaxed), unit);
+	}
+	printf("\n");
+}
+
+static void PrintAll(const TelemetryData& data)
+{
+	printf("process %llu, started %llu, %u Hz\n", (unsigned long long)data.processId, (unsigned long long)data.startTime, data.tickRate);
+	const struct
+	{
+		const char* name;
+		const std::atomic<uint64_t>& counter;
+	} counters[] = {
+		{ "ticks", data.ticks }, { "generator steps", data.generatorSteps }, { "backtracks", data.backtracks },
+		{ "stack depth", data.stackDepth }, { "max stack depth", data.maxStackDepth }, { "rounds", data.rounds },
+		{ "wins", data.wins }, { "input events", data.inputEvents }, { "frames", data.frames }, { "draw calls", data.drawCalls },
+		{ "frame draw calls", data.frameDrawCalls }
+	};
+	for (const auto& counter : counters)
+	{
+		printf("%-16s %10llu\n", counter.name, (unsigned long long)counter.counter.load(std::memory_order_relaxed));
+	}
+	PrintHistogram("tick time", data.tickMicros, "us");
+	PrintHistogram("frame time", data.frameMicros, "us");
+	PrintHistogram("win time", data.winMillis, "ms");
+}
+
+int main(int argc, char** argv)
+{
+	const char* path = nullptr;
+	double interval = 1.0;
+	uint64_t count = 0;
+	bool once = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		if (arg[0] != '-')
+		{
+			path = arg;
+			continue;
+		}
+		if (strcmp(arg, "--once") == 0)
+		{
+			once = true;
+			continue;
+		}
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (value == nullptr or strcmp(arg, "--help") == 0)
+		{
+			PrintUsage();
+			return value == nullptr and strcmp(arg, "--help") != 0 ? 1 : 0;
+		}
+		i++;
+		if (strcmp(arg, "--interval") == 0)
+			interval = atof(value);
+		else if (strcmp(arg, "--count") == 0)
+			count = strtoull(value, nullptr, 10);
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+	if (path == nullptr or interval <= 0.0)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	// Read-only and shared: the writer's stores show up here as it makes them
+	MappedFile file;
+	if (!file.Open(path) or !TelemetryData::IsValid(file.GetData(), file.GetSize()))
+	{
+		fprintf(stderr, "%s is not a telemetry file\n", path);
+		return 1;
+	}
+	const TelemetryData& data = *(const TelemetryData*)file.GetData();
+	if (once)
+	{
+		PrintAll(data);
+		return 0;
+	}
+
+	typedef std::chrono::steady_clock Clock;
+	uint64_t previousSteps = data.generatorSteps.load(std::memory_order_relaxed);
+	uint64_t previousBacktracks = data.backtracks.load(std::memory_order_relaxed);
+	uint64_t previousTicks = data.ticks.load(std::memory_order_relaxed);
+	uint64_t previousFrames = data.frames.load(std::memory_order_relaxed);
+	uint64_t previousDraws = data.drawCalls.load(std::memory_order_relaxed);
+	uint64_t previousInputs = data.inputEvents.load(std::memory_order_relaxed);
+	Clock::time_point previousTime = Clock::now();
+
+	for (uint64_t report = 0; count == 0 or report < count; report++)
+	{
+		std::this_thread::sleep_for(std::chrono::duration<double>(interval));
+		Clock::time_point now = Clock::now();
+		double seconds = std::chrono::duration<double>(now - previousTime).count();
+		previousTime = now;
+
+		uint64_t steps = data.generatorSteps.load(std::memory_order_relaxed);
+		uint64_t backtracks = data.backtracks.load(std::memory_order_relaxed);
+		uint64_t ticks = data.ticks.load(std::memory_order_relaxed);
+		uint64_t frames = data.frames.load(std::memory_order_relaxed);
+		uint64_t draws = data.drawCalls.load(std::memory_order_relaxed);
+		uint64_t inputs = data.inputEvents.load(std::memory_order_relaxed);
+		double drawsPerFrame = frames > previousFrames ? (double)(draws - previousDraws) / (frames - previousFrames) : 0.0;
+		double idle = (double)((int64_t)TelemetryData::GetMicros() - (int64_t)data.heartbeat.load(std::memory_order_relaxed)) / 1e6;
+
+		printf("%8.0f ticks/s %10.0f steps/s %10.0f backtracks/s  depth %llu (max %llu)  %6.1f fps  %5.1f draws/frame  "
+			"frame p99 <%llu us  %.0f inputs/s  round %llu, %llu wins%s\n",
+			Rate(ticks, previousTicks, seconds), Rate(steps, previousSteps, seconds), Rate(backtracks, previousBacktracks, seconds),
+			(unsigned long long)data.stackDepth.load(std::memory_order_relaxed),
+			(unsigned long long)data.maxStackDepth.load(std::memory_order_relaxed), Rate(frames, previousFrames, seconds), drawsPerFrame,
+			(unsigned long long)data.frameMicros.GetPercentile(0.99), Rate(inputs, previousInputs, seconds),
+			(unsigned long long)data.rounds.load(std::memory_order_relaxed), (unsigned long long)data.wins.load(std::memory_order_relaxed),
+			idle > STALE_SECONDS ? "  (not running)" : "");
+		fflush(stdout);
+
+		previousSteps = steps;
+		previousBacktracks = backtracks;
+		previousTicks = ticks;
+		previousFrames = frames;
+		previousDraws = draws;
+		previousInputs = inputs;
+	}
+	return 0;
+}
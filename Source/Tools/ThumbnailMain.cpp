@@ -0,0 +1,279 @@
+#include "../Core/MazeCatalog.h"
+#include "../Core/PngEncoder.h"
+#include "../Core/RandomMazeGenerator.h"
+#include "../Core/ThreadPool.h"
+#include "../Render/HeadlessContext.h"
+#include "../Render/MazeRenderer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Thumbnails handed to one encoding task
+#define ENCODE_BATCH 16
+
+static void PrintUsage()
+{
+	printf(
+		"Usage: MazeThumbnails --out DIR [options]    draw a PNG thumbnail of every maze, headless\n"
+		"  --size WxH         maze size (default 20x15)\n"
+		"  --seed N           seed of the first maze, the others follow (default 1)\n"
+		"  --count N          number of mazes (default 1000)\n"
+		"  --catalog FILE     draw the mazes of a MazeCatalog query instead of a seed range; --key,\n"
+		"                     --min, --max and --limit select them as in MazeCatalog query\n"
+		"  --tile N           thumbnail side in pixels (default 64)\n"
+		"  --atlas N          side in pixels of the atlas drawn per pass (default 2048)\n"
+		"  --level N          zlib level, 1 to 9 (default 6)\n"
+		"  --threads N        generating and encoding threads (default: one per core)\n"
+		"  --no-write         encode but write no files, for timing\n"
+		"Files are named DIR/WxH-SEED.png.\n");
+}
+
+int main(int argc, char** argv)
+{
+	int width = 20;
+	int height = 15;
+	uint64_t firstSeed = 1;
+	uint64_t count = 1000;
+	const char* outPath = nullptr;
+	const char* catalogPath = nullptr;
+	CatalogQuery query;
+	query.limit = 1000;
+	const char* minText = nullptr;
+	const char* maxText = nullptr;
+	int tileSize = 64;
+	int atlasSize = 2048;
+	int level = 6;
+	int threads = 0;
+	bool write = true;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		if (strcmp(arg, "--no-write") == 0)
+		{
+			write = false;
+			continue;
+		}
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (value == nullptr or strcmp(arg, "--help") == 0)
+		{
+			PrintUsage();
+			return value == nullptr and strcmp(arg, "--help") != 0 ? 1 : 0;
+		}
+		i++;
+		if (strcmp(arg, "--size") == 0)
+		{
+			if (sscanf(value, "%dx%d", &width, &height) != 2 or width < 1 or height < 1)
+			{
+				fprintf(stderr, "Bad size '%s'\n", value);
+				return 1;
+			}
+		}
+		else if (strcmp(arg, "--seed") == 0)
+			firstSeed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--count") == 0)
+			count = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--out") == 0)
+			outPath = value;
+		else if (strcmp(arg, "--catalog") == 0)
+			catalogPath = value;
+		else if (strcmp(arg, "--key") == 0)
+		{
+			query.key = MazeCatalog::FindKey(value);
+			if (query.key < 0)
+			{
+				fprintf(stderr, "Unknown key '%s'\n", value);
+				return 1;
+			}
+		}
+		else if (strcmp(arg, "--min") == 0)
+			minText = value;
+		else if (strcmp(arg, "--max") == 0)
+			maxText = value;
+		else if (strcmp(arg, "--limit") == 0)
+			query.limit = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--tile") == 0)
+			tileSize = atoi(value);
+		else if (strcmp(arg, "--atlas") == 0)
+			atlasSize = atoi(value);
+		else if (strcmp(arg, "--level") == 0)
+			level = atoi(value);
+		else if (strcmp(arg, "--threads") == 0)
+			threads = atoi(value);
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+	if (outPath == nullptr and write)
+	{
+		PrintUsage();
+		return 1;
+	}
+	if (tileSize < 4 or atlasSize < tileSize or level < 1 or level > 9)
+	{
+		fprintf(stderr, "Bad --tile, --atlas or --level\n");
+		return 1;
+	}
+
+	std::vector<uint64_t> seeds;
+	if (catalogPath != nullptr)
+	{
+		MazeCatalog catalog;
+		if (!catalog.Open(catalogPath))
+		{
+			fprintf(stderr, "Cannot open catalog %s\n", catalogPath);
+			return 1;
+		}
+		query.width = width;
+		query.height = height;
+		if (minText != nullptr)
+			query.min = MazeCatalog::ParseKeyValue(query.key, minText);
+		if (maxText != nullptr)
+			query.max = MazeCatalog::ParseKeyValue(query.key, maxText);
+		std::vector<uint64_t> records;
+		catalog.Query(query, records);
+		for (uint64_t record : records)
+		{
+			seeds.push_back(catalog.GetRecord(record).seed);
+		}
+	}
+	else
+	{
+		for (uint64_t i = 0; i < count; i++)
+		{
+			seeds.push_back(firstSeed + i);
+		}
+	}
+
+	HeadlessContext context;
+	if (!context.Create())
+	{
+		fprintf(stderr, "No GL context\n");
+		return 1;
+	}
+	GLint maxTextureSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+	int columns = std::min(atlasSize / tileSize, maxTextureSize / width);
+	int rows = std::min(atlasSize / tileSize, maxTextureSize / height);
+	if (columns < 1 or rows < 1)
+	{
+		fprintf(stderr, "%dx%d mazes don't fit a %d texel texture\n", width, height, maxTextureSize);
+		return 1;
+	}
+	size_t tilesPerPass = (size_t)columns * rows;
+	MazeAtlasRenderer::Init(width, height, tileSize, columns, rows);
+	int atlasWidth = MazeAtlasRenderer::GetAtlasWidth();
+	int atlasHeight = MazeAtlasRenderer::GetAtlasHeight();
+
+	ThreadPool pool(threads);
+	printf("%zu mazes of %dx%d as %dx%d thumbnails, %zu per %dx%d atlas, on %d threads\n", seeds.size(), width, height,
+		tileSize, tileSize, tilesPerPass, atlasWidth, atlasHeight, pool.GetThreadCount());
+
+	std::vector<Maze> mazes;
+	mazes.reserve(tilesPerPass);
+	for (size_t i = 0; i < tilesPerPass; i++)
+	{
+		mazes.emplace_back(width, height);
+	}
+
+	// Pass k is drawn into pixel buffer k % 2 and encoded from pixels[k % 2] while pass k + 1 is
+	// generated; the encoding tasks are done by the time pass k + 2 reuses the copy
+	std::vector<byte> pixels[2];
+	std::atomic<uint64_t> pngBytes(0);
+	std::atomic<uint64_t> failures(0);
+	size_t passCount = (seeds.size() + tilesPerPass - 1) / tilesPerPass;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (size_t pass = 0; pass <= passCount; pass++)
+	{
+		if (pass < passCount)
+		{
+			size_t first = pass * tilesPerPass;
+			size_t tiles = std::min(tilesPerPass, seeds.size() - first);
+			pool.ParallelFor(tiles, ENCODE_BATCH, [&](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; i++)
+					{
+						mazes[i].Reset();
+						RandomMazeGenerator generator(mazes[i], seeds[first + i]);
+						generator.Generate();
+						mazes[i].SetState(generator.GetLastCell(), CELL_GOAL);
+					}
+				});
+			for (size_t i = 0; i < tiles; i++)
+			{
+				MazeAtlasRenderer::UploadTile((int)i, mazes[i]);
+			}
+			MazeAtlasRenderer::Render((int)(pass % 2));
+		}
+		if (pass == 0)
+			continue;
+
+		// The previous pass, whose copy had the whole of this pass's generation to finish
+		size_t previous = pass - 1;
+		int buffer = (int)(previous % 2);
+		const byte* pAtlas = MazeAtlasRenderer::MapPixels(buffer);
+		if (pAtlas == nullptr)
+		{
+			fprintf(stderr, "Cannot read the atlas back\n");
+			return 1;
+		}
+		pixels[buffer].assign(pAtlas, pAtlas + (size_t)atlasWidth * atlasHeight * 3);
+		MazeAtlasRenderer::UnmapPixels(buffer);
+
+		size_t first = previous * tilesPerPass;
+		size_t tiles = std::min(tilesPerPass, seeds.size() - first);
+		const byte* pPixels = pixels[buffer].data();
+		for (size_t begin = 0; begin < tiles; begin += ENCODE_BATCH)
+		{
+			size_t end = std::min(begin + ENCODE_BATCH, tiles);
+			pool.Submit([&, pPixels, first, begin, end]()
+				{
+					thread_local PngEncoder encoder(level);
+					std::vector<byte> png;
+					ptrdiff_t stride = (ptrdiff_t)atlasWidth * 3;
+					for (size_t i = begin; i < end; i++)
+					{
+						// Rows come bottom first; the tile's top row is its last
+						int column = (int)(i % columns);
+						int row = (int)(i / columns);
+						const byte* pTop = pPixels + ((size_t)(row * tileSize + tileSize - 1) * atlasWidth + (size_t)column * tileSize) * 3;
+						if (!encoder.Encode(pTop, tileSize, tileSize, 3, -stride, png))
+						{
+							failures++;
+							continue;
+						}
+						pngBytes += png.size();
+						if (!write)
+							continue;
+						std::string path = std::string(outPath) + "/" + std::to_string(width) + "x" + std::to_string(height) + "-"
+							+ std::to_string(seeds[first + i]) + ".png";
+						FILE* pFile = fopen(path.c_str(), "wb");
+						if (pFile == nullptr or fwrite(png.data(), 1, png.size(), pFile) != png.size())
+							failures++;
+						if (pFile != nullptr and fclose(pFile) != 0)
+							failures++;
+					}
+				});
+		}
+	}
+	pool.Wait();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	MazeAtlasRenderer::Cleanup();
+
+	printf("%zu thumbnails in %.3f s, %.0f per second, %.0f bytes each\n", seeds.size(), seconds,
+		seconds > 0.0 ? seeds.size() / seconds : 0.0, seeds.empty() ? 0.0 : (double)pngBytes / seeds.size());
+	if (failures > 0)
+	{
+		fprintf(stderr, "%llu thumbnails could not be %s\n", (unsigned long long)failures, write ? "written" : "encoded");
+		return 1;
+	}
+	return 0;
+}